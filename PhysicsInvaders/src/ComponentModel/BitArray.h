@@ -0,0 +1,131 @@
+/*
+ * This source file is part of one of Jeremy Burgess's samples.
+ *
+ * Copyright (c) 2013 Jeremy Burgess 
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+// STL
+#include <vector>
+
+// Bit scanning
+#include "Utility/Helpers.h"
+
+namespace ComponentModel
+{
+	/**
+	 * \class BitArray
+	 *
+	 * Resizable array of bits, packed into words so state can be combined & copied a word at a time,
+	 * and set bits found without testing each one.
+	 *
+	 * Concurrent writers must stick to separate words (i.e. index ranges starting on multiples of c_bitsPerWord).
+	 */
+	class BitArray
+	{
+	public:
+		typedef unsigned int Word;
+		static const size_t c_bitsPerWord = sizeof(Word) * 8;
+
+	public:
+		BitArray() :
+			m_size(0)
+		{}
+
+		size_t GetSize() const { return m_size; }
+		void Reserve(size_t size) { m_words.reserve(GetWordCount(size)); }
+
+		inline bool Test(size_t i) const { return (m_words[i / c_bitsPerWord] & GetMask(i)) != 0; }
+		inline void Set(size_t i) { m_words[i / c_bitsPerWord] |= GetMask(i); }
+		inline void Reset(size_t i) { m_words[i / c_bitsPerWord] &= ~GetMask(i); }
+		inline void Assign(size_t i, bool value) { value ? Set(i) : Reset(i); }
+
+		/// Adds a bit to the end of the array.
+		void PushBack(bool value)
+		{
+			if (m_size % c_bitsPerWord == 0)
+			{
+				m_words.push_back(0);
+			}
+			Assign(m_size++, value);
+		}
+
+		/// Resizes the array, clearing any bits added.
+		void Resize(size_t size)
+		{
+			m_words.resize(GetWordCount(size), 0);
+			if (size < m_size && size % c_bitsPerWord != 0)
+			{
+				m_words.back() &= GetMask(size) - 1;
+			}
+			m_size = size;
+		}
+
+		/// Removes the last bit of the array.
+		void PopBack()
+		{
+			Reset(--m_size);
+			if (m_size % c_bitsPerWord == 0)
+			{
+				m_words.pop_back();
+			}
+		}
+
+		/// Gets the first set bit in [from, end), or 'end' if there are none.
+		inline size_t FindNext(size_t from, size_t end) const
+		{
+			if (from >= end)
+			{
+				return end;
+			}
+
+			size_t word = from / c_bitsPerWord;
+			Word bits = m_words[word] & (~static_cast<Word>(0) << (from % c_bitsPerWord));
+			for (size_t lastWord = (end - 1) / c_bitsPerWord; bits == 0; bits = m_words[word])
+			{
+				if (++word > lastWord)
+				{
+					return end;
+				}
+			}
+
+			size_t found = word * c_bitsPerWord + Helpers::CountTrailingZeros(bits);
+			return found < end ? found : end;
+		}
+
+		/// \name Word access
+		/// For combining arrays of the same size a word at a time. Bits past the size are always clear.
+		/// @{
+			size_t GetWordCount() const { return m_words.size(); }
+			Word* GetWords() { return m_words.empty() ? nullptr : &m_words[0]; }
+			const Word* GetWords() const { return m_words.empty() ? nullptr : &m_words[0]; }
+		/// @}
+
+	private:
+		static inline Word GetMask(size_t i) { return static_cast<Word>(1) << (i % c_bitsPerWord); }
+		static inline size_t GetWordCount(size_t size) { return (size + c_bitsPerWord - 1) / c_bitsPerWord; }
+
+	private:
+		std::vector<Word> m_words;
+		size_t m_size;
+	};
+};
@@ -0,0 +1,104 @@
+/*
+ * This source file is part of one of Jeremy Burgess's samples.
+ *
+ * Copyright (c) 2013 Jeremy Burgess 
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+// STL
+#include <vector>
+
+// Boost
+#include <boost/noncopyable.hpp>
+#include <boost/thread/thread.hpp>
+
+namespace ComponentModel
+{
+	class Entity;
+	class Component;
+
+	/**
+	 * \class CommandBuffer
+	 *
+	 * The structural changes (creating & destroying entities, adding & removing components) one
+	 * thread made while the entity component manager was updating. Each thread records into its
+	 * own buffer, so recording needs no locking; the manager applies every buffer at the start of
+	 * the next synchronise.
+	 *
+	 * Every command is tagged with the source it was recorded from (which update pass & pool),
+	 * so the order commands are applied in doesn't depend on which thread ran what.
+	 */
+	class CommandBuffer : public boost::noncopyable
+	{
+	public:
+		enum CommandType
+		{
+			CT_CREATE_ENTITY,		///< Entity was handed out (it's usable straight away, by the recording thread).
+			CT_DESTROY_ENTITY,		///< Entity is to be released.
+			CT_ADD_COMPONENT,		///< Component is to be attached to an entity which existed before recording.
+			CT_REMOVE_COMPONENT,	///< Component is to be removed from its entity & released.
+		};
+
+		struct Command
+		{
+			CommandType m_type;
+			unsigned int m_source;
+			Entity* m_entity;
+			Component* m_component;
+		};
+
+	public:
+		explicit CommandBuffer(boost::thread::id threadId) :
+			m_threadId(threadId),
+			m_source(0),
+			m_suspended(false)
+		{}
+
+		boost::thread::id GetThreadId() const { return m_threadId; }
+
+		/// Sets the source all following commands are recorded from.
+		void SetSource(unsigned int source) { m_source = source; }
+
+		/// Suspended while the thread runs a chunk of a parallel update, which mustn't record anything.
+		void SetSuspended(bool suspended) { m_suspended = suspended; }
+		bool IsSuspended() const { return m_suspended; }
+
+		void Record(CommandType type, Entity* entity, Component* component = nullptr)
+		{
+			Command command;
+			command.m_type = type;
+			command.m_source = m_source;
+			command.m_entity = entity;
+			command.m_component = component;
+			m_commands.push_back(command);
+		}
+
+		const std::vector<Command>& GetCommands() const { return m_commands; }
+		void Clear() { m_commands.clear(); }
+
+	private:
+		boost::thread::id m_threadId;
+		unsigned int m_source;
+		bool m_suspended;
+		std::vector<Command> m_commands;
+	};
+};
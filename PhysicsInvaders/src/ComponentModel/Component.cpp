@@ -23,18 +23,43 @@
  */
 
 #include "Component.h"
+#include "EntityComponentManager.h"
 
 namespace ComponentModel
 {
-	void Component::PropagateEnabledState()
+	void Component::SetEnabled(bool enabled)
 	{
-		m_renderEnabled = m_enabled && m_entity->GetEnabled();
+		m_enabled = enabled;
+		RefreshEnabledState();
+	}
+
+	void Component::SetEntity(Entity* entity)
+	{
+		m_entity = entity;
+		RefreshEnabledState();
+	}
+
+	void Component::RefreshEnabledState()
+	{
+		if (m_pool != nullptr)
+		{
+			m_pool->RefreshEnabledState(this);
+		}
+	}
+
+	Entity* Component::ResolveEntityHandle(EntityHandle handle) const
+	{
+		return m_entity->GetEntityComponentManager()->ResolveHandle(handle);
+	}
+
+	size_t Component::GetActivePosition() const
+	{
+		return m_pool->GetActivePosition(this);
 	}
 
 	void Component::Acquire()
 	{
 		m_enabled = true;
-		m_renderEnabled = false;
 	}
 
 	void Component::DoInitialise(const GameContext& gameContext)
@@ -42,48 +67,16 @@ namespace ComponentModel
 		m_state = CS_INITIALISED;
 		Initialise(gameContext);
 	}
-	
-	void Component::DoPhysicsUpdate(const GameTime& time, const GameContext& gameContext)	
-	{
-		if (m_enabled && m_entity->GetEnabled())
-		{
-			if (m_state == CS_INITIALISED)
-			{
-				FirstCoreUpdate(time, gameContext);
-				m_state = CS_FIRSTUPDATED;
-			}
-			PhysicsUpdate(time, gameContext);
-		}
-	}
 
-	void Component::DoCoreUpdate(const GameTime& time, const GameContext& gameContext)	
+	void Component::DoFirstCoreUpdate(const GameTime& time, const GameContext& gameContext)
 	{
-		if (m_enabled && m_entity->GetEnabled())
-		{
-			if (m_state == CS_INITIALISED)
-			{
-				FirstCoreUpdate(time, gameContext);
-				m_state = CS_FIRSTUPDATED;
-			}
-			CoreUpdate(time, gameContext); 
-		}
+		m_state = CS_FIRSTUPDATED;
+		FirstCoreUpdate(time, gameContext);
 	}
 
 	void Component::DoSynchroniseRenderData(const GameContext& gameContext) 
 	{
-		if (m_enabled && m_entity->GetEnabled())
-		{
-			m_state = CS_SYNCHRONISED; 
-			SynchroniseRenderData(gameContext);
-		}
-	}
-
-	void Component::DoRenderUpdate(const GameTime& time, const GameContext& gameContext)
-	{
-		// Render enabled will never be true before at least one synchronise has been called.
-		if (m_renderEnabled)
-		{
-			RenderUpdate(time, gameContext);
-		}
+		m_state = CS_SYNCHRONISED; 
+		SynchroniseRenderData(gameContext);
 	}
 };
\ No newline at end of file
@@ -26,12 +26,17 @@
 #pragma once
 
 #include "Entity.h"
+#include "ComponentTypeIndex.h"
+#include "DataAccess.h"
+#include "Snapshot.h"
 
 class GameTime;
 class GameContext;
 
 namespace ComponentModel
 {
+	class ComponentPool;
+
 	/**
 	 * \class Component
 	 *
@@ -54,48 +59,123 @@ namespace ComponentModel
 	public:
 		Component() :
 			m_entity(nullptr),
-			m_state(CS_INACTIVE)
+			m_enabled(true),
+			m_state(CS_INACTIVE),
+			m_pool(nullptr),
+			m_poolSlot(0),
+			m_typeId(c_invalidComponentType)
 		{ }
 		virtual ~Component() {}
 
 		void DoInitialise(const GameContext& gameContext);
-		void DoCoreUpdate(const GameTime& time, const GameContext& /*gameContext*/);
-		void DoPhysicsUpdate(const GameTime& time, const GameContext& /*gameContext*/);
-		void DoSynchroniseRenderData(const GameContext& /*gameContext*/);
-		void DoRenderUpdate(const GameTime& time, const GameContext& /*gameContext*/);
+		void DoFirstCoreUpdate(const GameTime& time, const GameContext& gameContext);
+		void DoSynchroniseRenderData(const GameContext& gameContext);
+
+		/// Equivalent of DoFirstCoreUpdate which calls straight into the implementation on T (non virtually,
+		/// so it can be inlined). Used by the typed component pools, which know the exact type of everything
+		/// they hold, and call the rest of the updates on T directly.
+		template <class T> void DoFirstCoreUpdateStatic(const GameTime& time, const GameContext& gameContext)
+		{
+			m_state = CS_FIRSTUPDATED;
+			static_cast<T*>(this)->T::FirstCoreUpdate(time, gameContext);
+		}
 
 		virtual void Initialise(const GameContext& /*gameContext*/) {}
 		virtual void Cleanup(const GameContext& /*gameContext*/) {}
+		/// Cleanup when the world is reset in bulk (see EntityComponentManager::ResetWorld). By then the pool has
+		/// already dropped every message hub subscription its components made, so components which subscribe
+		/// should override this to skip unsubscribing & just let go of everything else.
+		virtual void BulkCleanup(const GameContext& gameContext) { Cleanup(gameContext); }
 		virtual void PhysicsUpdate(const GameTime& /*time*/, const GameContext& /*gameContext*/) {}
 		virtual void FirstCoreUpdate(const GameTime&, const GameContext& /*gameContext*/) {}
 		virtual void CoreUpdate(const GameTime& /*time*/, const GameContext& /*gameContext*/) {}
 		virtual void RenderUpdate(const GameTime& /*time*/, const GameContext& /*gameContext*/) {}
 		virtual void SynchroniseRenderData(const GameContext& /*gameContext*/) {}
 
+		/// Whether the typed pool may call the update methods of this type non-virtually.
+		/// Hide this in a component to force the virtual path (e.g. if instances of the pooled
+		/// type forward their updates polymorphically).
+		static bool HasStaticDispatch() { return true; }
+
+		/// \name Data access
+		/// The shared data (see DataAccess) the physics & core updates of this type read & write.
+		/// Pools whose access doesn't conflict may update concurrently, so hide these in a component
+		/// to declare what it actually touches - the defaults assume everything, so undeclared types
+		/// always update alone.
+		/// @{
+			static DataAccessMask GetReadAccess() { return DA_ALL; }
+			static DataAccessMask GetWriteAccess() { return DA_ALL; }
+		/// @}
+
+		/// \name Parallel updates
+		/// Hide IsParallelSafe to return true if components of the type only touch themselves & their
+		/// own entity in their physics, core & synchronise updates (and make no structural changes,
+		/// as chunks don't record them in a deterministic order). A parallel safe pool splits
+		/// its active components across the worker pool once it holds at least the threshold.
+		/// @{
+			static bool IsParallelSafe() { return false; }
+			static size_t GetParallelThreshold() { return 256; }
+		/// @}
+
+		/// \name Snapshots
+		/// Hide GetSnapshotMode to opt the type in to EntityComponentManager::Snapshot (see SnapshotMode). Bitwise
+		/// types keep the state they snapshot in a trivially copyable SnapshotState struct, and hide
+		/// GetSnapshotState to return theirs - only that is copied, so they pick up pointers to other components
+		/// in OnRestored. Custom types implement LoadSnapshot to read back what SaveSnapshot wrote - recreating
+		/// anything they own (bodies, quads...) - and OnRestored, which is called on every restored component
+		/// once all of them are loaded, to pick up what other components own & subscribe to messages again.
+		/// Restored components are not initialised again.
+		/// @{
+			static SnapshotMode GetSnapshotMode() { return SM_NONE; }
+			struct SnapshotState {};
+			SnapshotState* GetSnapshotState() { return nullptr; }
+			const SnapshotState* GetSnapshotState() const { return nullptr; }
+			virtual void SaveSnapshot(SnapshotWriter& /*writer*/) const {}
+			virtual void LoadSnapshot(SnapshotReader& /*reader*/, const GameContext& /*gameContext*/) {}
+			virtual void OnRestored(const GameContext& /*gameContext*/) {}
+		/// @}
+
 		ComponentState GetState() const { return m_state; }
+
+		/// The registered type index of this component (set by its pool).
+		ComponentTypeId GetTypeId() const { return m_typeId; }
+
+		/// The entity this component is attached to (nullptr if detached).
+		Entity* GetEntity() const { return m_entity; }
 		
-		inline void SetEnabled(bool enabled) { m_enabled = enabled; }
+		/// Enables or disables the component's updates. Enabled state lives in the pool too (so updates can skip
+		/// disabled components a word at a time), so only change it when the scheduler allows writes to DA_ENTITY_STATE.
+		void SetEnabled(bool enabled);
 		inline bool GetEnabled() const { return m_enabled; }
 
 	private:
-		void SetEntity(Entity* entity)
-		{
-			m_entity = entity;
-		}
+		void SetEntity(Entity* entity);
 
 		/// Invoked as soon as the component is 'given out',
 		/// Initialises any values which should be correct before
 		/// anyone even looks at the component.
 		void Acquire();
 
-		/// Invoked by component pool during updates.
-		void PropagateEnabledState();
+		/// Passes the combined enabled state of the component & its entity on to the pool.
+		void RefreshEnabledState();
+
+	protected:
+		/// Resolves a handle through the entity manager owning this component's entity (nullptr if stale).
+		/// Only valid while the component is attached to an entity.
+		Entity* ResolveEntityHandle(EntityHandle handle) const;
+
+		/// Position of this component in its pool's active range (see ComponentPool::GetActiveCount), which
+		/// doesn't change during the updates & synchronise. Only valid while the component is active.
+		size_t GetActivePosition() const;
+
 	protected:
 		Entity* m_entity;
 		bool m_enabled;
 
 	private:
 		ComponentState m_state;
-		bool m_renderEnabled;
+		ComponentPool* m_pool; // The pool owning this component.
+		size_t m_poolSlot; // Index of this component in the owning pool's storage.
+		ComponentTypeId m_typeId;
 	};
 };
\ No newline at end of file
@@ -24,96 +24,555 @@
 
 #include "ComponentPool.h"
 #include "Component.h"
+#include "Entity.h"
+#include "EntityComponentManager.h"
 #include "Core/GameTime.h"
+#include "Game/GameContext.h"
+#include "Game/Messaging/GameMessageHub.h"
+#include "Utility/Log.h"
+
+// Boost
+#include <boost/assert.hpp>
+#include <boost/format.hpp>
 
 namespace ComponentModel
 {
+	const size_t ComponentPool::c_invalidIndex;
+	const size_t ComponentPool::c_minParallelChunkSize;
+
 	void ComponentPool::DoPhysicsUpdate(const GameTime& time) 
 	{ 
-		// Just invoke the physics update on all used components
-		for (auto cIt = m_usedList.begin(); cIt != m_usedList.end(); ++cIt)
+		// Just invoke the physics update on all enabled components
+		size_t count = m_activeComponents.size();
+		for (size_t i = m_enabledBits.FindNext(0, count); i < count; i = m_enabledBits.FindNext(i + 1, count))
 		{ 
-			(*cIt)->DoPhysicsUpdate(time, m_gameContext); 
+			Component* c = m_activeComponents[i];
+			if (!m_firstUpdatedBits.Test(i))
+			{
+				c->DoFirstCoreUpdate(time, m_gameContext);
+				m_firstUpdatedBits.Set(i);
+			}
+			c->PhysicsUpdate(time, m_gameContext); 
 		} 
 	}
 
 	void ComponentPool::DoCoreUpdate(const GameTime& time) 
 	{ 
-		// Do the core update for all used components.
-		for (auto cIt = m_usedList.begin(); cIt != m_usedList.end(); ++cIt)
+		// Do the core update for all enabled components.
+		size_t count = m_activeComponents.size();
+		for (size_t i = m_enabledBits.FindNext(0, count); i < count; i = m_enabledBits.FindNext(i + 1, count))
 		{ 
-			(*cIt)->DoCoreUpdate(time, m_gameContext); 
+			Component* c = m_activeComponents[i];
+			if (!m_firstUpdatedBits.Test(i))
+			{
+				c->DoFirstCoreUpdate(time, m_gameContext);
+				m_firstUpdatedBits.Set(i);
+			}
+			c->CoreUpdate(time, m_gameContext); 
 		}
 	}
 
 	void ComponentPool::DoRenderUpdate(const GameTime& time) 
 	{ 
-		// Do the render update for all used components.
-		for (auto cIt = m_usedList.begin(); cIt != m_usedList.end(); ++cIt)
+		// Do the render update for all components flagged in the last synchronise.
+		// NOTE: The render bits are read from another thread to the updates, however this 
+		// should be safe, as they're only written while only one thread is running.
+		size_t count = m_renderBits.GetSize();
+		for (size_t i = m_renderBits.FindNext(0, count); i < count; i = m_renderBits.FindNext(i + 1, count))
 		{ 
-			Component* c = (*cIt);
-			// NOTE: We're reading a state variable which is written from another thread,
-			// however this should be safe, as the value is never set to synchronised 
-			// except when only one thread is running.
-			if (c->GetState() == Component::CS_SYNCHRONISED || !HasSynchroniseRenderData())
-			{
-				c->DoRenderUpdate(time, m_gameContext); 
-			}
+			m_activeComponents[i]->RenderUpdate(time, m_gameContext); 
 		}
 	}
 
-	void ComponentPool::DoSynchroniseRenderData()
+	void ComponentPool::DoSynchroniseRenderData(bool hasSynchronise, bool hasNonRender)
 	{
+		// Close off this frame's churn
+		m_lastFrameAcquires = m_acquireCount;
+		m_lastFrameReleases = m_releaseCount;
+		m_lastReleaseQueueDepth = m_releasedComponents.size();
+		m_peakReleaseQueueDepth = std::max(m_peakReleaseQueueDepth, m_lastReleaseQueueDepth);
+		m_acquireCount = 0;
+		m_releaseCount = 0;
+
 		// Clear out the deferred 'release' queue.
-		std::for_each(m_releaseSet.begin(), m_releaseSet.end(), [this](Component* c) { c->Cleanup(m_gameContext); m_freeList.push_back(c); });
-		m_usedList.remove_if([this](Component* c){return m_releaseSet.find(c) != m_releaseSet.end();});
-		m_releaseSet.clear();
+		for (auto relIt = m_releasedComponents.begin(); relIt != m_releasedComponents.end(); ++relIt)
+		{
+			Component* c = (*relIt);
+			c->Cleanup(m_gameContext);
 
-		// Cache 2 bools we're going to use a lot in the following update.
-		bool hasSynchronise = HasSynchroniseRenderData();
-		bool hasNonRender = HasNonRenderUpdate();
+			if (m_activeIndices[c->m_poolSlot] != c_invalidIndex)
+			{
+				Deactivate(c);
+			}
+			else
+			{
+				// Released before it was ever initialised - it's still waiting in the acquired list.
+				m_acquiredComponents.erase(std::find(m_acquiredComponents.begin(), m_acquiredComponents.end(), c));
+			}
 
-		// Do the propagation of enabled state and (if necessary) the synchronise.
-		for (auto cIt = m_usedList.begin(); cIt != m_usedList.end(); ++cIt)
-		{ 
-			Component* c = (*cIt);
-			// Always propagate enabled state
-			c->PropagateEnabledState();
+			m_pendingRelease[c->m_poolSlot] = false;
+			m_freeSlots.push_back(c->m_poolSlot);
+		}
+		m_releasedComponents.clear();
+
+		size_t wordCount = m_enabledBits.GetWordCount();
+		const BitArray::Word* enabled = m_enabledBits.GetWords();
+		const BitArray::Word* firstUpdated = m_firstUpdatedBits.GetWords();
+		const BitArray::Word* synchronised = m_synchronisedBits.GetWords();
+
+		// If we've got a synchronise method, synchronise the enabled components which either don't have a 
+		// non render method, or have received their first update (and not been synchronised since)...
+		if (hasSynchronise)
+		{
+			m_synchroniseBits.Resize(m_activeComponents.size());
+			BitArray::Word* toSynchronise = m_synchroniseBits.GetWords();
+			for (size_t w = 0; w < wordCount; ++w)
+			{
+				toSynchronise[w] = hasNonRender ? (enabled[w] & firstUpdated[w] & ~synchronised[w]) : enabled[w];
+			}
 
-			// If we've got a synchronise method, and we either don't have a non render method, 
-			// or we've received _at least_ one update (if we don't have a non render update we don't
-			// need at least one update before calling synch)....
-			if (hasSynchronise && (!hasNonRender || c->GetState() == Component::CS_FIRSTUPDATED))
+			if (ShouldUpdateInParallel())
 			{
-				c->DoSynchroniseRenderData(m_gameContext);
+				m_workerPool->ParallelFor(m_activeComponents.size(), c_minParallelChunkSize, [this](size_t begin, size_t end)
+				{
+					SetChunkRecordingSuspended(true);
+					SynchroniseActiveRange(begin, end);
+					SetChunkRecordingSuspended(false);
+				});
 			}
+			else
+			{
+				SynchroniseActiveRange(0, m_activeComponents.size());
+			}
+		}
+
+		// ...then propagate enabled state to the render update, for those which are ready for it.
+		BitArray::Word* render = m_renderBits.GetWords();
+		for (size_t w = 0; w < wordCount; ++w)
+		{
+			render[w] = hasSynchronise ? (enabled[w] & synchronised[w]) : enabled[w];
 		}
 
-		// Push all freshly acquired components into the used list (ready to go!)
-		for (auto acqIt = m_acquireList.begin(); acqIt != m_acquireList.end(); ++acqIt)
+		// Push all freshly acquired components into the active range (ready to go!)
+		for (auto acqIt = m_acquiredComponents.begin(); acqIt != m_acquiredComponents.end(); ++acqIt)
 		{
 			(*acqIt)->DoInitialise(m_gameContext);
-			m_usedList.push_back(*acqIt);
+			Activate(*acqIt);
 		}
 
 		// Clear the acquire list.
-		m_acquireList.clear();
+		m_acquiredComponents.clear();
+	}
+
+	void ComponentPool::SynchroniseActiveRange(size_t begin, size_t end)
+	{
+		for (size_t i = m_synchroniseBits.FindNext(begin, end); i < end; i = m_synchroniseBits.FindNext(i + 1, end))
+		{ 
+			m_activeComponents[i]->DoSynchroniseRenderData(m_gameContext);
+			m_synchronisedBits.Set(i);
+		}
+	}
+
+	void ComponentPool::SetChunkRecordingSuspended(bool suspended)
+	{
+		m_gameContext.GetComponentManager().SetThreadRecordingSuspended(suspended);
+	}
+
+	void ComponentPool::RefreshEnabledState(Component* c)
+	{
+		size_t index = m_activeIndices[c->m_poolSlot];
+		if (index != c_invalidIndex)
+		{
+			m_enabledBits.Assign(index, IsEnabled(c));
+		}
 	}
 
 	Component* ComponentPool::GetFreeComponent()
 	{
-		// Get an entry from the free list (note - no resizing here. If there are none available, tough)
-		Component* retVal = m_freeList.back();
-		m_freeList.pop_back();
-		// Push it into the acquire list, ready to go into the used list in the next synch.
-		m_acquireList.push_back(retVal);
+		// Out of free slots - the policy decides whether we grow, or give up.
+		if (m_freeSlots.empty() && !HandleExhausted())
+		{
+			return nullptr;
+		}
+
+		// Get an entry from the free slots
+		size_t slot = m_freeSlots.back();
+		m_freeSlots.pop_back();
+		Component* retVal = m_components[slot];
+		// Push it into the acquire list, ready to go into the active range in the next synch.
+		m_acquiredComponents.push_back(retVal);
 		retVal->Acquire();
+
+		++m_acquireCount;
+		m_highWaterMark = std::max(m_highWaterMark, GetLiveCount());
 		return retVal;
 	}
 
+	bool ComponentPool::Reserve(size_t count)
+	{
+		if (m_freeSlots.size() < count && m_capacityPolicy == PCP_GROW)
+		{
+			while (m_freeSlots.size() < count)
+			{
+				Grow();
+			}
+			LOG(Log::Constants::CHANNEL_COMPONENT_MODEL, Log::Constants::LEVEL_INFO, 
+				(boost::format("Component pool %1% grew to %2% components to spawn a batch of %3%.") % GetTypeName() % GetCapacity() % count).str());
+		}
+
+		// Note the active list is left alone - the render thread may be walking it.
+		m_acquiredComponents.reserve(m_acquiredComponents.size() + count);
+		return m_freeSlots.size() >= count;
+	}
+
+	bool ComponentPool::HandleExhausted()
+	{
+		switch (m_capacityPolicy)
+		{
+		case PCP_GROW:
+			Grow();
+			LOG(Log::Constants::CHANNEL_COMPONENT_MODEL, Log::Constants::LEVEL_INFO, 
+				(boost::format("Component pool %1% exhausted, grew to %2% components.") % GetTypeName() % GetCapacity()).str());
+			return true;
+		case PCP_FAIL_FAST:
+			LOG(Log::Constants::CHANNEL_COMPONENT_MODEL, Log::Constants::LEVEL_ERROR, 
+				(boost::format("Component pool %1% exhausted at %2% components.") % GetTypeName() % GetCapacity()).str());
+			BOOST_ASSERT(m_capacityPolicy != PCP_FAIL_FAST);
+			return false;
+		default:
+			LOG(Log::Constants::CHANNEL_COMPONENT_MODEL, Log::Constants::LEVEL_WARN, 
+				(boost::format("Component pool %1% exhausted at %2% components, no component acquired.") % GetTypeName() % GetCapacity()).str());
+			return false;
+		}
+	}
+
 	void ComponentPool::ReleaseComponentDeferred(Component* c) 
 	{
-		// Just add the component to the release set, so that it can be returned to the empty pool later on.
-		m_releaseSet.insert(c);
+		// Just queue the component, so that it can be returned to the free slots later on.
+		// Releasing twice before a synchronise is harmless.
+		if (!m_pendingRelease[c->m_poolSlot])
+		{
+			m_pendingRelease[c->m_poolSlot] = true;
+			m_releasedComponents.push_back(c);
+			++m_releaseCount;
+		}
+	}
+
+	size_t ComponentPool::ReleaseForReset()
+	{
+		std::vector<Component*> released;
+		released.reserve(GetLiveCount());
+		for (auto acIt = m_activeComponents.begin(); acIt != m_activeComponents.end(); ++acIt)
+		{
+			if (!SurvivesReset(*acIt))
+			{
+				released.push_back(*acIt);
+			}
+		}
+		for (auto acqIt = m_acquiredComponents.begin(); acqIt != m_acquiredComponents.end(); ++acqIt)
+		{
+			if (!SurvivesReset(*acqIt))
+			{
+				released.push_back(*acqIt);
+			}
+		}
+
+		if (released.empty())
+		{
+			return 0;
+		}
+
+		// Drop the subscriptions of the whole lot in one sweep of the hub, rather than one unsubscribe per component.
+		// Actions are bound to the most derived object, which isn't necessarily where its Component lives.
+		std::vector<const void*> targets;
+		targets.reserve(released.size());
+		for (auto relIt = released.begin(); relIt != released.end(); ++relIt)
+		{
+			targets.push_back(dynamic_cast<const void*>(*relIt));
+		}
+		std::sort(targets.begin(), targets.end());
+		m_gameContext.GetMessageHub().UnsubscribeAllTargets(targets);
+
+		// Compact the survivors down to the front of the active range (in order, keeping their state).
+		std::fill(m_entityPositions.begin(), m_entityPositions.end(), c_invalidIndex);
+		size_t kept = 0;
+		for (size_t i = 0; i < m_activeComponents.size(); ++i)
+		{
+			Component* c = m_activeComponents[i];
+			if (!SurvivesReset(c))
+			{
+				m_activeIndices[c->m_poolSlot] = c_invalidIndex;
+				continue;
+			}
+
+			size_t entityIndex = m_activeEntities[i];
+			m_activeComponents[kept] = c;
+			m_activeEntities[kept] = entityIndex;
+			m_activeIndices[c->m_poolSlot] = kept;
+			m_enabledBits.Assign(kept, m_enabledBits.Test(i));
+			m_firstUpdatedBits.Assign(kept, m_firstUpdatedBits.Test(i));
+			m_synchronisedBits.Assign(kept, m_synchronisedBits.Test(i));
+			m_renderBits.Assign(kept, m_renderBits.Test(i));
+			if (entityIndex != c_invalidIndex && m_entityPositions[entityIndex] == c_invalidIndex)
+			{
+				m_entityPositions[entityIndex] = kept;
+			}
+			++kept;
+		}
+		m_activeComponents.resize(kept);
+		m_activeEntities.resize(kept);
+		m_enabledBits.Resize(kept);
+		m_firstUpdatedBits.Resize(kept);
+		m_synchronisedBits.Resize(kept);
+		m_renderBits.Resize(kept);
+
+		size_t acquiredKept = 0;
+		for (size_t i = 0; i < m_acquiredComponents.size(); ++i)
+		{
+			if (SurvivesReset(m_acquiredComponents[i]))
+			{
+				m_acquiredComponents[acquiredKept++] = m_acquiredComponents[i];
+			}
+		}
+		m_acquiredComponents.resize(acquiredKept);
+
+		// Anything already queued was counted when it was released.
+		m_releaseCount += released.size() - m_releasedComponents.size();
+		m_releasedComponents.clear();
+
+		// Now each component only has to let go of whatever else it holds.
+		for (auto relIt = released.begin(); relIt != released.end(); ++relIt)
+		{
+			Component* c = (*relIt);
+			c->BulkCleanup(m_gameContext);
+			m_pendingRelease[c->m_poolSlot] = false;
+			m_freeSlots.push_back(c->m_poolSlot);
+		}
+		return released.size();
+	}
+
+	bool ComponentPool::SaveSnapshot(SnapshotWriter& writer) const
+	{
+		unsigned int count = 0;
+		for (auto acIt = m_activeComponents.begin(); acIt != m_activeComponents.end(); ++acIt)
+		{
+			count += IsSnapshotted(*acIt) ? 1 : 0;
+		}
+
+		if (count > 0 && GetSnapshotMode() == SM_NONE)
+		{
+			LOG(Log::Constants::CHANNEL_COMPONENT_MODEL, Log::Constants::LEVEL_WARN, 
+				(boost::format("Can't snapshot %1% live components of %2%, the type doesn't support snapshots.") % count % GetTypeName()).str());
+			return false;
+		}
+
+		writer.Write(static_cast<unsigned int>(m_typeId));
+		writer.Write(static_cast<unsigned int>(GetComponentSize()));
+		writer.WriteArray(m_freeSlots);
+		writer.Write(count);
+		for (size_t i = 0; i < m_activeComponents.size(); ++i)
+		{
+			const Component* c = m_activeComponents[i];
+			if (!IsSnapshotted(c))
+			{
+				continue;
+			}
+
+			SnapshotRecord record;
+			record.m_slot = static_cast<unsigned int>(c->m_poolSlot);
+			record.m_entityIndex = static_cast<unsigned int>(m_activeEntities[i]);
+			record.m_enabled = c->m_enabled ? 1 : 0;
+			record.m_state = static_cast<unsigned char>(c->m_state);
+			record.m_flags = static_cast<unsigned char>((m_enabledBits.Test(i) ? SF_ENABLED : 0) | 
+				(m_firstUpdatedBits.Test(i) ? SF_FIRST_UPDATED : 0) | 
+				(m_synchronisedBits.Test(i) ? SF_SYNCHRONISED : 0) | 
+				(m_renderBits.Test(i) ? SF_RENDER : 0));
+			writer.Write(record);
+			SaveComponent(c, writer);
+		}
+		return true;
+	}
+
+	bool ComponentPool::LoadSnapshot(SnapshotReader& reader, ChunkedStorage<Entity>& entities)
+	{
+		if (reader.Read<unsigned int>() != m_typeId || reader.Read<unsigned int>() != GetComponentSize())
+		{
+			return false;
+		}
+
+		std::vector<size_t> savedFreeSlots;
+		reader.ReadArray(savedFreeSlots);
+		unsigned int count = reader.Read<unsigned int>();
+		m_firstRestored = m_activeComponents.size();
+		for (unsigned int i = 0; i < count; ++i)
+		{
+			SnapshotRecord record;
+			if (!reader.Read(record) || record.m_slot >= m_components.size() || m_activeIndices[record.m_slot] != c_invalidIndex || 
+				record.m_entityIndex >= entities.GetCapacity())
+			{
+				return false;
+			}
+
+			// Attach first - loading may well need the entity.
+			Component* c = m_components[record.m_slot];
+			entities[record.m_entityIndex].AddComponent(c);
+			LoadComponent(c, reader);
+			c->m_enabled = record.m_enabled != 0;
+			c->m_state = static_cast<Component::ComponentState>(record.m_state);
+
+			Activate(c);
+			size_t position = m_activeComponents.size() - 1;
+			m_enabledBits.Assign(position, (record.m_flags & SF_ENABLED) != 0);
+			m_firstUpdatedBits.Assign(position, (record.m_flags & SF_FIRST_UPDATED) != 0);
+			m_synchronisedBits.Assign(position, (record.m_flags & SF_SYNCHRONISED) != 0);
+			m_renderBits.Assign(position, (record.m_flags & SF_RENDER) != 0);
+		}
+
+		// Free slots go back in the order they were in (so the same slots get handed out next), bar any taken since.
+		// Any slots the pool has grown by since go underneath, to be handed out last.
+		std::vector<bool> isSavedFree(m_components.size(), false);
+		for (auto slotIt = savedFreeSlots.begin(); slotIt != savedFreeSlots.end(); ++slotIt)
+		{
+			if (*slotIt < m_components.size() && m_activeIndices[*slotIt] == c_invalidIndex)
+			{
+				isSavedFree[*slotIt] = true;
+			}
+		}
+		m_freeSlots.clear();
+		for (size_t slot = 0; slot < m_components.size(); ++slot)
+		{
+			if (!isSavedFree[slot] && m_activeIndices[slot] == c_invalidIndex)
+			{
+				m_freeSlots.push_back(slot);
+			}
+		}
+		for (auto slotIt = savedFreeSlots.begin(); slotIt != savedFreeSlots.end(); ++slotIt)
+		{
+			if (*slotIt < m_components.size() && isSavedFree[*slotIt])
+			{
+				m_freeSlots.push_back(*slotIt);
+				isSavedFree[*slotIt] = false;
+			}
+		}
+
+		m_acquireCount += count;
+		m_highWaterMark = std::max(m_highWaterMark, GetLiveCount());
+		return reader.IsValid();
+	}
+
+	void ComponentPool::NotifyRestored()
+	{
+		for (size_t i = m_firstRestored; i < m_activeComponents.size(); ++i)
+		{
+			m_activeComponents[i]->OnRestored(m_gameContext);
+		}
+		m_firstRestored = m_activeComponents.size();
+	}
+
+	size_t ComponentPool::GetReservedBytes() const
+	{
+		return GetCapacity() * GetComponentSize() +
+			m_components.capacity() * sizeof(Component*) +
+			m_activeIndices.capacity() * sizeof(size_t) +
+			m_pendingRelease.capacity() / 8 +
+			m_activeComponents.capacity() * sizeof(Component*) +
+			m_activeEntities.capacity() * sizeof(size_t) +
+			(m_enabledBits.GetWordCount() + m_firstUpdatedBits.GetWordCount() + m_synchronisedBits.GetWordCount() +
+				m_renderBits.GetWordCount() + m_synchroniseBits.GetWordCount()) * sizeof(BitArray::Word) +
+			m_entityPositions.capacity() * sizeof(size_t) +
+			m_freeSlots.capacity() * sizeof(size_t) +
+			m_acquiredComponents.capacity() * sizeof(Component*) +
+			m_releasedComponents.capacity() * sizeof(Component*);
+	}
+
+	PoolStatistics ComponentPool::GetStatistics() const
+	{
+		PoolStatistics statistics;
+		statistics.m_typeName = GetTypeName();
+		statistics.m_capacityPolicy = m_capacityPolicy;
+		statistics.m_capacity = GetCapacity();
+		statistics.m_liveCount = GetLiveCount();
+		statistics.m_highWaterMark = m_highWaterMark;
+		statistics.m_acquiresPerFrame = m_lastFrameAcquires;
+		statistics.m_releasesPerFrame = m_lastFrameReleases;
+		statistics.m_releaseQueueDepth = m_lastReleaseQueueDepth;
+		statistics.m_peakReleaseQueueDepth = m_peakReleaseQueueDepth;
+		statistics.m_bytesPerItem = GetComponentSize();
+		statistics.m_reservedBytes = GetReservedBytes();
+		return statistics;
+	}
+
+	void ComponentPool::AddSlot(Component* c)
+	{
+		c->m_poolSlot = m_components.size();
+		c->m_typeId = m_typeId;
+		c->m_pool = this;
+		m_components.push_back(c);
+		m_activeIndices.push_back(c_invalidIndex);
+		m_pendingRelease.push_back(false);
+		m_freeSlots.push_back(c->m_poolSlot);
+	}
+
+	void ComponentPool::Activate(Component* c)
+	{
+		size_t position = m_activeComponents.size();
+		m_activeIndices[c->m_poolSlot] = position;
+		m_activeComponents.push_back(c);
+
+		// Freshly initialised - so it's yet to be updated, synchronised or rendered.
+		m_enabledBits.PushBack(IsEnabled(c));
+		m_firstUpdatedBits.PushBack(false);
+		m_synchronisedBits.PushBack(false);
+		m_renderBits.PushBack(false);
+
+		// Add to the entity's sparse set entry (unless an earlier component of this type already holds it)
+		size_t entityIndex = c->m_entity != nullptr ? c->m_entity->GetHandle().GetIndex() : c_invalidIndex;
+		m_activeEntities.push_back(entityIndex);
+		if (entityIndex != c_invalidIndex)
+		{
+			if (entityIndex >= m_entityPositions.size())
+			{
+				m_entityPositions.resize(entityIndex + 1, c_invalidIndex);
+			}
+			if (m_entityPositions[entityIndex] == c_invalidIndex)
+			{
+				m_entityPositions[entityIndex] = position;
+			}
+		}
+	}
+
+	void ComponentPool::Deactivate(Component* c)
+	{
+		size_t index = m_activeIndices[c->m_poolSlot];
+		size_t lastIndex = m_activeComponents.size() - 1;
+
+		// The component has been detached by now, so its entity comes from the dense entity array.
+		size_t entityIndex = m_activeEntities[index];
+		if (entityIndex != c_invalidIndex && m_entityPositions[entityIndex] == index)
+		{
+			m_entityPositions[entityIndex] = c_invalidIndex;
+		}
+
+		Component* last = m_activeComponents[lastIndex];
+		size_t lastEntityIndex = m_activeEntities[lastIndex];
+		m_activeComponents[index] = last;
+		m_activeEntities[index] = lastEntityIndex;
+		m_activeIndices[last->m_poolSlot] = index;
+		m_enabledBits.Assign(index, m_enabledBits.Test(lastIndex));
+		m_firstUpdatedBits.Assign(index, m_firstUpdatedBits.Test(lastIndex));
+		m_synchronisedBits.Assign(index, m_synchronisedBits.Test(lastIndex));
+		m_renderBits.Assign(index, m_renderBits.Test(lastIndex));
+		if (lastEntityIndex != c_invalidIndex && m_entityPositions[lastEntityIndex] == lastIndex)
+		{
+			m_entityPositions[lastEntityIndex] = index;
+		}
+
+		m_activeComponents.pop_back();
+		m_activeEntities.pop_back();
+		m_enabledBits.PopBack();
+		m_firstUpdatedBits.PopBack();
+		m_synchronisedBits.PopBack();
+		m_renderBits.PopBack();
+		m_activeIndices[c->m_poolSlot] = c_invalidIndex;
 	}
-};
\ No newline at end of file
+};
@@ -25,10 +25,24 @@
 #pragma once
 
 #include <vector>
-#include <list>
-#include <set>
 #include <algorithm>
+#include <typeinfo>
 #include <boost/noncopyable.hpp>
+#include <boost/static_assert.hpp>
+#include <boost/type_traits/has_trivial_copy.hpp>
+
+// Chunked storage & capacity policies
+#include "PoolStorage.h"
+#include "PoolStatistics.h"
+#include "BitArray.h"
+#include "ComponentTypeIndex.h"
+#include "DataAccess.h"
+
+// Component (the typed pool calls into the statically dispatched update methods)
+#include "Component.h"
+
+// Workers for parallel updates
+#include "Core/WorkerPool.h"
 
 class GameTime;
 class GameContext;
@@ -43,17 +57,54 @@ namespace ComponentModel
 	 * Base class for component pools. Manages actually doing the updates for a given
 	 * type of component.
 	 *
-	 * Note that the priority & size of a given pool are set at creation time.
+	 * Components live in 'slots' - the typed pool stores them by value in contiguous
+	 * chunks, and this class tracks them by slot index. Active components are kept in a dense
+	 * array (so update walks never touch free slots), and removal from that array is
+	 * a swap-and-pop.
+	 *
+	 * The active components also form a sparse set keyed by entity index - alongside the dense
+	 * array the pool keeps the entity of each active component, and the active position of
+	 * each entity's component. This is what views use to join pools by entity.
+	 *
+	 * The state the updates check (enabled, first updated, synchronised) is kept in bit arrays parallel
+	 * to the dense array, so the updates only visit the components they'll actually update, and the
+	 * synchronise works out what the render thread may touch a word at a time. Every active component
+	 * is initialised, so the active range itself stands in for an 'initialised' set.
+	 *
+	 * Note that the priority & initial size of a given pool are set at creation time. What
+	 * happens when the pool runs out is decided by its capacity policy; growing adds a chunk, so
+	 * live components are never relocated.
 	 */
 	class ComponentPool : public boost::noncopyable
 	{
 	public:
-		ComponentPool(size_t poolSize, int updatePriority, const GameContext& gameContext) :
+		ComponentPool(ComponentTypeId typeId, size_t poolSize, int updatePriority, PoolCapacityPolicy capacityPolicy, const GameContext& gameContext) :
+			m_typeId(typeId),
 			m_updatePriority(updatePriority),
+			m_capacityPolicy(capacityPolicy),
+			m_highWaterMark(0),
+			m_acquireCount(0),
+			m_releaseCount(0),
+			m_lastFrameAcquires(0),
+			m_lastFrameReleases(0),
+			m_lastReleaseQueueDepth(0),
+			m_peakReleaseQueueDepth(0),
+			m_firstRestored(0),
+			m_workerPool(nullptr),
 			m_gameContext(gameContext)
 		{ 
 			m_components.reserve(poolSize);
+			m_activeComponents.reserve(poolSize);
+			m_activeIndices.reserve(poolSize);
+			m_activeEntities.reserve(poolSize);
+			m_enabledBits.Reserve(poolSize);
+			m_firstUpdatedBits.Reserve(poolSize);
+			m_synchronisedBits.Reserve(poolSize);
+			m_renderBits.Reserve(poolSize);
+			m_pendingRelease.reserve(poolSize);
+			m_freeSlots.reserve(poolSize);
 		}
+		virtual ~ComponentPool() {}
 
 		virtual bool HasPhysicsUpdate() const = 0;
 		virtual bool HasCoreUpdate() const = 0;
@@ -61,24 +112,227 @@ namespace ComponentModel
 		virtual bool HasRenderUpdate() const = 0;
 		virtual bool HasSynchroniseRenderData() const = 0;
 
-		void DoPhysicsUpdate(const GameTime& time);
-		void DoCoreUpdate(const GameTime& time);
-		void DoRenderUpdate(const GameTime& time);
-		void DoSynchroniseRenderData();
+		/// \name Data access
+		/// What the physics & core updates of the pooled type touch beyond the pool itself.
+		/// @{
+			virtual DataAccessMask GetReadAccess() const = 0;
+			virtual DataAccessMask GetWriteAccess() const = 0;
+		/// @}
+
+		/// \name Parallel updates
+		/// @{
+			virtual bool IsParallelSafe() const = 0;
+			virtual size_t GetParallelThreshold() const = 0;
+			/// Sets the workers used to split updates of parallel safe types (nullptr to always update serially).
+			void SetWorkerPool(WorkerPool* workerPool) { m_workerPool = workerPool; }
+		/// @}
+
+		/// \name Updates
+		/// The base implementations dispatch virtually through Component; typed pools override
+		/// these with statically dispatched loops where the component type allows it.
+		/// @{
+			virtual void DoPhysicsUpdate(const GameTime& time);
+			virtual void DoCoreUpdate(const GameTime& time);
+			virtual void DoRenderUpdate(const GameTime& time);
+		/// @}
+		void DoSynchroniseRenderData() { DoSynchroniseRenderData(HasSynchroniseRenderData(), HasNonRenderUpdate()); }
+		/// As above, for callers which already know the pool's capabilities.
+		void DoSynchroniseRenderData(bool hasSynchronise, bool hasNonRender);
 
 		int GetUpdatePriority() const { return m_updatePriority; }
+		ComponentTypeId GetTypeId() const { return m_typeId; }
 
+		/// Gets a free component, or nullptr if the pool is exhausted and may not grow.
 		Component* GetFreeComponent();
 		void ReleaseComponentDeferred(Component* c);
 
+		/// Releases every component bar those attached to persistent entities (and not queued for release)
+		/// straight away, for a world reset - the entity manager detaches everything else first. The
+		/// subscriptions the components made are dropped in one sweep of the message hub, then each component
+		/// gets a BulkCleanup. The survivors keep their state. Like the synchronise, this may only be called
+		/// while the render thread isn't walking the pool. Returns the number released.
+		size_t ReleaseForReset();
+
+		/// Makes sure 'count' components can be handed out without the pool growing part way
+		/// through (growing now if the policy allows). Returns whether that many are free.
+		bool Reserve(size_t count);
+
+		/// \name Capacity
+		/// @{
+			virtual const char* GetTypeName() const = 0;
+			PoolCapacityPolicy GetCapacityPolicy() const { return m_capacityPolicy; }
+			size_t GetCapacity() const { return m_components.size(); }
+			/// Number of components currently handed out (including those pending release)
+			size_t GetLiveCount() const { return m_components.size() - m_freeSlots.size(); }
+			/// The largest number of components that have been handed out at once.
+			size_t GetHighWaterMark() const { return m_highWaterMark; }
+			/// Size of one pooled component.
+			virtual size_t GetComponentSize() const = 0;
+			/// Memory held for every slot of the pool (used or not), plus its bookkeeping.
+			size_t GetReservedBytes() const;
+		/// @}
+
+		/// Gets the occupancy, churn & memory use of the pool.
+		PoolStatistics GetStatistics() const;
+
+		/// \name Snapshots
+		/// See EntityComponentManager::Snapshot. Only the active components of entities which aren't persistent
+		/// are saved - the pool is expected to be fully synchronised (nothing acquired or released but not yet applied).
+		/// @{
+			virtual SnapshotMode GetSnapshotMode() const = 0;
+			/// Writes the free slots & the components. Returns false if there are components to write, but their type
+			/// can't be snapshotted.
+			bool SaveSnapshot(SnapshotWriter& writer) const;
+			/// Reads back what SaveSnapshot wrote into a pool which has just been reset, attaching each component to
+			/// its (already restored) entity & putting it straight back into the active range with the state it had.
+			bool LoadSnapshot(SnapshotReader& reader, ChunkedStorage<Entity>& entities);
+			/// Calls OnRestored on everything the last LoadSnapshot restored.
+			void NotifyRestored();
+		/// @}
+
+		/// Updates the enabled bit of an active component (from its & its entity's enabled state).
+		void RefreshEnabledState(Component* c);
+
+		/// \name Active set
+		/// The active components, and their entities. These only change during the synchronise.
+		/// @{
+			size_t GetActiveCount() const { return m_activeComponents.size(); }
+			Component* GetActiveComponent(size_t position) const { return m_activeComponents[position]; }
+			/// Position of an active component in the active range (c_invalidIndex if it isn't active).
+			size_t GetActivePosition(const Component* c) const { return m_activeIndices[c->m_poolSlot]; }
+			/// Entity index of the active component at 'position' (c_invalidIndex if it was activated without an entity).
+			size_t GetActiveEntityIndex(size_t position) const { return m_activeEntities[position]; }
+
+			/// Gets the active component of the entity with the index given, or nullptr if it has none.
+			/// Where an entity has several components of the type, this is the first to have been activated.
+			Component* FindActiveByEntity(size_t entityIndex) const
+			{
+				if (entityIndex >= m_entityPositions.size() || m_entityPositions[entityIndex] == c_invalidIndex)
+				{
+					return nullptr;
+				}
+				return m_activeComponents[m_entityPositions[entityIndex]];
+			}
+		/// @}
+
+	protected:
+		/// Adds another chunk of components to the pool.
+		virtual void Grow() = 0;
+
+		/// \name Snapshots
+		/// Writes & reads the state of one component (see SnapshotMode).
+		/// @{
+			virtual void SaveComponent(const Component* c, SnapshotWriter& writer) const = 0;
+			virtual void LoadComponent(Component* c, SnapshotReader& reader) = 0;
+		/// @}
+
+		/// Applies the capacity policy when there are no free slots. Returns true if a slot is now free.
+		bool HandleExhausted();
+
+		/// Registers a component living in the typed storage as the next slot of the pool.
+		void AddSlot(Component* c);
+
+		/// Moves a component into the dense active range.
+		void Activate(Component* c);
+
+		/// Swaps the last active component into the position of the one being removed.
+		void Deactivate(Component* c);
+
+		/// Whether updates should be split across the worker pool.
+		bool ShouldUpdateInParallel() const
+		{
+			return m_workerPool != nullptr && IsParallelSafe() && m_activeComponents.size() >= GetParallelThreshold();
+		}
+
+		/// Suspends (or resumes) recording on the calling thread, around a chunk of a parallel update.
+		void SetChunkRecordingSuspended(bool suspended);
+
+		/// Whether the component & its entity are both enabled.
+		static bool IsEnabled(const Component* c) { return c->m_enabled && c->m_entity != nullptr && c->m_entity->GetEnabled(); }
+
+	private:
+		/// How a component is kept in a snapshot - followed by whatever its type writes.
+		struct SnapshotRecord
+		{
+			unsigned int m_slot;
+			unsigned int m_entityIndex;
+			unsigned char m_enabled;
+			unsigned char m_state;
+			unsigned char m_flags; // SnapshotFlags
+		};
+
+		/// The state bits of an active component, in a snapshot.
+		enum SnapshotFlags
+		{
+			SF_ENABLED = 1 << 0,
+			SF_FIRST_UPDATED = 1 << 1,
+			SF_SYNCHRONISED = 1 << 2,
+			SF_RENDER = 1 << 3,
+		};
+
+		/// Whether the component goes in a snapshot.
+		static bool IsSnapshotted(const Component* c) { return c->m_entity != nullptr && !c->m_entity->GetPersistent(); }
+
+		/// Synchronises the components flagged in m_synchroniseBits in [begin, end)
+		void SynchroniseActiveRange(size_t begin, size_t end);
+
+		/// Whether the component is kept by a world reset.
+		bool SurvivesReset(const Component* c) const
+		{
+			return !m_pendingRelease[c->m_poolSlot] && c->m_entity != nullptr && c->m_entity->GetPersistent();
+		}
+
+	public:
+		static const size_t c_invalidIndex = static_cast<size_t>(-1);
+
 	protected:
+		/// Parallel updates never split the active components into chunks smaller than this.
+		static const size_t c_minParallelChunkSize = 64;
+
+		// Slot index -> component (the components themselves are owned by the typed pool)
 		std::vector<Component*> m_components;
-		std::list<Component*> m_freeList;
-		std::list<Component*> m_usedList;
-		std::list<Component*> m_acquireList;
-		std::set<Component*> m_releaseSet;
+		// Slot index -> position in the dense active array (c_invalidIndex if not active)
+		std::vector<size_t> m_activeIndices;
+		// Slot index -> whether a release is pending for the slot
+		std::vector<bool> m_pendingRelease;
+
+		// Dense array of active components, this is what all of the updates walk.
+		std::vector<Component*> m_activeComponents;
+		// Entity index of each active component (parallel to the dense active array)
+		std::vector<size_t> m_activeEntities;
+		// Entity index -> position in the dense active array (c_invalidIndex if the entity has no active component)
+		std::vector<size_t> m_entityPositions;
 
+		// State of each active component (parallel to the dense active array)
+		BitArray m_enabledBits;			// Component & entity enabled (kept up to date as they change)
+		BitArray m_firstUpdatedBits;	// Has had its first physics or core update
+		BitArray m_synchronisedBits;	// Has been synchronised at least once
+		BitArray m_renderBits;			// Should have its render update called (only changes during the synchronise)
+		BitArray m_synchroniseBits;		// Scratch - to be synchronised this time around
+		// Stack of free slot indices.
+		std::vector<size_t> m_freeSlots;
+		// Components handed out since the last synchronise (initialised in the next one)
+		std::vector<Component*> m_acquiredComponents;
+		// Components released since the last synchronise.
+		std::vector<Component*> m_releasedComponents;
+
+		ComponentTypeId m_typeId;
 		int m_updatePriority;
+		PoolCapacityPolicy m_capacityPolicy;
+		size_t m_highWaterMark;
+
+		// Churn - counted since the last synchronise, and as of the last synchronise
+		size_t m_acquireCount;
+		size_t m_releaseCount;
+		size_t m_lastFrameAcquires;
+		size_t m_lastFrameReleases;
+		size_t m_lastReleaseQueueDepth;
+		size_t m_peakReleaseQueueDepth;
+
+		// Where the components restored by the last LoadSnapshot start in the active range.
+		size_t m_firstRestored;
+
+		WorkerPool* m_workerPool;
 
 		const GameContext& m_gameContext;
  	};
@@ -86,32 +340,172 @@ namespace ComponentModel
 	/**
 	 * Typed component provides type specific functionality for component pools +
 	 * instantiation of all components of that type.
+	 *
+	 * All components are constructed in place in aligned chunks, so walking the active
+	 * components walks (mostly) sequential memory rather than scattered heap allocations.
 	 */
 	template <class T>
 	class TypedComponentPool : public ComponentPool
 	{
 	public:
-		TypedComponentPool(size_t poolSize, int updatePriority, const GameContext& gameContext) :
-			ComponentPool(poolSize, updatePriority, gameContext)
+		TypedComponentPool(ComponentTypeId typeId, size_t poolSize, int updatePriority, PoolCapacityPolicy capacityPolicy, const GameContext& gameContext) :
+			ComponentPool(typeId, poolSize, updatePriority, capacityPolicy, gameContext),
+			m_storage(poolSize)
 		{
-			for (size_t i = 0; i < poolSize; ++i)
-			{
-				T* newComponent = new T();
-				m_components.push_back(newComponent);
-				m_freeList.push_back(newComponent);
-			}
+			ComponentTypeIndex<T>::s_index = typeId;
+			Grow();
 		}
 		~TypedComponentPool()
 		{
-			m_freeList.clear();
-			m_usedList.clear();
-			std::for_each(m_components.begin(), m_components.end(), [](Component* c) { delete c; });
+			ComponentTypeIndex<T>::s_index = c_invalidComponentType;
+			m_activeComponents.clear();
+			m_activeEntities.clear();
+			m_entityPositions.clear();
+			m_acquiredComponents.clear();
+			m_releasedComponents.clear();
 			m_components.clear();
 		}
 
+		virtual const char* GetTypeName() const { return typeid(T).name(); }
+		virtual size_t GetComponentSize() const { return sizeof(T); }
+		virtual SnapshotMode GetSnapshotMode() const { return T::GetSnapshotMode(); }
+
 		virtual bool HasPhysicsUpdate() const { return T::HasPhysicsUpdate(); }
 		virtual bool HasCoreUpdate() const { return T::HasCoreUpdate(); }
 		virtual bool HasRenderUpdate() const { return T::HasRenderUpdate(); }
 		virtual bool HasSynchroniseRenderData() const { return T::HasSynchroniseRenderData(); }
+
+		// Every update checks its entity's enabled state, whether the type declares it or not.
+		virtual DataAccessMask GetReadAccess() const { return T::GetReadAccess() | DA_ENTITY_STATE; }
+		virtual DataAccessMask GetWriteAccess() const { return T::GetWriteAccess(); }
+
+		virtual bool IsParallelSafe() const { return T::IsParallelSafe(); }
+		virtual size_t GetParallelThreshold() const { return T::GetParallelThreshold(); }
+
+		virtual void DoPhysicsUpdate(const GameTime& time)
+		{
+			if (!T::HasStaticDispatch())
+			{
+				ComponentPool::DoPhysicsUpdate(time);
+				return;
+			}
+
+			ForEachActiveRange([this, &time](size_t begin, size_t end)
+			{
+				for (size_t i = m_enabledBits.FindNext(begin, end); i < end; i = m_enabledBits.FindNext(i + 1, end))
+				{
+					Component* c = m_activeComponents[i];
+					if (!m_firstUpdatedBits.Test(i))
+					{
+						c->DoFirstCoreUpdateStatic<T>(time, m_gameContext);
+						m_firstUpdatedBits.Set(i);
+					}
+					static_cast<T*>(c)->T::PhysicsUpdate(time, m_gameContext);
+				}
+			});
+		}
+
+		virtual void DoCoreUpdate(const GameTime& time)
+		{
+			if (!T::HasStaticDispatch())
+			{
+				ComponentPool::DoCoreUpdate(time);
+				return;
+			}
+
+			ForEachActiveRange([this, &time](size_t begin, size_t end)
+			{
+				for (size_t i = m_enabledBits.FindNext(begin, end); i < end; i = m_enabledBits.FindNext(i + 1, end))
+				{
+					Component* c = m_activeComponents[i];
+					if (!m_firstUpdatedBits.Test(i))
+					{
+						c->DoFirstCoreUpdateStatic<T>(time, m_gameContext);
+						m_firstUpdatedBits.Set(i);
+					}
+					static_cast<T*>(c)->T::CoreUpdate(time, m_gameContext);
+				}
+			});
+		}
+
+		virtual void DoRenderUpdate(const GameTime& time)
+		{
+			if (!T::HasStaticDispatch())
+			{
+				ComponentPool::DoRenderUpdate(time);
+				return;
+			}
+
+			// See ComponentPool::DoRenderUpdate re: reading the render bits here.
+			size_t count = m_renderBits.GetSize();
+			for (size_t i = m_renderBits.FindNext(0, count); i < count; i = m_renderBits.FindNext(i + 1, count))
+			{
+				static_cast<T*>(m_activeComponents[i])->T::RenderUpdate(time, m_gameContext);
+			}
+		}
+
+	protected:
+		/// Runs the update over the whole active range - split across the worker pool if
+		/// T is parallel safe & there are enough active components.
+		template <class RangeUpdate> void ForEachActiveRange(const RangeUpdate& rangeUpdate)
+		{
+			if (ShouldUpdateInParallel())
+			{
+				// Chunks mustn't make structural changes (see Component::IsParallelSafe).
+				m_workerPool->ParallelFor(m_activeComponents.size(), c_minParallelChunkSize, [this, &rangeUpdate](size_t begin, size_t end)
+				{
+					SetChunkRecordingSuspended(true);
+					rangeUpdate(begin, end);
+					SetChunkRecordingSuspended(false);
+				});
+			}
+			else
+			{
+				rangeUpdate(0, m_activeComponents.size());
+			}
+		}
+
+		// Bitwise snapshots copy only the type's plain state, never the component itself.
+		BOOST_STATIC_ASSERT(boost::has_trivial_copy<typename T::SnapshotState>::value);
+
+		virtual void SaveComponent(const Component* c, SnapshotWriter& writer) const
+		{
+			if (T::GetSnapshotMode() == SM_BITWISE)
+			{
+				const typename T::SnapshotState* state = static_cast<const T*>(c)->GetSnapshotState();
+				BOOST_ASSERT(state != nullptr);
+				writer.Write(static_cast<const void*>(state), sizeof(typename T::SnapshotState));
+			}
+			else
+			{
+				static_cast<const T*>(c)->T::SaveSnapshot(writer);
+			}
+		}
+
+		virtual void LoadComponent(Component* c, SnapshotReader& reader)
+		{
+			if (T::GetSnapshotMode() == SM_BITWISE)
+			{
+				typename T::SnapshotState* state = static_cast<T*>(c)->GetSnapshotState();
+				BOOST_ASSERT(state != nullptr);
+				reader.Read(static_cast<void*>(state), sizeof(typename T::SnapshotState));
+			}
+			else
+			{
+				static_cast<T*>(c)->T::LoadSnapshot(reader, m_gameContext);
+			}
+		}
+
+		virtual void Grow()
+		{
+			T* chunk = m_storage.AddChunk();
+			for (size_t i = 0; i < m_storage.GetChunkSize(); ++i)
+			{
+				AddSlot(chunk + i);
+			}
+		}
+
+	private:
+		ChunkedStorage<T> m_storage;
 	};
-};
\ No newline at end of file
+};
@@ -0,0 +1,231 @@
+/*
+ * This source file is part of one of Jeremy Burgess's samples.
+ *
+ * Copyright (c) 2013 Jeremy Burgess
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+// Boost headers
+#include <boost/mpl/vector.hpp>
+#include <boost/mpl/sort.hpp>
+#include <boost/mpl/for_each.hpp>
+#include <boost/mpl/find_if.hpp>
+#include <boost/mpl/distance.hpp>
+#include <boost/mpl/begin_end.hpp>
+#include <boost/mpl/size.hpp>
+#include <boost/mpl/bool.hpp>
+#include <boost/type_traits/is_same.hpp>
+#include <boost/static_assert.hpp>
+#include <boost/assert.hpp>
+
+// Project headers
+#include "EntityComponentManager.h"
+
+namespace ComponentModel
+{
+	/**
+	 * \struct ComponentRegistration
+	 *
+	 * One entry in a ComponentRegistry: the component type, the initial size of its pool, its update
+	 * priority (lower = earlier) & what happens when its pool runs out.
+	 */
+	template <class T, size_t PoolSize, int UpdatePriority, PoolCapacityPolicy CapacityPolicy = PCP_GROW>
+	struct ComponentRegistration
+	{
+		typedef T Type;
+		static const size_t c_poolSize = PoolSize;
+		static const int c_updatePriority = UpdatePriority;
+		static const PoolCapacityPolicy c_capacityPolicy = CapacityPolicy;
+	};
+
+	/**
+	 * \class ComponentRegistry
+	 *
+	 * Compile time registry of every component type the game uses, declared once as a boost::mpl
+	 * sequence of ComponentRegistrations - e.g.
+	 *
+	 *	typedef ComponentRegistry< boost::mpl::vector<
+	 *		ComponentRegistration<Box2DBodyComponent, 100, 0>,
+	 *		ComponentRegistration<CameraComponent, 5, 10, PCP_FAIL_FAST> > > GameComponents;
+	 *	GameComponents::Register(entityManager);
+	 *
+	 * Each type's index is its position in the list (IndexOf), and the update order (UpdateOrder) is
+	 * worked out at compile time. Register creates the pools in list order, then hands the entity
+	 * component manager serial physics, core, render & synchronise phases which are unrolled over the
+	 * types in update order - the capabilities (HasCoreUpdate etc.) are the types' own static methods,
+	 * so pools without an update drop out when compiled, & each pool is called without virtual dispatch.
+	 *
+	 * The manager keeps its update lists for everything else (the parallel update graphs, statistics,
+	 * world resets...), so these are still built - once, when registering.
+	 */
+	template <class Registrations>
+	class ComponentRegistry
+	{
+	private:
+		template <class T> struct IsRegistrationOf
+		{
+			template <class R> struct apply : boost::is_same<typename R::Type, T> {};
+		};
+
+	public:
+		static const ComponentTypeId c_typeCount = boost::mpl::size<Registrations>::value;
+		BOOST_STATIC_ASSERT(c_typeCount <= c_maxComponentTypes);
+
+		/// Index of registered type T - the same as ComponentTypeIndex<T>::Get() once registered.
+		template <class T> struct IndexOf
+		{
+			typedef typename boost::mpl::find_if<Registrations, IsRegistrationOf<T> >::type Position;
+			BOOST_STATIC_ASSERT((!boost::is_same<Position, typename boost::mpl::end<Registrations>::type>::value));
+			static const ComponentTypeId value = boost::mpl::distance<typename boost::mpl::begin<Registrations>::type, Position>::value;
+		};
+
+		/// Orders registrations by priority, then by position in the list (as the manager's update lists do).
+		struct UpdateOrderLess
+		{
+			template <class A, class B> struct apply : boost::mpl::bool_<
+				(A::c_updatePriority < B::c_updatePriority) ||
+				(A::c_updatePriority == B::c_updatePriority && IndexOf<typename A::Type>::value < IndexOf<typename B::Type>::value)> {};
+		};
+		typedef typename boost::mpl::sort<Registrations, UpdateOrderLess>::type UpdateOrder;
+
+		/// Creates the pools for every type (the manager mustn't have any yet), builds the update lists
+		/// & installs the unrolled update phases.
+		static void Register(EntityComponentManager& ecm)
+		{
+			BOOST_ASSERT(ecm.m_componentPools.empty());
+			boost::mpl::for_each<Registrations>(Registerer(&ecm));
+			ecm.RefreshUpdateLists();
+			ecm.m_physicsPhase = &PhysicsUpdate;
+			ecm.m_corePhase = &CoreUpdate;
+			ecm.m_renderPhase = &RenderUpdate;
+			ecm.m_synchronisePhase = &SynchroniseRenderData;
+		}
+
+		/// Gets the pool of registered type T.
+		template <class T> static TypedComponentPool<T>* GetPool(EntityComponentManager& ecm)
+		{
+			return static_cast<TypedComponentPool<T>*>(ecm.m_componentPools[IndexOf<T>::value]);
+		}
+
+	private:
+		/// \name Phases
+		/// @{
+			static void PhysicsUpdate(EntityComponentManager& ecm, const GameTime& time)
+			{
+				size_t poolOrder = 0;
+				boost::mpl::for_each<UpdateOrder>(PhysicsUpdater(&ecm, &time, &poolOrder));
+			}
+
+			static void CoreUpdate(EntityComponentManager& ecm, const GameTime& time)
+			{
+				size_t poolOrder = 0;
+				boost::mpl::for_each<UpdateOrder>(CoreUpdater(&ecm, &time, &poolOrder));
+			}
+
+			static void RenderUpdate(EntityComponentManager& ecm, const GameTime& time)
+			{
+				boost::mpl::for_each<UpdateOrder>(RenderUpdater(&ecm, &time));
+			}
+
+			static void SynchroniseRenderData(EntityComponentManager& ecm)
+			{
+				boost::mpl::for_each<UpdateOrder>(Synchroniser(&ecm));
+			}
+		/// @}
+
+		static void SetRecordingSource(EntityComponentManager* ecm, size_t poolOrder) { ecm->SetRecordingSource(poolOrder); }
+
+		/// \name Per type steps of the phases (the branches on the type's capabilities are constant)
+		/// @{
+			struct Registerer
+			{
+				Registerer(EntityComponentManager* ecm) : m_ecm(ecm) {}
+				template <class R> void operator()(R) const
+				{
+					m_ecm->AddComponentType<typename R::Type>(R::c_poolSize, R::c_updatePriority, R::c_capacityPolicy);
+					BOOST_ASSERT(ComponentTypeIndex<typename R::Type>::Get() == IndexOf<typename R::Type>::value);
+				}
+				EntityComponentManager* m_ecm;
+			};
+
+			struct PhysicsUpdater
+			{
+				PhysicsUpdater(EntityComponentManager* ecm, const GameTime* time, size_t* poolOrder) : m_ecm(ecm), m_time(time), m_poolOrder(poolOrder) {}
+				template <class R> void operator()(R) const
+				{
+					typedef typename R::Type T;
+					if (T::HasPhysicsUpdate())
+					{
+						SetRecordingSource(m_ecm, (*m_poolOrder)++);
+						GetPool<T>(*m_ecm)->TypedComponentPool<T>::DoPhysicsUpdate(*m_time);
+					}
+				}
+				EntityComponentManager* m_ecm;
+				const GameTime* m_time;
+				size_t* m_poolOrder;
+			};
+
+			struct CoreUpdater
+			{
+				CoreUpdater(EntityComponentManager* ecm, const GameTime* time, size_t* poolOrder) : m_ecm(ecm), m_time(time), m_poolOrder(poolOrder) {}
+				template <class R> void operator()(R) const
+				{
+					typedef typename R::Type T;
+					if (T::HasCoreUpdate())
+					{
+						SetRecordingSource(m_ecm, (*m_poolOrder)++);
+						GetPool<T>(*m_ecm)->TypedComponentPool<T>::DoCoreUpdate(*m_time);
+					}
+				}
+				EntityComponentManager* m_ecm;
+				const GameTime* m_time;
+				size_t* m_poolOrder;
+			};
+
+			struct RenderUpdater
+			{
+				RenderUpdater(EntityComponentManager* ecm, const GameTime* time) : m_ecm(ecm), m_time(time) {}
+				template <class R> void operator()(R) const
+				{
+					typedef typename R::Type T;
+					if (T::HasRenderUpdate())
+					{
+						GetPool<T>(*m_ecm)->TypedComponentPool<T>::DoRenderUpdate(*m_time);
+					}
+				}
+				EntityComponentManager* m_ecm;
+				const GameTime* m_time;
+			};
+
+			struct Synchroniser
+			{
+				Synchroniser(EntityComponentManager* ecm) : m_ecm(ecm) {}
+				template <class R> void operator()(R) const
+				{
+					typedef typename R::Type T;
+					GetPool<T>(*m_ecm)->DoSynchroniseRenderData(T::HasSynchroniseRenderData(), T::HasPhysicsUpdate() || T::HasCoreUpdate());
+				}
+				EntityComponentManager* m_ecm;
+			};
+		/// @}
+	};
+};
@@ -0,0 +1,68 @@
+/*
+ * This source file is part of one of Jeremy Burgess's samples.
+ *
+ * Copyright (c) 2013 Jeremy Burgess 
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+namespace ComponentModel
+{
+	template <class T> class TypedComponentPool;
+
+	/// Dense index identifying a registered component type.
+	typedef unsigned int ComponentTypeId;
+
+	/// Maximum number of registered component types (one bit each in an entity's component mask).
+	const ComponentTypeId c_maxComponentTypes = 32;
+
+	/// Index of any type which hasn't been registered with the entity component manager.
+	const ComponentTypeId c_invalidComponentType = static_cast<ComponentTypeId>(-1);
+
+	/// Mask with one bit per component type.
+	typedef unsigned int ComponentTypeMask;
+
+	/**
+	 * \class ComponentTypeIndex
+	 *
+	 * Holds the dense index of component type T. The index is handed out when the type is registered
+	 * with the entity component manager (in registration order), and is the index of the type's pool
+	 * and of its slot in every entity's component table - so no RTTI is needed to find either.
+	 *
+	 * The index is a plain static, constant initialised to invalid, so reading it is always safe.
+	 * It is set for the lifetime of the type's pool.
+	 */
+	template <class T>
+	class ComponentTypeIndex
+	{
+	public:
+		friend class TypedComponentPool<T>; // The pool for T holds the index while it exists.
+
+		static ComponentTypeId Get() { return s_index; }
+		static bool IsRegistered() { return s_index != c_invalidComponentType; }
+
+	private:
+		static ComponentTypeId s_index;
+	};
+
+	template <class T>
+	ComponentTypeId ComponentTypeIndex<T>::s_index = c_invalidComponentType;
+};
@@ -0,0 +1,58 @@
+/*
+ * This source file is part of one of Jeremy Burgess's samples.
+ *
+ * Copyright (c) 2013 Jeremy Burgess 
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+namespace ComponentModel
+{
+	/// The shared data a component type's physics & core updates may touch. Each component type
+	/// declares what it reads & writes (static GetReadAccess/GetWriteAccess, in the same manner as
+	/// HasCoreUpdate et al), and the entity component manager uses the declarations to decide
+	/// which pools may update at the same time.
+	///
+	/// A pool's own components are never shared data - only what the update reaches beyond them.
+	enum DataAccess
+	{
+		DA_NONE				= 0,
+		DA_ENTITY_TRANSFORM	= 1 << 0,	///< Entity position, orientation & scale.
+		DA_ENTITY_STATE		= 1 << 1,	///< Entity & component enabled state, names & tags. Every update reads this.
+		DA_ENTITY_STRUCTURE	= 1 << 2,	///< Entity & pool internals. Structural changes made through the manager are recorded (see CommandBuffer), so don't count.
+		DA_PHYSICS			= 1 << 3,	///< The Box2D world & anything in it (Box2D isn't thread safe).
+		DA_MESSAGE_HUB		= 1 << 4,	///< Raising & subscribing to events. Listeners run on the raising thread, so listening counts as reading.
+		DA_COMPONENT_DATA	= 1 << 5,	///< Components of other types, or components another type's update modifies.
+		DA_RENDER_DATA		= 1 << 6,	///< Quads, cameras & the renderers.
+		DA_INPUT			= 1 << 7,	///< The input system.
+		DA_ALL				= 0xFF,
+	};
+
+	/// Combination of DataAccess flags.
+	typedef unsigned int DataAccessMask;
+
+	/// Whether two updates with the access given may not run at the same time - i.e. either writes
+	/// something the other touches.
+	inline bool AccessConflicts(DataAccessMask firstRead, DataAccessMask firstWrite, DataAccessMask secondRead, DataAccessMask secondWrite)
+	{
+		return (firstWrite & (secondRead | secondWrite)) != 0 || (secondWrite & firstRead) != 0;
+	}
+};
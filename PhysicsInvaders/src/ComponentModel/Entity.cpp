@@ -29,23 +29,60 @@
 #include "EntityComponentManager.h"
 
 ComponentModel::Entity::Entity() :
-	m_position(Eigen::Vector3f::Zero()),
-	m_orientation(Eigen::Quaternionf::Identity()),
-	m_scale(1),
 	m_enabled(true),
-	m_isAlive(false)
-{}
+	m_nameId(c_noName),
+	m_isAlive(false),
+	m_persistent(false),
+	m_index(0),
+	m_generation(1),
+	m_transform(nullptr),
+	m_transformSlot(0),
+	m_parent(nullptr),
+	m_recordingBuffer(nullptr),
+	m_componentMask(0)
+{
+	std::fill(m_componentSlots, m_componentSlots + c_maxComponentTypes, nullptr);
+}
 
 void ComponentModel::Entity::AddComponent(Component* c)
 {
 	m_components.push_back(c);
 	c->SetEntity(this);
+
+	// Slot the component in for fast lookup (if it's the first of its type).
+	ComponentTypeId typeId = c->GetTypeId();
+	if (typeId < c_maxComponentTypes && m_componentSlots[typeId] == nullptr)
+	{
+		m_componentSlots[typeId] = c;
+		m_componentMask |= (1u << typeId);
+	}
 }
 
 void ComponentModel::Entity::RemoveComponent(Component* c)
 {
 	c->SetEntity(nullptr);
 	m_components.erase(std::find(m_components.begin(), m_components.end(), c));
+
+	ComponentTypeId typeId = c->GetTypeId();
+	if (typeId < c_maxComponentTypes && m_componentSlots[typeId] == c)
+	{
+		// If there's another component of the same type, it takes over the slot.
+		auto otherIt = std::find_if(m_components.begin(), m_components.end(), [typeId](Component* other) { return other->GetTypeId() == typeId; });
+		m_componentSlots[typeId] = otherIt != m_components.end() ? *otherIt : nullptr;
+		if (m_componentSlots[typeId] == nullptr)
+		{
+			m_componentMask &= ~(1u << typeId);
+		}
+	}
+}
+
+void ComponentModel::Entity::SetEnabled(bool enabled)
+{
+	m_enabled = enabled;
+	for (auto cIt = m_components.begin(); cIt != m_components.end(); ++cIt)
+	{
+		(*cIt)->RefreshEnabledState();
+	}
 }
 
 void ComponentModel::Entity::RemoveAllComponents(ComponentModel::EntityComponentManager* ecm)
@@ -56,13 +93,110 @@ void ComponentModel::Entity::RemoveAllComponents(ComponentModel::EntityComponent
 	}
 }
 
+void ComponentModel::Entity::DetachAllComponents()
+{
+	for (auto cIt = m_components.begin(); cIt != m_components.end(); ++cIt)
+	{
+		(*cIt)->m_entity = nullptr;
+	}
+	m_components.clear();
+	std::fill(m_componentSlots, m_componentSlots + c_maxComponentTypes, nullptr);
+	m_componentMask = 0;
+}
+
+const std::string& ComponentModel::Entity::GetName() const
+{
+	return m_manager->GetNames().GetString(m_nameId);
+}
+
+void ComponentModel::Entity::SetName(const std::string& name)
+{
+	SetName(m_manager->InternName(name));
+}
+
+void ComponentModel::Entity::SetName(NameId name)
+{
+	m_manager->SetEntityName(this, name);
+}
+
+void ComponentModel::Entity::AddTag(const std::string& tag)
+{
+	m_manager->AddEntityTag(this, m_manager->InternName(tag));
+}
+
+void ComponentModel::Entity::RemoveTag(const std::string& tag)
+{
+	NameId tagId;
+	if (m_manager->GetNames().TryGetId(tag, tagId))
+	{
+		m_manager->RemoveEntityTag(this, tagId);
+	}
+}
+
+bool ComponentModel::Entity::HasTag(NameId tag) const
+{
+	return std::find(m_tags.begin(), m_tags.end(), tag) != m_tags.end();
+}
+
+void ComponentModel::Entity::SetParent(Entity* parent)
+{
+	if (parent == m_parent)
+	{
+		return;
+	}
+
+#ifdef BUILD_DEBUG
+	for (Entity* ancestor = parent; ancestor != nullptr; ancestor = ancestor->m_parent)
+	{
+		BOOST_ASSERT(ancestor != this);
+	}
+#endif
+
+	if (m_parent != nullptr)
+	{
+		m_parent->m_children.erase(std::find(m_parent->m_children.begin(), m_parent->m_children.end(), this));
+	}
+	m_parent = parent;
+	if (m_parent != nullptr)
+	{
+		m_parent->m_children.push_back(this);
+	}
+	m_transform->MarkWorldDirty(m_transformSlot);
+}
+
+void ComponentModel::Entity::DetachFromHierarchy()
+{
+	SetParent(nullptr);
+	for (auto chIt = m_children.begin(); chIt != m_children.end(); ++chIt)
+	{
+		(*chIt)->m_parent = nullptr;
+		(*chIt)->m_transform->MarkWorldDirty((*chIt)->m_transformSlot);
+	}
+	m_children.clear();
+}
+
+bool ComponentModel::Entity::IsTransformDirty() const
+{
+	for (const Entity* e = this; e != nullptr; e = e->m_parent)
+	{
+		if (e->m_transform->IsDirty(e->m_transformSlot))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
 Eigen::Affine3f ComponentModel::Entity::GetTransform() const
 {
-	Eigen::Affine3f transform(Eigen::Affine3f::Identity());
-	transform.prerotate(m_orientation);
-	transform.prescale(m_scale);
-	transform.pretranslate(m_position);
-	return transform;
+	if (!IsTransformDirty())
+	{
+		return m_transform->GetWorldTransform(m_transformSlot);
+	}
+
+	// Out of date - work it out (leaving the cache to the manager, as anyone may be reading it).
+	Eigen::Affine3f local(m_transform->GetLocalTransform(m_transformSlot));
+	return m_parent != nullptr ? m_parent->GetTransform() * local : local;
 }
 
 void ComponentModel::Entity::Destroy()
@@ -31,16 +31,25 @@
 // Eigen
 #include "Core/EigenIncludes.h"
 
+// Component model
+#include "ComponentTypeIndex.h"
+#include "EntityHandle.h"
+#include "NameTable.h"
+#include "TransformStore.h"
+
 namespace ComponentModel
 {
 	class Component;
 	class EntityComponentManager;
+	class CommandBuffer;
 
 	/**
 	 * \class Entity
 	 *
 	 * Represents a generic entity (or 'game object') in the entity component model.
-	 * Holds transform data as well as a name field for use in lookup/identification.
+	 * Gives access to its transform (which lives in the manager's transform store) as well as a
+	 * name field for use in lookup/identification. Entities may be parented to one another, in which
+	 * case their transform is relative to their parent's.
 	 * Holds the list of components which define the behaviour of this entity.
 	 */
 	class Entity
@@ -57,9 +66,17 @@ namespace ComponentModel
 		void RemoveComponent(Component* c);
 		void RemoveAllComponents(EntityComponentManager* ecm);
 
+		/// Gets the first component which is a T (respecting polymorphism). If T is a registered
+		/// component type and the entity has one, this is a constant time lookup, otherwise
+		/// the components are searched.
 		template<class T>
 		T* GetComponentByType()
 		{
+			if (T* exact = GetComponentByTypeFast<T>())
+			{
+				return exact;
+			}
+
 			for each (Component* c in m_components)
 			{
 				T* cAsT = dynamic_cast<T*>(c);
@@ -73,37 +90,107 @@ namespace ComponentModel
 
 		/// Version of GetComponentByType which does _NOT_ respect polymorphism,
 		/// i.e., will only return the component if it is of the type passed exactly.
+		/// Constant time - just a lookup in the component slot table.
 		template<class T>
 		T* GetComponentByTypeFast()
 		{
-			const type_info& typeInfoT = typeid(T);
-			for each (Component* c in m_components)
-			{
-				const type_info& typeInfoC = typeid(*c);
-				if (typeInfoC == typeInfoT)
-				{
-					return static_cast<T*>(c);
-				}
-			}
-			return nullptr;
+			ComponentTypeId typeId = ComponentTypeIndex<T>::Get();
+			return typeId < c_maxComponentTypes ? static_cast<T*>(m_componentSlots[typeId]) : nullptr;
 		}
 
-		inline void SetPosition(const Eigen::Vector3f& position) { m_position = position; }
-		inline const Eigen::Vector3f& GetPosition() const { return m_position; }
-
-		inline void SetOrientation(const Eigen::Quaternionf& orientation) { m_orientation = orientation; }
-		inline const Eigen::Quaternionf& GetOrientation() const { return m_orientation; }
+		/// Whether the entity has a component of exactly type T.
+		template<class T>
+		bool HasComponent() const
+		{
+			ComponentTypeId typeId = ComponentTypeIndex<T>::Get();
+			return typeId < c_maxComponentTypes && (m_componentMask & (1u << typeId)) != 0;
+		}
 
-		inline void SetScale(float scale) { m_scale = scale; }
-		inline float GetScale() const { return m_scale; }
+		/// Mask of the registered component types this entity has (bit n set = has a component of type n)
+		inline ComponentTypeMask GetComponentMask() const { return m_componentMask; }
+
+		/// \name Transform
+		/// Accessors into the entity component manager's transform store. These are all local - relative 
+		/// to the parent, if there is one (which is the world transform if there isn't).
+		/// @{
+			inline void SetPosition(const Eigen::Vector3f& position) 
+			{ 
+				m_transform->Set(TransformStore::TS_X, m_transformSlot, position.x());
+				m_transform->Set(TransformStore::TS_Y, m_transformSlot, position.y());
+				m_transform->Set(TransformStore::TS_Z, m_transformSlot, position.z());
+			}
+			inline Eigen::Vector3f GetPosition() const 
+			{ 
+				return Eigen::Vector3f(m_transform->Get(TransformStore::TS_X, m_transformSlot), 
+					m_transform->Get(TransformStore::TS_Y, m_transformSlot), 
+					m_transform->Get(TransformStore::TS_Z, m_transformSlot)); 
+			}
 
-		inline void SetEnabled(bool enabled) { m_enabled = enabled; }
+			inline void SetOrientation(const Eigen::Quaternionf& orientation) { m_transform->SetOrientation(m_transformSlot, orientation); }
+			inline Eigen::Quaternionf GetOrientation() const { return m_transform->GetOrientation(m_transformSlot); }
+
+			/// Rotation about z (0 if the entity has been given any other orientation).
+			inline void SetAngle(float angle) { m_transform->SetAngle(m_transformSlot, angle); }
+			inline float GetAngle() const { return m_transform->Get(TransformStore::TS_ANGLE, m_transformSlot); }
+
+			inline void SetScale(float scale) { m_transform->Set(TransformStore::TS_SCALE, m_transformSlot, scale); }
+			inline float GetScale() const { return m_transform->Get(TransformStore::TS_SCALE, m_transformSlot); }
+
+			/// Keyframes for entities driven by a fixed step simulation - the entity component manager
+			/// interpolates the x, y & angle of every keyframed entity between its last two keyframes each
+			/// core update (see TransformStore). Keyframing stops when the entity is released, or when stopped
+			/// (entities at rest should stop, as everything interpolated is flagged as moved).
+			inline void ResetKeyframes(float x, float y, float angle) { m_transform->ResetKeyframes(m_transformSlot, x, y, angle); }
+			inline void PushKeyframe(float x, float y, float angle) { m_transform->PushKeyframe(m_transformSlot, x, y, angle); }
+			inline void StopKeyframes() { m_transform->StopKeyframes(m_transformSlot); }
+			inline bool IsKeyframed() const { return m_transform->IsKeyframed(m_transformSlot); }
+		/// @}
+
+		/// \name Hierarchy
+		/// Children move with their parent. Released entities leave their parent, and their children become
+		/// roots (keeping their local transforms). Changing the hierarchy is immediate, so counts as writing
+		/// DA_ENTITY_STRUCTURE.
+		/// @{
+			/// Parents this entity to another (or to nothing, if nullptr). The parent mustn't be a descendant.
+			void SetParent(Entity* parent);
+			inline Entity* GetParent() const { return m_parent; }
+			inline const std::vector<Entity*>& GetChildren() const { return m_children; }
+		/// @}
+
+		/// Enables or disables the entity (and so the updates of all of its components). See Component::SetEnabled.
+		void SetEnabled(bool enabled);
 		inline bool GetEnabled() const { return m_enabled; }
 
-		inline const std::string& GetName() const { return m_name; }
-		inline void SetName(const std::string& name) { m_name = name; } 
-
-		Eigen::Affine3f GetTransform() const;
+		/// Persistent entities survive a world reset (see EntityComponentManager::ResetWorld), along with their components.
+		inline void SetPersistent(bool persistent) { m_persistent = persistent; }
+		inline bool GetPersistent() const { return m_persistent; }
+
+		/// \name Names & tags
+		/// Names and tags are interned by the entity component manager, which keeps an index of
+		/// them so entities can be found by either in constant time.
+		/// @{
+			const std::string& GetName() const;
+			inline NameId GetNameId() const { return m_nameId; }
+			void SetName(const std::string& name);
+			void SetName(NameId name);
+
+			void AddTag(const std::string& tag);
+			void RemoveTag(const std::string& tag);
+			bool HasTag(NameId tag) const;
+			inline const std::vector<NameId>& GetTags() const { return m_tags; }
+		/// @}
+
+		/// \name World transform
+		/// The world transforms are cached by the entity component manager once a frame (after the core 
+		/// update). Until then, entities which have moved (or whose parents have) work theirs out on request.
+		/// @{
+			Eigen::Affine3f GetTransform() const;
+			inline Eigen::Vector3f GetWorldPosition() const { return m_parent ? GetTransform().translation() : GetPosition(); }
+			inline Eigen::Quaternionf GetWorldOrientation() const { return m_parent ? Eigen::Quaternionf(GetTransform().rotation()) : GetOrientation(); }
+		/// @}
+
+		/// Gets a handle to this entity, which stops resolving once the entity is released.
+		inline EntityHandle GetHandle() const { return EntityHandle(m_index, m_generation); }
 
 		void Destroy();
 
@@ -112,16 +199,40 @@ namespace ComponentModel
 		EntityComponentManager* GetEntityComponentManager() const { return m_manager; }
 		void SetAlive(bool isAlive) { m_isAlive = isAlive; }
 		bool GetAlive() const { return m_isAlive; }
+		/// Drops all components without releasing them (the pools release them wholesale in a world reset).
+		void DetachAllComponents();
+		/// Leaves the parent & orphans the children.
+		void DetachFromHierarchy();
+		/// Whether the cached world transform is out of date (the entity or one of its ancestors has changed).
+		bool IsTransformDirty() const;
 
 	private:
 		std::vector<Component*> m_components;
-		Eigen::Vector3f m_position;
-		Eigen::Quaternionf m_orientation;
-		float m_scale;
 		EntityComponentManager* m_manager;
 		bool m_enabled;
-		std::string m_name;
+		NameId m_nameId;
+		std::vector<NameId> m_tags;
 		bool m_isAlive;
+		bool m_persistent;
+
+		// Position in the entity pool, and how many times the entity has been recycled.
+		unsigned int m_index;
+		unsigned int m_generation;
+
+		// Chunk of the transform store holding this entity's transform (chunks never move), and the slot in it.
+		TransformStore::Chunk* m_transform;
+		unsigned int m_transformSlot;
+
+		// Transform hierarchy
+		Entity* m_parent;
+		std::vector<Entity*> m_children;
+
+		// Buffer of the thread which created this entity while recording (until the buffer is applied)
+		CommandBuffer* m_recordingBuffer;
+
+		// Slot table, indexed by component type - holds the first component of each type.
+		Component* m_componentSlots[c_maxComponentTypes];
+		ComponentTypeMask m_componentMask;
 	};
 
 };
\ No newline at end of file
@@ -24,40 +24,65 @@
 
 #include "EntityComponentManager.h"
 
+#include "Core/GameTime.h"
 #include "Game/GameContext.h"
 #include "Game/Messaging/GameMessageHub.h"
 #include "Game/Messaging/GameEventTypes.h"
+#include "Utility/Log.h"
 #include <boost/assert.hpp>
+#include <boost/format.hpp>
+#include <algorithm>
 
 namespace ComponentModel
 {
-	EntityComponentManager::EntityComponentManager(size_t entityPoolSize)
+	const unsigned int EntityComponentManager::c_noParent;
+
+	EntityComponentManager::EntityComponentManager(size_t entityPoolSize, PoolCapacityPolicy entityCapacityPolicy) :
+		m_physicsPhase(nullptr),
+		m_corePhase(nullptr),
+		m_renderPhase(nullptr),
+		m_synchronisePhase(nullptr),
+		m_recording(false),
+		m_recordingPass(0),
+		m_threadBuffer(&EntityComponentManager::KeepCommandBuffer),
+		m_updateScheduling(US_SERIAL),
+		m_workerPool(nullptr),
+		m_scheduledTime(nullptr),
+		m_entities(entityPoolSize),
+		m_transforms(entityPoolSize),
+		m_entityCapacityPolicy(entityCapacityPolicy),
+		m_entityHighWaterMark(0),
+		m_entityAcquireCount(0),
+		m_entityReleaseCount(0),
+		m_lastFrameEntityAcquires(0),
+		m_lastFrameEntityReleases(0),
+		m_lastEntityReleaseQueueDepth(0),
+		m_peakEntityReleaseQueueDepth(0),
+		m_synchroniseCount(0),
+		m_statisticsDumpFormat(SF_CSV),
+		m_statisticsDumpInterval(0)
 	{
-		m_entities.reserve(entityPoolSize);
-		for (size_t i = 0; i < entityPoolSize; ++i)
-		{
-			Entity* newEnt = new Entity();
-			newEnt->SetEntityComponentManager(this);
-			m_entities.push_back(newEnt);
-			m_freeEntities.push_back(newEnt);
-		}
+		m_freeEntities.reserve(entityPoolSize);
+		GrowEntityPool();
 	}
 
 	EntityComponentManager::~EntityComponentManager()
 	{
-		for (auto enIt = m_entities.begin(); enIt != m_entities.end(); ++enIt)
-		{
-			delete *enIt;
-		}
-
-		m_entities.clear();
+		// Entities themselves are destroyed with their storage.
+		m_freeEntities.clear();
 
 		for (auto cpIt = m_componentPools.begin(); cpIt != m_componentPools.end(); ++cpIt)
 		{
-			delete (*cpIt).second;
+			delete *cpIt;
 		}
 
 		m_componentPools.clear();
+
+		for (auto cbIt = m_commandBuffers.begin(); cbIt != m_commandBuffers.end(); ++cbIt)
+		{
+			delete *cbIt;
+		}
+		m_commandBuffers.clear();
 	}
 
 	bool SortComponentPools(ComponentPool* first, ComponentPool* second)
@@ -74,7 +99,7 @@ namespace ComponentModel
 
 		for (auto cpIt = m_componentPools.begin(); cpIt != m_componentPools.end(); ++cpIt)
 		{
-			ComponentPool* cp = (*cpIt).second;
+			ComponentPool* cp = (*cpIt);
 			if (cp->HasCoreUpdate()) m_coreUpdateList.push_back(cp);
 			if (cp->HasPhysicsUpdate()) m_physicsUpdateList.push_back(cp);
 			if (cp->HasRenderUpdate()) m_renderUpdateList.push_back(cp);
@@ -87,43 +112,458 @@ namespace ComponentModel
 		m_physicsUpdateList.sort(SortComponentPools);
 		m_renderUpdateList.sort(SortComponentPools);
 		m_synchroniseList.sort(SortComponentPools);
+
+		BuildUpdateGraph(m_physicsUpdateList, &ComponentPool::DoPhysicsUpdate, m_physicsUpdateGraph, "Physics");
+		BuildUpdateGraph(m_coreUpdateList, &ComponentPool::DoCoreUpdate, m_coreUpdateGraph, "Core");
+	}
+
+	void EntityComponentManager::BuildUpdateGraph(const std::list<ComponentPool*>& updateList, void (ComponentPool::*update)(const GameTime&), TaskGraph& graph, const char* phaseName)
+	{
+		graph.Clear();
+		std::vector<ComponentPool*> pools(updateList.begin(), updateList.end());
+		size_t dependencyCount = 0;
+		for (size_t i = 0; i < pools.size(); ++i)
+		{
+			ComponentPool* cp = pools[i];
+			graph.AddTask([this, cp, update, i]() 
+			{ 
+				SetRecordingSource(i);
+				(cp->*update)(*m_scheduledTime); 
+			});
+
+			// Anything conflicting waits on every earlier conflicting pool, which keeps them in priority order.
+			for (size_t j = 0; j < i; ++j)
+			{
+				if (AccessConflicts(pools[j]->GetReadAccess(), pools[j]->GetWriteAccess(), cp->GetReadAccess(), cp->GetWriteAccess()))
+				{
+					graph.AddDependency(j, i);
+					++dependencyCount;
+				}
+			}
+		}
+
+		LOG(Log::Constants::CHANNEL_COMPONENT_MODEL, Log::Constants::LEVEL_INFO, 
+			(boost::format("%1% update graph: %2% pools, %3% dependencies") % phaseName % pools.size() % dependencyCount).str());
+	}
+
+	void EntityComponentManager::SetUpdateScheduling(UpdateScheduling scheduling, WorkerPool* workerPool)
+	{
+		BOOST_ASSERT(scheduling == US_SERIAL || workerPool != nullptr);
+		m_updateScheduling = scheduling;
+		m_workerPool = scheduling == US_PARALLEL ? workerPool : nullptr;
+
+		// Parallel safe pools split their own updates across the same workers.
+		for (auto cpIt = m_componentPools.begin(); cpIt != m_componentPools.end(); ++cpIt)
+		{
+			(*cpIt)->SetWorkerPool(m_workerPool);
+		}
+	}
+
+	void EntityComponentManager::GrowEntityPool()
+	{
+		size_t firstIndex = m_entities.GetCapacity();
+		BOOST_ASSERT(firstIndex + m_entities.GetChunkSize() - 1 <= EntityHandle::c_maxIndex);
+
+		Entity* chunk = m_entities.AddChunk();
+		TransformStore::Chunk* transforms = m_transforms.AddChunk();
+		for (size_t i = 0; i < m_entities.GetChunkSize(); ++i)
+		{
+			chunk[i].SetEntityComponentManager(this);
+			chunk[i].m_index = static_cast<unsigned int>(firstIndex + i);
+			chunk[i].m_transform = transforms;
+			chunk[i].m_transformSlot = static_cast<unsigned int>(i);
+			m_freeEntities.push_back(chunk + i);
+		}
+	}
+
+	bool EntityComponentManager::ReserveEntities(size_t count)
+	{
+		if (m_freeEntities.size() >= count || m_entityCapacityPolicy != PCP_GROW)
+		{
+			return m_freeEntities.size() >= count;
+		}
+
+		while (m_freeEntities.size() < count)
+		{
+			GrowEntityPool();
+		}
+		LOG(Log::Constants::CHANNEL_COMPONENT_MODEL, Log::Constants::LEVEL_INFO, 
+			(boost::format("Entity pool grew to %1% entities to spawn a batch of %2%.") % m_entities.GetCapacity() % count).str());
+		return true;
+	}
+
+	Entity* EntityComponentManager::Spawn(const Prefab& prefab)
+	{
+		ComponentPool* pools[c_maxComponentTypes];
+		size_t poolCount = ResolvePrefabPools(prefab, pools);
+		return SpawnEntity(pools, poolCount);
+	}
+
+	size_t EntityComponentManager::SpawnBatch(const Prefab& prefab, size_t count, const SpawnInitialiser& initialiser, std::vector<Entity*>* spawned)
+	{
+		ComponentPool* pools[c_maxComponentTypes];
+		size_t poolCount = ResolvePrefabPools(prefab, pools);
+
+		std::vector<Entity*> batch;
+		std::vector<Entity*>& entities = spawned != nullptr ? *spawned : batch;
+		size_t first = entities.size();
+		entities.reserve(first + count);
+
+		// Reserve & take everything for the batch up front (under the one lock, so no other thread can take
+		// what was reserved), so either the whole batch is spawned or none of it is.
+		{
+			boost::unique_lock<boost::mutex> lock(m_structureMutex, boost::defer_lock);
+			if (m_recording)
+			{
+				lock.lock();
+			}
+
+			bool reserved = ReserveEntities(count);
+			for (size_t i = 0; i < poolCount; ++i)
+			{
+				// Prefabs may hold a type more than once, needing a component per entity each time.
+				size_t needed = count;
+				for (size_t j = 0; j < i; ++j)
+				{
+					needed += pools[j] == pools[i] ? count : 0;
+				}
+				reserved = pools[i]->Reserve(needed) && reserved;
+			}
+			if (!reserved)
+			{
+				LOG(Log::Constants::CHANNEL_COMPONENT_MODEL, Log::Constants::LEVEL_WARN, 
+					(boost::format("Pools can't hold a batch of %1% entities, none spawned.") % count).str());
+				return 0;
+			}
+
+			for (size_t i = 0; i < count; ++i)
+			{
+				entities.push_back(AcquirePrefabEntity(pools, poolCount));
+			}
+		}
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			Entity* entity = entities[first + i];
+			RecordCreate(entity);
+			if (initialiser)
+			{
+				initialiser(entity, i);
+			}
+		}
+		return count;
+	}
+
+	size_t EntityComponentManager::ResolvePrefabPools(const Prefab& prefab, ComponentPool** pools)
+	{
+		const std::vector<Prefab::TypeIdGetter>& types = prefab.GetComponentTypes();
+		BOOST_ASSERT(types.size() <= c_maxComponentTypes);
+		for (size_t i = 0; i < types.size(); ++i)
+		{
+			ComponentTypeId typeId = types[i]();
+			BOOST_ASSERT(typeId < m_componentPools.size());
+			pools[i] = m_componentPools[typeId];
+		}
+		return types.size();
+	}
+
+	Entity* EntityComponentManager::SpawnEntity(ComponentPool* const* pools, size_t poolCount)
+	{
+		Entity* entity = nullptr;
+		{
+			boost::unique_lock<boost::mutex> lock(m_structureMutex, boost::defer_lock);
+			if (m_recording)
+			{
+				lock.lock();
+			}
+
+			entity = AcquirePrefabEntity(pools, poolCount);
+		}
+		RecordCreate(entity);
+		return entity;
+	}
+
+	Entity* EntityComponentManager::AcquirePrefabEntity(ComponentPool* const* pools, size_t poolCount)
+	{
+		Entity* entity = AcquireEntity();
+		if (entity != nullptr)
+		{
+			for (size_t i = 0; i < poolCount; ++i)
+			{
+				// As with AddComponent, an exhausted pool just means the component is missing.
+				// The entity is new, so attaching straight away is fine even while recording.
+				if (Component* component = pools[i]->GetFreeComponent())
+				{
+					entity->AddComponent(component);
+				}
+			}
+		}
+		return entity;
 	}
 
 	Entity* EntityComponentManager::GetFreeEntity()
 	{
+		Entity* entity = nullptr;
+		{
+			boost::unique_lock<boost::mutex> lock(m_structureMutex, boost::defer_lock);
+			if (m_recording)
+			{
+				lock.lock();
+			}
+			entity = AcquireEntity();
+		}
+		RecordCreate(entity);
+		return entity;
+	}
+
+	Component* EntityComponentManager::AddComponent(Entity* entity, ComponentTypeId typeId)
+	{
+		BOOST_ASSERT(typeId < m_componentPools.size());
+		Component* component = nullptr;
+		{
+			boost::unique_lock<boost::mutex> lock(m_structureMutex, boost::defer_lock);
+			if (m_recording)
+			{
+				lock.lock();
+			}
+			component = m_componentPools[typeId]->GetFreeComponent();
+		}
+
+		if (component != nullptr)
+		{
+			CommandBuffer* buffer = GetRecordingBuffer();
+			if (buffer == nullptr || entity->m_recordingBuffer == buffer)
+			{
+				entity->AddComponent(component);
+			}
+			else
+			{
+				buffer->Record(CommandBuffer::CT_ADD_COMPONENT, entity, component);
+			}
+		}
+		return component;
+	}
+
+	void EntityComponentManager::RemoveComponent(Entity* entity, Component* component)
+	{
+		if (CommandBuffer* buffer = GetRecordingBuffer())
+		{
+			buffer->Record(CommandBuffer::CT_REMOVE_COMPONENT, entity, component);
+			return;
+		}
+
+		entity->RemoveComponent(component);	
+		m_componentPools[component->GetTypeId()]->ReleaseComponentDeferred(component);
+	}
+
+	Entity* EntityComponentManager::AcquireEntity()
+	{
+		if (m_freeEntities.empty())
+		{
+			switch (m_entityCapacityPolicy)
+			{
+			case PCP_GROW:
+				GrowEntityPool();
+				LOG(Log::Constants::CHANNEL_COMPONENT_MODEL, Log::Constants::LEVEL_INFO, 
+					(boost::format("Entity pool exhausted, grew to %1% entities.") % m_entities.GetCapacity()).str());
+				break;
+			case PCP_FAIL_FAST:
+				LOG(Log::Constants::CHANNEL_COMPONENT_MODEL, Log::Constants::LEVEL_ERROR, 
+					(boost::format("Entity pool exhausted at %1% entities.") % m_entities.GetCapacity()).str());
+				BOOST_ASSERT(m_entityCapacityPolicy != PCP_FAIL_FAST);
+				return nullptr;
+			default:
+				LOG(Log::Constants::CHANNEL_COMPONENT_MODEL, Log::Constants::LEVEL_WARN, 
+					(boost::format("Entity pool exhausted at %1% entities, no entity acquired.") % m_entities.GetCapacity()).str());
+				return nullptr;
+			}
+		}
+
 		Entity* retEnt = m_freeEntities.back();
 		m_freeEntities.pop_back();
+		++m_entityAcquireCount;
 		retEnt->SetEnabled(true);
-		retEnt->SetName("");
 		retEnt->SetAlive(true);
+
+		m_entityHighWaterMark = std::max(m_entityHighWaterMark, m_entities.GetCapacity() - m_freeEntities.size());
 		return retEnt;
 	}
 
 	void EntityComponentManager::ReleaseEntity(Entity* e)
 	{
-		BOOST_ASSERT(m_deferredFreeEntities.count(e) == 0);
-		m_deferredFreeEntities.insert(e);
+		// An entity can only be released once (until it's been reacquired)
+		BOOST_ASSERT(e->GetAlive());
 		e->SetAlive(false);
+
+		if (CommandBuffer* buffer = GetRecordingBuffer())
+		{
+			buffer->Record(CommandBuffer::CT_DESTROY_ENTITY, e);
+			return;
+		}
+		DestroyEntity(e);
+	}
+
+	void EntityComponentManager::DestroyEntity(Entity* e)
+	{
+		m_deferredFreeEntities.push_back(e->m_index);
+		++m_entityReleaseCount;
 		// Notify anyone who's listening that this dude is dead.
 		m_gameContext->GetMessageHub().RaiseGameEvent(GameEventTypes::GE_ENTITY_DESTROYED, e);
 	}
 
+	CommandBuffer* EntityComponentManager::GetThreadBuffer()
+	{
+		CommandBuffer* buffer = m_threadBuffer.get();
+		if (buffer == nullptr)
+		{
+			// First change from this thread.
+			buffer = new CommandBuffer(boost::this_thread::get_id());
+			m_threadBuffer.reset(buffer);
+			boost::lock_guard<boost::mutex> lock(m_structureMutex);
+			m_commandBuffers.push_back(buffer);
+		}
+		return buffer;
+	}
+
+	CommandBuffer* EntityComponentManager::GetRecordingBuffer()
+	{
+		if (!m_recording)
+		{
+			return nullptr;
+		}
+
+		// Chunks of a parallel update have no source of their own, so anything they recorded would be
+		// applied in no particular order (see Component::IsParallelSafe).
+		CommandBuffer* buffer = GetThreadBuffer();
+		BOOST_ASSERT(!buffer->IsSuspended());
+		return buffer;
+	}
+
+	void EntityComponentManager::SetThreadRecordingSuspended(bool suspended)
+	{
+		if (m_recording)
+		{
+			GetThreadBuffer()->SetSuspended(suspended);
+		}
+	}
+
+	void EntityComponentManager::BeginRecording()
+	{
+		m_recording = true;
+		++m_recordingPass;
+	}
+
+	void EntityComponentManager::SetRecordingSource(size_t poolOrder)
+	{
+		// Passes run in order, and pools within a pass in priority order.
+		GetThreadBuffer()->SetSource((m_recordingPass << 8) | static_cast<unsigned int>(poolOrder));
+	}
+
+	void EntityComponentManager::RecordCreate(Entity* entity)
+	{
+		CommandBuffer* buffer = entity != nullptr ? GetRecordingBuffer() : nullptr;
+		if (buffer != nullptr)
+		{
+			entity->m_recordingBuffer = buffer;
+			buffer->Record(CommandBuffer::CT_CREATE_ENTITY, entity);
+		}
+	}
+
+	bool SortCommands(const CommandBuffer::Command& first, const CommandBuffer::Command& second)
+	{
+		return first.m_source < second.m_source;
+	}
+
+	void EntityComponentManager::ApplyCommandBuffers()
+	{
+		// Gather the commands up, and put them in source order. All commands from one source come
+		// from the same buffer, so a stable sort keeps them in the order they were recorded.
+		m_recordedCommands.clear();
+		for (auto cbIt = m_commandBuffers.begin(); cbIt != m_commandBuffers.end(); ++cbIt)
+		{
+			const std::vector<CommandBuffer::Command>& commands = (*cbIt)->GetCommands();
+			m_recordedCommands.insert(m_recordedCommands.end(), commands.begin(), commands.end());
+			(*cbIt)->Clear();
+		}
+		std::stable_sort(m_recordedCommands.begin(), m_recordedCommands.end(), SortCommands);
+		m_recordingPass = 0;
+
+		for (auto cmdIt = m_recordedCommands.begin(); cmdIt != m_recordedCommands.end(); ++cmdIt)
+		{
+			Entity* e = cmdIt->m_entity;
+			switch (cmdIt->m_type)
+			{
+			case CommandBuffer::CT_CREATE_ENTITY:
+				e->m_recordingBuffer = nullptr;
+				break;
+			case CommandBuffer::CT_DESTROY_ENTITY:
+				DestroyEntity(e);
+				break;
+			case CommandBuffer::CT_ADD_COMPONENT:
+				e->AddComponent(cmdIt->m_component);
+				break;
+			case CommandBuffer::CT_REMOVE_COMPONENT:
+				// The same component may have been removed more than once.
+				if (std::find(e->m_components.begin(), e->m_components.end(), cmdIt->m_component) != e->m_components.end())
+				{
+					RemoveComponent(e, cmdIt->m_component);
+				}
+				break;
+			}
+		}
+		m_recordedCommands.clear();
+	}
+
 	Entity* EntityComponentManager::FindEntityByName(const std::string& name)
 	{
-		// Highly inefficient - we search all entities, including inactive ones (though their names will be
-		// unbound). 
-		auto entIt = std::find_if(m_entities.begin(), m_entities.end(), [name](Entity* entity){return entity->GetName() == name;});
-		return entIt != m_entities.end() ? *entIt : nullptr;
+		// Don't intern names we're only searching for - if it's not in the table, no one has it.
+		NameId nameId;
+		return m_names.TryGetId(name, nameId) ? FindEntityByName(nameId) : nullptr;
+	}
+
+	Entity* EntityComponentManager::FindEntityByName(NameId name)
+	{
+		if (name == c_noName || name >= m_nameIndex.size() || m_nameIndex[name].empty())
+		{
+			return nullptr;
+		}
+		return m_nameIndex[name].front();
+	}
+
+	const std::vector<Entity*>& EntityComponentManager::FindEntitiesByTag(const std::string& tag)
+	{
+		NameId tagId;
+		return m_names.TryGetId(tag, tagId) ? FindEntitiesByTag(tagId) : m_noEntities;
+	}
+
+	const std::vector<Entity*>& EntityComponentManager::FindEntitiesByTag(NameId tag)
+	{
+		return tag < m_tagIndex.size() ? m_tagIndex[tag] : m_noEntities;
 	}
 
 	void EntityComponentManager::ClearAll(const std::set<std::string>* namesToExclude)
 	{
-		for (auto entIt = m_entities.begin(); entIt != m_entities.end(); ++entIt)
+		// Resolve the exclusions to ids once, so the entity walk only compares integers.
+		std::vector<NameId> excludedIds;
+		if (namesToExclude != nullptr)
 		{
-			Entity* entity = (*entIt);
+			for (auto nameIt = namesToExclude->begin(); nameIt != namesToExclude->end(); ++nameIt)
+			{
+				NameId nameId;
+				if (m_names.TryGetId(*nameIt, nameId))
+				{
+					excludedIds.push_back(nameId);
+				}
+			}
+		}
+
+		for (size_t i = 0; i < m_entities.GetCapacity(); ++i)
+		{
+			Entity* entity = &m_entities[i];
 			if (entity->GetAlive())
 			{
-				if (namesToExclude == nullptr || entity->GetName().empty() || namesToExclude->count(entity->GetName()) == 0)
+				NameId nameId = entity->GetNameId();
+				if (nameId == c_noName || std::find(excludedIds.begin(), excludedIds.end(), nameId) == excludedIds.end())
 				{
 					entity->Destroy();
 				}
@@ -132,31 +572,559 @@ namespace ComponentModel
 		SynchroniseRenderData();
 	}
 
+	void EntityComponentManager::ResetWorld()
+	{
+		BOOST_ASSERT(!m_recording);
+
+		// Anything recorded goes through as usual (so any destruction already asked for is still announced,
+		// & delivered while the entities are still around).
+		ApplyCommandBuffers();
+		m_gameContext->GetMessageHub().Pump();
+
+		// Everything bar the persistent entities goes - quietly, as everything's going. Entities already 
+		// pending release were announced when they were destroyed, so just go along with the rest.
+		std::vector<Entity*> released;
+		released.reserve(m_entities.GetCapacity() - m_freeEntities.size());
+		for (auto enIt = m_deferredFreeEntities.begin(); enIt != m_deferredFreeEntities.end(); ++enIt)
+		{
+			released.push_back(&m_entities[*enIt]);
+		}
+		m_deferredFreeEntities.clear();
+
+		for (size_t i = 0; i < m_entities.GetCapacity(); ++i)
+		{
+			Entity* entity = &m_entities[i];
+			if (entity->GetAlive() && !entity->GetPersistent())
+			{
+				entity->SetAlive(false);
+				released.push_back(entity);
+				++m_entityReleaseCount;
+			}
+		}
+
+		// Components are released by their pools in bulk, rather than removed one at a time.
+		for (auto enIt = released.begin(); enIt != released.end(); ++enIt)
+		{
+			(*enIt)->DetachAllComponents();
+		}
+
+		size_t componentCount = 0;
+		for (auto cpIt = m_synchroniseList.begin(); cpIt != m_synchroniseList.end(); ++cpIt)
+		{
+			componentCount += (*cpIt)->ReleaseForReset();
+		}
+
+		// Prune the name & tag indices in one pass each, rather than searching them for every entity.
+		PruneIndex(m_nameIndex);
+		PruneIndex(m_tagIndex);
+		for (auto enIt = released.begin(); enIt != released.end(); ++enIt)
+		{
+			Entity* entity = (*enIt);
+			entity->m_nameId = c_noName;
+			entity->m_tags.clear();
+			RecycleEntity(entity);
+		}
+
+		LOG(Log::Constants::CHANNEL_COMPONENT_MODEL, Log::Constants::LEVEL_INFO, 
+			(boost::format("World reset: released %1% entities & %2% components.") % released.size() % componentCount).str());
+
+		SynchroniseRenderData();
+	}
+
+	bool EntityComponentManager::Snapshot(SnapshotBuffer& buffer)
+	{
+		BOOST_ASSERT(!m_recording);
+
+		// Synchronise first, so there's nothing pending in the command buffers or release queues to save.
+		SynchroniseRenderData();
+
+		buffer.clear();
+		SnapshotWriter writer(buffer);
+		writer.Write(c_snapshotVersion);
+		writer.Write(static_cast<unsigned int>(m_componentPools.size()));
+
+		unsigned int entityCount = 0;
+		for (size_t i = 0; i < m_entities.GetCapacity(); ++i)
+		{
+			entityCount += (m_entities[i].GetAlive() && !m_entities[i].GetPersistent()) ? 1 : 0;
+		}
+		writer.Write(entityCount);
+		for (size_t i = 0; i < m_entities.GetCapacity(); ++i)
+		{
+			const Entity& entity = m_entities[i];
+			if (!entity.GetAlive() || entity.GetPersistent())
+			{
+				continue;
+			}
+
+			EntityRecord record;
+			record.m_index = entity.m_index;
+			record.m_generation = entity.m_generation;
+			record.m_enabled = entity.m_enabled ? 1 : 0;
+			record.m_nameId = entity.m_nameId;
+			record.m_tagCount = static_cast<unsigned int>(entity.m_tags.size());
+			record.m_parentIndex = entity.m_parent != nullptr ? entity.m_parent->m_index : c_noParent;
+			entity.m_transform->Save(entity.m_transformSlot, record.m_transform);
+			writer.Write(record);
+			if (!entity.m_tags.empty())
+			{
+				writer.Write(&entity.m_tags[0], entity.m_tags.size() * sizeof(NameId));
+			}
+		}
+
+		std::vector<unsigned int> freeEntities;
+		freeEntities.reserve(m_freeEntities.size());
+		for (auto enIt = m_freeEntities.begin(); enIt != m_freeEntities.end(); ++enIt)
+		{
+			freeEntities.push_back((*enIt)->m_index);
+		}
+		writer.WriteArray(freeEntities);
+
+		for (auto cpIt = m_componentPools.begin(); cpIt != m_componentPools.end(); ++cpIt)
+		{
+			if (!(*cpIt)->SaveSnapshot(writer))
+			{
+				buffer.clear();
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool EntityComponentManager::Restore(const SnapshotBuffer& buffer)
+	{
+		BOOST_ASSERT(!m_recording);
+
+		SnapshotReader reader(buffer);
+		if (reader.Read<unsigned int>() != c_snapshotVersion || reader.Read<unsigned int>() != m_componentPools.size())
+		{
+			LOG(Log::Constants::CHANNEL_COMPONENT_MODEL, Log::Constants::LEVEL_ERROR, "Snapshot doesn't match this entity manager, not restored.");
+			return false;
+		}
+
+		// Check the entities will fit before tearing anything down.
+		{
+			SnapshotReader check = reader.Fork();
+			unsigned int entityCount = check.Read<unsigned int>();
+			for (unsigned int i = 0; i < entityCount && check.IsValid(); ++i)
+			{
+				EntityRecord record;
+				check.Read(record);
+				if (record.m_index >= m_entities.GetCapacity() || 
+					(m_entities[record.m_index].GetAlive() && m_entities[record.m_index].GetPersistent()))
+				{
+					LOG(Log::Constants::CHANNEL_COMPONENT_MODEL, Log::Constants::LEVEL_ERROR, 
+						(boost::format("Snapshot entity %1% is out of range or now persistent, not restored.") % record.m_index).str());
+					return false;
+				}
+				check.Skip(record.m_tagCount * sizeof(NameId));
+			}
+			if (!check.IsValid())
+			{
+				LOG(Log::Constants::CHANNEL_COMPONENT_MODEL, Log::Constants::LEVEL_ERROR, "Snapshot is truncated, not restored.");
+				return false;
+			}
+		}
+
+		ResetWorld();
+
+		unsigned int entityCount = reader.Read<unsigned int>();
+		std::vector< std::pair<Entity*, unsigned int> > parents;
+		for (unsigned int i = 0; i < entityCount; ++i)
+		{
+			EntityRecord record;
+			reader.Read(record);
+			Entity* entity = &m_entities[record.m_index];
+			if (record.m_parentIndex != c_noParent)
+			{
+				parents.push_back(std::make_pair(entity, record.m_parentIndex));
+			}
+			entity->SetAlive(true);
+			entity->SetEnabled(record.m_enabled != 0);
+			entity->m_generation = record.m_generation;
+			entity->m_transform->Load(entity->m_transformSlot, record.m_transform);
+			SetEntityName(entity, record.m_nameId);
+			for (unsigned int tag = 0; tag < record.m_tagCount; ++tag)
+			{
+				AddEntityTag(entity, reader.Read<NameId>());
+			}
+		}
+		m_entityAcquireCount += entityCount;
+
+		// Parents may come after their children, so the hierarchy goes back together once they're all in.
+		for (auto parIt = parents.begin(); parIt != parents.end(); ++parIt)
+		{
+			if (parIt->second < m_entities.GetCapacity() && m_entities[parIt->second].GetAlive())
+			{
+				parIt->first->SetParent(&m_entities[parIt->second]);
+			}
+		}
+
+		// As with the pools' free slots - the saved order on top (bar any entities alive now), anything else underneath.
+		std::vector<unsigned int> savedFreeEntities;
+		reader.ReadArray(savedFreeEntities);
+		std::vector<bool> isSavedFree(m_entities.GetCapacity(), false);
+		for (auto idxIt = savedFreeEntities.begin(); idxIt != savedFreeEntities.end(); ++idxIt)
+		{
+			if (*idxIt < m_entities.GetCapacity() && !m_entities[*idxIt].GetAlive())
+			{
+				isSavedFree[*idxIt] = true;
+			}
+		}
+		m_freeEntities.clear();
+		for (size_t i = 0; i < m_entities.GetCapacity(); ++i)
+		{
+			if (!isSavedFree[i] && !m_entities[i].GetAlive())
+			{
+				m_freeEntities.push_back(&m_entities[i]);
+			}
+		}
+		for (auto idxIt = savedFreeEntities.begin(); idxIt != savedFreeEntities.end(); ++idxIt)
+		{
+			if (*idxIt < m_entities.GetCapacity() && isSavedFree[*idxIt])
+			{
+				m_freeEntities.push_back(&m_entities[*idxIt]);
+				isSavedFree[*idxIt] = false;
+			}
+		}
+		m_entityHighWaterMark = std::max(m_entityHighWaterMark, m_entities.GetCapacity() - m_freeEntities.size());
+
+		bool isValid = reader.IsValid();
+		for (auto cpIt = m_componentPools.begin(); cpIt != m_componentPools.end() && isValid; ++cpIt)
+		{
+			isValid = (*cpIt)->LoadSnapshot(reader, m_entities);
+		}
+		if (!isValid || !reader.IsAtEnd())
+		{
+			// Half a world is worse than none.
+			LOG(Log::Constants::CHANNEL_COMPONENT_MODEL, Log::Constants::LEVEL_ERROR, "Snapshot components couldn't be restored, world reset.");
+			ResetWorld();
+			return false;
+		}
+
+		// Everything's back in place, so components can now find each other, resubscribe etc.
+		for (auto cpIt = m_synchroniseList.begin(); cpIt != m_synchroniseList.end(); ++cpIt)
+		{
+			(*cpIt)->NotifyRestored();
+		}
+		return true;
+	}
+
+	void EntityComponentManager::PruneIndex(std::vector< std::vector<Entity*> >& index)
+	{
+		for (auto listIt = index.begin(); listIt != index.end(); ++listIt)
+		{
+			std::vector<Entity*>& entities = (*listIt);
+			size_t kept = 0;
+			for (size_t i = 0; i < entities.size(); ++i)
+			{
+				if (entities[i]->GetAlive())
+				{
+					entities[kept++] = entities[i];
+				}
+			}
+			entities.resize(kept);
+		}
+	}
+
+	std::vector<Entity*>& EntityComponentManager::GetIndexList(std::vector< std::vector<Entity*> >& index, NameId id)
+	{
+		if (id >= index.size())
+		{
+			index.resize(m_names.GetCount());
+		}
+		return index[id];
+	}
+
+	void EntityComponentManager::SetEntityName(Entity* entity, NameId name)
+	{
+		if (entity->m_nameId == name)
+		{
+			return;
+		}
+
+		if (entity->m_nameId != c_noName)
+		{
+			std::vector<Entity*>& oldList = m_nameIndex[entity->m_nameId];
+			oldList.erase(std::find(oldList.begin(), oldList.end(), entity));
+		}
+
+		entity->m_nameId = name;
+
+		if (name != c_noName)
+		{
+			GetIndexList(m_nameIndex, name).push_back(entity);
+		}
+	}
+
+	void EntityComponentManager::AddEntityTag(Entity* entity, NameId tag)
+	{
+		if (tag == c_noName || entity->HasTag(tag))
+		{
+			return;
+		}
+		entity->m_tags.push_back(tag);
+		GetIndexList(m_tagIndex, tag).push_back(entity);
+	}
+
+	void EntityComponentManager::RemoveEntityTag(Entity* entity, NameId tag)
+	{
+		auto tagIt = std::find(entity->m_tags.begin(), entity->m_tags.end(), tag);
+		if (tagIt == entity->m_tags.end())
+		{
+			return;
+		}
+		entity->m_tags.erase(tagIt);
+		std::vector<Entity*>& tagList = m_tagIndex[tag];
+		tagList.erase(std::find(tagList.begin(), tagList.end(), entity));
+	}
+
+	void EntityComponentManager::ClearEntityNameAndTags(Entity* entity)
+	{
+		SetEntityName(entity, c_noName);
+		while (!entity->m_tags.empty())
+		{
+			RemoveEntityTag(entity, entity->m_tags.back());
+		}
+	}
+
+	void EntityComponentManager::LogPoolUsage() const
+	{
+		LOG(Log::Constants::CHANNEL_COMPONENT_MODEL, Log::Constants::LEVEL_INFO, 
+			(boost::format("Entities: capacity %1%, high water mark %2%, policy %3%") 
+				% m_entities.GetCapacity() % m_entityHighWaterMark % GetPoolCapacityPolicyName(m_entityCapacityPolicy)).str());
+
+		for (auto cpIt = m_componentPools.begin(); cpIt != m_componentPools.end(); ++cpIt)
+		{
+			const ComponentPool* cp = (*cpIt);
+			LOG(Log::Constants::CHANNEL_COMPONENT_MODEL, Log::Constants::LEVEL_INFO, 
+				(boost::format("%1%: capacity %2%, high water mark %3%, policy %4%, %5% bytes reserved") 
+					% cp->GetTypeName() % cp->GetCapacity() % cp->GetHighWaterMark() % GetPoolCapacityPolicyName(cp->GetCapacityPolicy()) % cp->GetReservedBytes()).str());
+		}
+	}
+
+	PoolStatistics EntityComponentManager::GetEntityPoolStatistics() const
+	{
+		PoolStatistics statistics;
+		statistics.m_typeName = "Entity";
+		statistics.m_capacityPolicy = m_entityCapacityPolicy;
+		statistics.m_capacity = m_entities.GetCapacity();
+		statistics.m_liveCount = m_entities.GetCapacity() - m_freeEntities.size();
+		statistics.m_highWaterMark = m_entityHighWaterMark;
+		statistics.m_acquiresPerFrame = m_lastFrameEntityAcquires;
+		statistics.m_releasesPerFrame = m_lastFrameEntityReleases;
+		statistics.m_releaseQueueDepth = m_lastEntityReleaseQueueDepth;
+		statistics.m_peakReleaseQueueDepth = m_peakEntityReleaseQueueDepth;
+		statistics.m_bytesPerItem = sizeof(Entity);
+		statistics.m_reservedBytes = m_entities.GetCapacity() * sizeof(Entity) +
+			m_freeEntities.capacity() * sizeof(Entity*) +
+			m_deferredFreeEntities.capacity() * sizeof(unsigned int) +
+			m_transforms.GetReservedBytes();
+		return statistics;
+	}
+
+	void EntityComponentManager::GetPoolStatistics(std::vector<PoolStatistics>& statistics) const
+	{
+		statistics.push_back(GetEntityPoolStatistics());
+		for (auto cpIt = m_componentPools.begin(); cpIt != m_componentPools.end(); ++cpIt)
+		{
+			statistics.push_back((*cpIt)->GetStatistics());
+		}
+	}
+
+	void EntityComponentManager::WritePoolStatisticsHeader(std::ostream& stream, StatisticsFormat format)
+	{
+		if (format == SF_CSV)
+		{
+			stream << "frame,type,policy,capacity,live,high_water_mark,acquires_per_frame,releases_per_frame,"
+				"release_queue_depth,peak_release_queue_depth,bytes_per_item,reserved_bytes" << std::endl;
+		}
+	}
+
+	void EntityComponentManager::WritePoolStatistics(std::ostream& stream, StatisticsFormat format) const
+	{
+		std::vector<PoolStatistics> statistics;
+		GetPoolStatistics(statistics);
+
+		if (format == SF_JSON)
+		{
+			stream << "{\"frame\":" << m_synchroniseCount << ",\"pools\":[";
+		}
+
+		for (auto stIt = statistics.begin(); stIt != statistics.end(); ++stIt)
+		{
+			const PoolStatistics& s = (*stIt);
+			if (format == SF_CSV)
+			{
+				stream << m_synchroniseCount << ',' << s.m_typeName << ',' << GetPoolCapacityPolicyName(s.m_capacityPolicy) << ',' 
+					<< s.m_capacity << ',' << s.m_liveCount << ',' << s.m_highWaterMark << ',' 
+					<< s.m_acquiresPerFrame << ',' << s.m_releasesPerFrame << ',' 
+					<< s.m_releaseQueueDepth << ',' << s.m_peakReleaseQueueDepth << ',' 
+					<< s.m_bytesPerItem << ',' << s.m_reservedBytes << '\n';
+			}
+			else
+			{
+				stream << (stIt == statistics.begin() ? "" : ",")
+					<< "{\"type\":\"" << s.m_typeName << "\",\"policy\":\"" << GetPoolCapacityPolicyName(s.m_capacityPolicy) << "\""
+					<< ",\"capacity\":" << s.m_capacity << ",\"live\":" << s.m_liveCount << ",\"highWaterMark\":" << s.m_highWaterMark
+					<< ",\"acquiresPerFrame\":" << s.m_acquiresPerFrame << ",\"releasesPerFrame\":" << s.m_releasesPerFrame
+					<< ",\"releaseQueueDepth\":" << s.m_releaseQueueDepth << ",\"peakReleaseQueueDepth\":" << s.m_peakReleaseQueueDepth
+					<< ",\"bytesPerItem\":" << s.m_bytesPerItem << ",\"reservedBytes\":" << s.m_reservedBytes << "}";
+			}
+		}
+
+		if (format == SF_JSON)
+		{
+			stream << "]}\n";
+		}
+		stream.flush();
+	}
+
+	bool EntityComponentManager::StartPoolStatisticsDump(const std::string& fileName, StatisticsFormat format, unsigned int intervalFrames)
+	{
+		StopPoolStatisticsDump();
+
+		m_statisticsDump.open(fileName.c_str(), std::ios::out | std::ios::trunc);
+		if (!m_statisticsDump.is_open())
+		{
+			LOG(Log::Constants::CHANNEL_COMPONENT_MODEL, Log::Constants::LEVEL_WARN, 
+				(boost::format("Couldn't open %1% to dump pool statistics.") % fileName).str());
+			return false;
+		}
+
+		WritePoolStatisticsHeader(m_statisticsDump, format);
+		m_statisticsDumpFormat = format;
+		m_statisticsDumpInterval = std::max(intervalFrames, 1u);
+		return true;
+	}
+
+	void EntityComponentManager::StopPoolStatisticsDump()
+	{
+		if (m_statisticsDump.is_open())
+		{
+			m_statisticsDump.close();
+		}
+		m_statisticsDumpInterval = 0;
+	}
+
 	void EntityComponentManager::DoReleaseEntity(Entity* e)
 	{
 		e->RemoveAllComponents(this);
-		e->SetName("");
+		ClearEntityNameAndTags(e);
+		RecycleEntity(e);
+	}
+
+	void EntityComponentManager::RecycleEntity(Entity* e)
+	{
+		e->DetachFromHierarchy();
+		e->m_transform->Reset(e->m_transformSlot);
+		e->m_persistent = false;
+
+		// Invalidate all outstanding handles, and drop any subscriptions to events about this entity
+		// (they'd otherwise be inherited by the next user of the entity).
+		e->m_generation = EntityHandle::NextGeneration(e->m_generation);
+		m_gameContext->GetMessageHub().UnsubscribeAllGameEvents(e);
+
 		m_freeEntities.push_back(e);
 	}
 
 	void EntityComponentManager::PhysicsUpdate(const GameTime& time)
 	{
-		for (auto cpIt = m_physicsUpdateList.begin(); cpIt != m_physicsUpdateList.end(); ++cpIt)
+		BeginRecording();
+		if (m_updateScheduling == US_PARALLEL)
 		{
-			(*cpIt)->DoPhysicsUpdate(time);
+			m_scheduledTime = &time;
+			m_workerPool->Run(m_physicsUpdateGraph);
+			m_scheduledTime = nullptr;
 		}
+		else if (m_physicsPhase)
+		{
+			m_physicsPhase(*this, time);
+		}
+		else
+		{
+			size_t poolOrder = 0;
+			for (auto cpIt = m_physicsUpdateList.begin(); cpIt != m_physicsUpdateList.end(); ++cpIt, ++poolOrder)
+			{
+				SetRecordingSource(poolOrder);
+				(*cpIt)->DoPhysicsUpdate(time);
+			}
+		}
+		m_recording = false;
 	}
 
 	void EntityComponentManager::CoreUpdate(const GameTime& time)
 	{
-		for (auto cpIt = m_coreUpdateList.begin(); cpIt != m_coreUpdateList.end(); ++cpIt)
+		BeginRecording();
+		if (m_updateScheduling == US_PARALLEL)
 		{
-			(*cpIt)->DoCoreUpdate(time);
+			m_scheduledTime = &time;
+			m_workerPool->Run(m_coreUpdateGraph);
+			m_scheduledTime = nullptr;
+		}
+		else if (m_corePhase)
+		{
+			m_corePhase(*this, time);
+		}
+		else
+		{
+			size_t poolOrder = 0;
+			for (auto cpIt = m_coreUpdateList.begin(); cpIt != m_coreUpdateList.end(); ++cpIt, ++poolOrder)
+			{
+				SetRecordingSource(poolOrder);
+				(*cpIt)->DoCoreUpdate(time);
+			}
+		}
+		m_recording = false;
+
+		// Everything's pushed its keyframes - bring the keyframed transforms up to date in one go, then
+		// the world transforms of everything which has moved.
+		m_transforms.Interpolate(time.GetPhysicsInterpolation());
+		UpdateWorldTransforms();
+	}
+
+	void EntityComponentManager::UpdateWorldTransforms()
+	{
+		// Seed with the top of each dirty subtree - dirty entities with no dirty ancestors (anything
+		// below them is reached from them).
+		m_dirtyTransforms.clear();
+		m_transformQueue.clear();
+		m_transforms.CollectDirty(m_dirtyTransforms);
+		for (auto idxIt = m_dirtyTransforms.begin(); idxIt != m_dirtyTransforms.end(); ++idxIt)
+		{
+			Entity* entity = &m_entities[*idxIt];
+			if (!entity->GetAlive())
+			{
+				// Free entities are reset, not moved - nothing to do until they're used again.
+				entity->m_transform->ClearDirty(entity->m_transformSlot);
+				continue;
+			}
+
+			if (entity->m_parent == nullptr || !entity->m_parent->IsTransformDirty())
+			{
+				m_transformQueue.push_back(entity);
+			}
+		}
+
+		// Breadth first, so parents are always cached before their children.
+		for (size_t i = 0; i < m_transformQueue.size(); ++i)
+		{
+			Entity* entity = m_transformQueue[i];
+			const Entity* parent = entity->m_parent;
+			entity->m_transform->UpdateWorldTransform(entity->m_transformSlot, 
+				parent != nullptr ? &parent->m_transform->GetWorldTransform(parent->m_transformSlot) : nullptr);
+			m_transformQueue.insert(m_transformQueue.end(), entity->m_children.begin(), entity->m_children.end());
 		}
 	}
 
 	void EntityComponentManager::RenderUpdate(const GameTime& time)
 	{
+		if (m_renderPhase)
+		{
+			m_renderPhase(*this, time);
+			return;
+		}
+
 		for (auto cpIt = m_renderUpdateList.begin(); cpIt != m_renderUpdateList.end(); ++cpIt)
 		{
 			(*cpIt)->DoRenderUpdate(time);
@@ -165,17 +1133,43 @@ namespace ComponentModel
 
 	void EntityComponentManager::SynchroniseRenderData()
 	{
+		// Apply everything recorded during the updates (which may release more entities), and deliver
+		// anything queued about the entities before they're recycled.
+		ApplyCommandBuffers();
+		m_gameContext->GetMessageHub().Pump();
+
+		// Close off this frame's entity churn
+		m_lastFrameEntityAcquires = m_entityAcquireCount;
+		m_lastFrameEntityReleases = m_entityReleaseCount;
+		m_lastEntityReleaseQueueDepth = m_deferredFreeEntities.size();
+		m_peakEntityReleaseQueueDepth = std::max(m_peakEntityReleaseQueueDepth, m_lastEntityReleaseQueueDepth);
+		m_entityAcquireCount = 0;
+		m_entityReleaseCount = 0;
+
 		// Clear pending release entities
 		for (auto enIt = m_deferredFreeEntities.begin(); enIt != m_deferredFreeEntities.end(); ++enIt)
 		{
-			DoReleaseEntity(*enIt);
+			DoReleaseEntity(&m_entities[*enIt]);
 		}
 		m_deferredFreeEntities.clear();
 
 		// Let component pools sync.
-		for (auto cpIt = m_synchroniseList.begin(); cpIt != m_synchroniseList.end(); ++cpIt)
+		if (m_synchronisePhase)
+		{
+			m_synchronisePhase(*this);
+		}
+		else
+		{
+			for (auto cpIt = m_synchroniseList.begin(); cpIt != m_synchroniseList.end(); ++cpIt)
+			{
+				(*cpIt)->DoSynchroniseRenderData();
+			}
+		}
+
+		++m_synchroniseCount;
+		if (m_statisticsDumpInterval > 0 && m_synchroniseCount % m_statisticsDumpInterval == 0)
 		{
-			(*cpIt)->DoSynchroniseRenderData();
+			WritePoolStatistics(m_statisticsDump, m_statisticsDumpFormat);
 		}
 	}
 };
\ No newline at end of file
@@ -25,22 +25,40 @@
 #pragma once
 
 class GameContext;
+class GameTime;
 
 // STL
-#include <map>
 #include <vector>
 #include <string>
 #include <list>
 #include <set>
+#include <ostream>
+#include <fstream>
 
 // Boost
 #include <boost/noncopyable.hpp>
+#include <boost/assert.hpp>
+#include <boost/function.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
 
 // Component model
+#include "PoolStorage.h"
+#include "PoolStatistics.h"
+#include "ComponentTypeIndex.h"
+#include "EntityHandle.h"
+#include "NameTable.h"
+#include "TransformStore.h"
+#include "Prefab.h"
+#include "CommandBuffer.h"
 #include "ComponentPool.h"
+#include "View.h"
 #include "Entity.h"
 #include "Component.h"
 
+// Scheduling
+#include "Core/WorkerPool.h"
+
 namespace ComponentModel
 {
 	/** 
@@ -49,65 +67,174 @@ namespace ComponentModel
 	 * Heart of the entity component model, this class holds all the entities and all the component pools.
 	 *
 	 * It drives all the updates, and provides the interface for releasing entities once done with them.
+	 *
+	 * The physics & core updates may be scheduled in parallel: each phase is a graph of pools,
+	 * where a pool waits for every higher priority pool whose declared data access (see DataAccess)
+	 * conflicts with its own, and all other pools are free to update concurrently.
+	 *
+	 * While those updates run, structural changes are recorded in per-thread command buffers and
+	 * applied (in pool priority order) at the start of the next synchronise. Entities & components are
+	 * still handed out immediately, and attaching components to an entity created by the same thread
+	 * is immediate - so anything just created can be set up straight away. Outside the updates every
+	 * change applies immediately, as before.
 	 */
 	class EntityComponentManager : public boost::noncopyable
 	{
 	public:
-		EntityComponentManager(size_t entityPoolSize);
+		friend class Entity; // Entities keep the name & tag index up to date.
+		template <class Registrations> friend class ComponentRegistry; // Registries create the pools & install their update phases.
+		friend class ComponentPool; // Pools suspend recording while they run parallel chunks.
+
+		/// How the physics & core updates are run.
+		enum UpdateScheduling
+		{
+			US_SERIAL,		///< Every pool updates in turn, in priority order, on the calling thread.
+			US_PARALLEL,	///< Pools without conflicting data access update concurrently on a worker pool.
+		};
+
+		/// Sets up an entity spawned from a prefab (given its index in the batch).
+		typedef boost::function<void (Entity* entity, size_t index)> SpawnInitialiser;
+	public:
+		/// Creates the manager with an entity pool of the initial size given; the capacity
+		/// policy decides what happens when more entities than that are requested.
+		EntityComponentManager(size_t entityPoolSize, PoolCapacityPolicy entityCapacityPolicy = PCP_GROW);
 		~EntityComponentManager();
 
 		void SetGameContext(const GameContext* context) { m_gameContext = context; }
 
 		/// Adds a component type which can be used, pre-allocs the pool to the 
 		/// specified size, and sets it to update with the specified priorty (lower = earlier)
-		template <class T> void AddComponentType(size_t poolSize, int updatePriority)
+		/// The capacity policy decides what happens if the pool runs out.
+		///
+		/// Registering the type assigns its ComponentTypeIndex (in registration order).
+		template <class T> void AddComponentType(size_t poolSize, int updatePriority, PoolCapacityPolicy capacityPolicy = PCP_GROW)
 		{
-			m_componentPools[typeid(T).hash_code()] = new TypedComponentPool<T>(poolSize, updatePriority, *m_gameContext);
+			BOOST_ASSERT(!ComponentTypeIndex<T>::IsRegistered());
+			BOOST_ASSERT(m_componentPools.size() < c_maxComponentTypes);
+			ComponentTypeId typeId = static_cast<ComponentTypeId>(m_componentPools.size());
+			m_componentPools.push_back(new TypedComponentPool<T>(typeId, poolSize, updatePriority, capacityPolicy, *m_gameContext));
+			m_componentPools.back()->SetWorkerPool(m_workerPool);
 		}
 
 		/// Adds a component of type to the entity in question and returns you a pointer to the 
 		/// newly acquired component. Note that the component will not have had 'initialise' 
 		/// called, but you can setup data on it at this stage.
+		/// Returns nullptr if the pool for T is exhausted and its policy doesn't allow growth.
 		template <class T> T* AddComponent(Entity* entity)
 		{
 			// Get the component - no need to do a dynamic cast, as the lookup should handle this.
 			// Note that this could cause badness if the "T" does not exist - good thing I'm the 
 			// only one writing code for this!
-			T* component = (T*)m_componentPools[typeid(T).hash_code()]->GetFreeComponent();
-			entity->AddComponent(component);
-			return component;
+			BOOST_ASSERT(ComponentTypeIndex<T>::IsRegistered());
+			return static_cast<T*>(AddComponent(entity, ComponentTypeIndex<T>::Get()));
 		}
 
+		/// Adds a component of the registered type given. While recording, the component is only attached
+		/// straight away if the entity was created by the same thread - otherwise it's attached when the
+		/// command buffers are applied.
+		Component* AddComponent(Entity* entity, ComponentTypeId typeId);
+
 		/// Removes a component from the entity in question and enqueues it so that in the next synchronise it will be
 		/// removed from the active list.
 		template <class T> void RemoveComponent(Entity* entity)
 		{
-			T* component = entity->GetComponentByType<T>();
-			entity->RemoveComponent(component);
-			m_componentPools[typeid(T).hash_code()]->ReleaseComponentDeferred(component);
+			RemoveComponent(entity, entity->GetComponentByTypeFast<T>());
 		}
 		
 		/// Removes a component by Component pointer
-		void RemoveComponent(Entity* entity, Component* component)
-		{
-			entity->RemoveComponent(component);	
-			const type_info& ti = typeid(*component);
-			m_componentPools[ti.hash_code()]->ReleaseComponentDeferred(component);
-		}
+		void RemoveComponent(Entity* entity, Component* component);
 
-		/// Gets a free entity
+		/// Gets a free entity (or nullptr if the entity pool is exhausted and may not grow)
+		/// The entity (and its handle) are usable immediately, even while recording.
 		Entity* GetFreeEntity();
 
+		/// \name Prefabs
+		/// @{
+			/// Spawns an entity with all the prefab's components attached (or nullptr if the entity pool is exhausted).
+			Entity* Spawn(const Prefab& prefab);
+
+			/// Spawns 'count' entities from the prefab. Entities & components for the whole batch are
+			/// reserved up front & the pools resolved once. Each entity has all of its components attached
+			/// before the initialiser is called for it, so sibling lookups (GetComponentByTypeFast) just work,
+			/// both in the initialiser & in the components' Initialise.
+			///
+			/// Spawned entities are appended to 'spawned' if given. The batch is all or nothing - returns 'count',
+			/// or 0 (having spawned nothing) if the entity pool or any of the component pools can't hold it all.
+			size_t SpawnBatch(const Prefab& prefab, size_t count, const SpawnInitialiser& initialiser, std::vector<Entity*>* spawned = nullptr);
+		/// @}
+
+		/// \name Views
+		/// @{
+			/// Gets the pool of the registered component type T (nullptr if T isn't registered).
+			template <class T> ComponentPool* GetComponentPool()
+			{
+				ComponentTypeId typeId = ComponentTypeIndex<T>::Get();
+				return typeId < m_componentPools.size() ? m_componentPools[typeId] : nullptr;
+			}
+
+			/// Gets a view of the entities with an active A & B (see View), for walking as one batch.
+			template <class A, class B> View<A, B> GetView()
+			{
+				ComponentPool* pools[] = { GetComponentPool<A>(), GetComponentPool<B>() };
+				return View<A, B>(pools);
+			}
+
+			/// Gets a view of the entities with an active A, B & C.
+			template <class A, class B, class C> View<A, B, C> GetView()
+			{
+				ComponentPool* pools[] = { GetComponentPool<A>(), GetComponentPool<B>(), GetComponentPool<C>() };
+				return View<A, B, C>(pools);
+			}
+		/// @}
+
 		/// Releases an entity (also releasing all of its components)
+		/// Note that the release is deferred until the next synchronise - until then the entity's
+		/// handles still resolve. While recording, the destruction event is also only raised then.
 		void ReleaseEntity(Entity* entity);
 
-		/// Finds the first entity which has the name provided, or nullptr if none exist
-		/// This method is slow - requires a search through _all_ entities! Use it sparingly.
-		Entity* FindEntityByName(const std::string& name);
+		/// \name Handles
+		/// @{
+			/// Whether the handle refers to an entity which has not been released since the handle was taken.
+			bool IsValid(EntityHandle handle) const
+			{
+				return handle.GetIndex() < m_entities.GetCapacity() && m_entities[handle.GetIndex()].m_generation == handle.GetGeneration();
+			}
+
+			/// Gets the entity the handle refers to, or nullptr if the handle is stale (or null)
+			Entity* ResolveHandle(EntityHandle handle)
+			{
+				return IsValid(handle) ? &m_entities[handle.GetIndex()] : nullptr;
+			}
+		/// @}
+
+		/// \name Names & tags
+		/// @{
+			/// Interns a name (or tag), returning its id.
+			NameId InternName(const std::string& name) { return m_names.Intern(name); }
+			const NameTable& GetNames() const { return m_names; }
+
+			/// Finds the first entity which was given the name provided, or nullptr if none exist.
+			/// Constant time - just a hash of the name & an index lookup.
+			Entity* FindEntityByName(const std::string& name);
+			Entity* FindEntityByName(NameId name);
 
-		/// After all pools have been created, invoke this to setup the update lists.
+			/// Gets all entities with the tag provided.
+			const std::vector<Entity*>& FindEntitiesByTag(const std::string& tag);
+			const std::vector<Entity*>& FindEntitiesByTag(NameId tag);
+		/// @}
+
+		/// After all pools have been created, invoke this to setup the update lists (and graphs).
 		void RefreshUpdateLists();
 
+		/// \name Scheduling
+		/// @{
+			/// Sets how the physics & core updates are run; parallel scheduling runs them on the worker
+			/// pool given (which the manager doesn't own). The render update & synchronise always run
+			/// pools one at a time, though parallel safe pools still split their own work in parallel mode.
+			void SetUpdateScheduling(UpdateScheduling scheduling, WorkerPool* workerPool = nullptr);
+			UpdateScheduling GetUpdateScheduling() const { return m_updateScheduling; }
+		/// @}
+
 		/// Scorched earth "Clear all" destroys all existing entities
 		/// excepting any with a name in the list specified and forces one synchronise in order
 		/// to ensure they're dead.
@@ -117,6 +244,53 @@ namespace ComponentModel
 		/// that still ensures the most usefulness.
 		void ClearAll(const std::set<std::string>* namesToExclude);
 
+		/// Bulk alternative to ClearAll for level transitions: releases every entity which isn't persistent (see
+		/// Entity::SetPersistent) straight away, without raising an entity destroyed event for each. Each pool
+		/// releases its components wholesale, dropping their message hub subscriptions in one go (see
+		/// ComponentPool::ReleaseForReset), then one synchronise runs to pick up anything pending on the survivors.
+		/// As with ClearAll, don't call this during the updates.
+		void ResetWorld();
+
+		/// \name Snapshots
+		/// Saves the world (bar persistent entities) - entities, their components & the free lists - into one
+		/// contiguous buffer, and puts it back again wholesale. Component types opt in with GetSnapshotMode; a
+		/// snapshot fails if any live component's type hasn't. The buffer refers to the running game (pointers
+		/// to renderers, names interned in this manager...), so it's good for this session only - for quick
+		/// save/restore, rewinding & testing, not for saving to disc.
+		///
+		/// Restoring resets the world first, then puts entities & components back into the same slots they were
+		/// in, so handles taken before the snapshot resolve again. Handles taken after it are not invalidated,
+		/// and may alias restored entities. As with ResetWorld, don't call either during the updates.
+		/// @{
+			bool Snapshot(SnapshotBuffer& buffer);
+			bool Restore(const SnapshotBuffer& buffer);
+		/// @}
+
+		/// \name Pool usage
+		/// @{
+			size_t GetEntityCapacity() const { return m_entities.GetCapacity(); }
+			size_t GetEntityHighWaterMark() const { return m_entityHighWaterMark; }
+
+			/// Logs the capacity, high water mark & policy of the entity pool and every component pool,
+			/// for use in sizing the pools.
+			void LogPoolUsage() const;
+
+			/// Gets the occupancy, churn & memory use of the entity pool.
+			PoolStatistics GetEntityPoolStatistics() const;
+			/// Gets the statistics of the entity pool, followed by those of each component pool (in type order).
+			void GetPoolStatistics(std::vector<PoolStatistics>& statistics) const;
+
+			/// Writes the CSV header row (nothing for JSON).
+			static void WritePoolStatisticsHeader(std::ostream& stream, StatisticsFormat format);
+			/// Writes the statistics of every pool, tagged with the number of synchronises so far.
+			void WritePoolStatistics(std::ostream& stream, StatisticsFormat format) const;
+
+			/// Appends the statistics of every pool to the file given every 'intervalFrames' synchronises,
+			/// until stopped. Returns false if the file couldn't be opened.
+			bool StartPoolStatisticsDump(const std::string& fileName, StatisticsFormat format, unsigned int intervalFrames);
+			void StopPoolStatisticsDump();
+		/// @}
+
 		/// \name All update methods
 		/// @{
 			void PhysicsUpdate(const GameTime& /*time*/);
@@ -128,19 +302,146 @@ namespace ComponentModel
 		/// Actually does the release on an entity.
 		void DoReleaseEntity(Entity* entity);
 
+		/// Returns an entity with no components, name or tags left to the free list, invalidating its handles.
+		void RecycleEntity(Entity* entity);
+
+		/// Drops the entities which are no longer alive from a name or tag index.
+		void PruneIndex(std::vector< std::vector<Entity*> >& index);
+
+		/// Caches the world transform of every entity which has moved, and all of their descendants, 
+		/// breadth first from the top of each dirty subtree.
+		void UpdateWorldTransforms();
+
+		/// How an entity is kept in a snapshot - followed by its tags.
+		struct EntityRecord
+		{
+			unsigned int m_index;
+			unsigned int m_generation;
+			unsigned char m_enabled;
+			NameId m_nameId;
+			unsigned int m_tagCount;
+			unsigned int m_parentIndex; ///< c_noParent if the entity's a root
+			TransformStore::Record m_transform;
+		};
+		static const unsigned int c_noParent = ~0u;
+
+		/// Bumped whenever the snapshot layout changes.
+		static const unsigned int c_snapshotVersion = 2;
+
+		/// Adds another chunk of entities.
+		void GrowEntityPool();
+
+		/// Takes an entity from the free list (the caller takes care of locking).
+		Entity* AcquireEntity();
+
+		/// Grows the entity pool (if its policy allows) until at least 'count' entities are free, returning whether they are.
+		bool ReserveEntities(size_t count);
+
+		/// Resolves the pools for a prefab's components, returning how many there are.
+		size_t ResolvePrefabPools(const Prefab& prefab, ComponentPool** pools);
+
+		/// Gets a free entity & attaches a component from each of the pools given.
+		Entity* SpawnEntity(ComponentPool* const* pools, size_t poolCount);
+		/// SpawnEntity, without recording the creation (the caller takes care of locking & recording).
+		Entity* AcquirePrefabEntity(ComponentPool* const* pools, size_t poolCount);
+
+		/// \name Command buffers
+		/// @{
+			/// Gets the calling thread's command buffer (creating it if this is the thread's first change).
+			CommandBuffer* GetThreadBuffer();
+			/// The calling thread's command buffer if changes are being recorded, otherwise nullptr.
+			CommandBuffer* GetRecordingBuffer();
+			/// Suspends (or resumes) recording on the calling thread, for the duration of a parallel chunk.
+			void SetThreadRecordingSuspended(bool suspended);
+			/// Starts recording another update pass.
+			void BeginRecording();
+			/// Tags the calling thread's commands as coming from the pool at the position given in the current pass.
+			void SetRecordingSource(size_t poolOrder);
+			/// Records the creation of an entity (if recording).
+			void RecordCreate(Entity* entity);
+			/// Applies every recorded command, in source order.
+			void ApplyCommandBuffers();
+
+			/// The buffers are owned by the manager, so the thread local pointers mustn't clean them up.
+			static void KeepCommandBuffer(CommandBuffer* /*buffer*/) {}
+			/// Marks the entity for release & tells everyone it's going.
+			void DestroyEntity(Entity* entity);
+		/// @}
+
+		/// Builds the update graph for a (sorted) update list - each pool depends on all earlier
+		/// pools its data access conflicts with.
+		void BuildUpdateGraph(const std::list<ComponentPool*>& updateList, void (ComponentPool::*update)(const GameTime&), TaskGraph& graph, const char* phaseName);
+
+		/// \name Name & tag index maintenance
+		/// @{
+			void SetEntityName(Entity* entity, NameId name);
+			void AddEntityTag(Entity* entity, NameId tag);
+			void RemoveEntityTag(Entity* entity, NameId tag);
+			/// Removes the entity's name & tags (and its entries in the index)
+			void ClearEntityNameAndTags(Entity* entity);
+			/// Gets the index list for an id (growing the index as needed)
+			std::vector<Entity*>& GetIndexList(std::vector< std::vector<Entity*> >& index, NameId id);
+		/// @}
+
 		// Reference to the game context (we hold this)
 		const GameContext* m_gameContext;
 
-		// Component pool management
-		std::map<size_t,  ComponentPool*> m_componentPools;
+		// Component pool management (pools are indexed by component type id)
+		std::vector<ComponentPool*> m_componentPools;
 		std::list<ComponentPool*> m_physicsUpdateList;
 		std::list<ComponentPool*> m_coreUpdateList;
 		std::list<ComponentPool*> m_renderUpdateList;
 		std::list<ComponentPool*> m_synchroniseList;
 
-		// Entity pool.
-		std::vector<Entity*> m_entities;
-		std::list<Entity*> m_freeEntities;
-		std::set<Entity*> m_deferredFreeEntities;
+		// Update phases unrolled over a compile time registry of the types (if one registered them) -
+		// these replace walking the lists above when updating serially.
+		typedef void (*UpdatePhase)(EntityComponentManager&, const GameTime&);
+		UpdatePhase m_physicsPhase;
+		UpdatePhase m_corePhase;
+		UpdatePhase m_renderPhase;
+		void (*m_synchronisePhase)(EntityComponentManager&);
+
+		// Command buffers (one per thread which has recorded changes)
+		bool m_recording;
+		unsigned int m_recordingPass;
+		boost::thread_specific_ptr<CommandBuffer> m_threadBuffer;
+		std::vector<CommandBuffer*> m_commandBuffers;
+		std::vector<CommandBuffer::Command> m_recordedCommands;
+		boost::mutex m_structureMutex; // Guards the free lists & buffer list while recording.
+
+		// Parallel scheduling
+		UpdateScheduling m_updateScheduling;
+		WorkerPool* m_workerPool;
+		TaskGraph m_physicsUpdateGraph;
+		TaskGraph m_coreUpdateGraph;
+		const GameTime* m_scheduledTime; // Time passed to the update graph currently running.
+
+		// Entity pool (and the transforms of the entities, chunk for chunk)
+		ChunkedStorage<Entity> m_entities;
+		TransformStore m_transforms;
+		std::vector<unsigned int> m_dirtyTransforms; // Scratch space for the world transform update
+		std::vector<Entity*> m_transformQueue;
+		std::vector<Entity*> m_freeEntities;
+		std::vector<unsigned int> m_deferredFreeEntities;
+		PoolCapacityPolicy m_entityCapacityPolicy;
+		size_t m_entityHighWaterMark;
+
+		// Entity churn (see ComponentPool), and the statistics dump
+		size_t m_entityAcquireCount;
+		size_t m_entityReleaseCount;
+		size_t m_lastFrameEntityAcquires;
+		size_t m_lastFrameEntityReleases;
+		size_t m_lastEntityReleaseQueueDepth;
+		size_t m_peakEntityReleaseQueueDepth;
+		unsigned int m_synchroniseCount;
+		std::ofstream m_statisticsDump;
+		StatisticsFormat m_statisticsDumpFormat;
+		unsigned int m_statisticsDumpInterval; // In synchronises (0 when not dumping)
+
+		// Name table & indices (entities with a given name/tag, indexed by name id)
+		NameTable m_names;
+		std::vector< std::vector<Entity*> > m_nameIndex;
+		std::vector< std::vector<Entity*> > m_tagIndex;
+		std::vector<Entity*> m_noEntities;
 	};
 };
\ No newline at end of file
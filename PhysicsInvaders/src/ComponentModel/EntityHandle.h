@@ -0,0 +1,85 @@
+/*
+ * This source file is part of one of Jeremy Burgess's samples.
+ *
+ * Copyright (c) 2013 Jeremy Burgess 
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+namespace ComponentModel
+{
+	/**
+	 * \class EntityHandle
+	 *
+	 * Compact (32 bit) reference to an entity: the index of the entity in the entity pool plus the
+	 * generation of the entity at the time the handle was taken. Entities bump their generation when
+	 * they are released back to the pool, so a handle to a recycled entity no longer resolves
+	 * (unlike a raw pointer, which would silently alias whatever now lives there).
+	 *
+	 * Handles are resolved & validated by the EntityComponentManager. The default (null) handle
+	 * is all zeroes - generation 0 is never given to an entity, so it never resolves.
+	 */
+	class EntityHandle
+	{
+	public:
+		static const unsigned int c_indexBits = 20;
+		static const unsigned int c_generationBits = 32 - c_indexBits;
+		static const unsigned int c_indexMask = (1u << c_indexBits) - 1;
+		static const unsigned int c_generationMask = (1u << c_generationBits) - 1;
+		static const unsigned int c_maxIndex = c_indexMask;
+
+	public:
+		EntityHandle() : 
+			m_value(0) 
+		{}
+
+		EntityHandle(unsigned int index, unsigned int generation) :
+			m_value((index & c_indexMask) | ((generation & c_generationMask) << c_indexBits))
+		{}
+
+		/// Recreates a handle from a value previously obtained from GetValue.
+		static EntityHandle FromValue(unsigned int value) 
+		{ 
+			EntityHandle handle;
+			handle.m_value = value;
+			return handle;
+		}
+
+		/// Gets the generation which follows the one given (skipping 0, which is reserved for null handles)
+		static unsigned int NextGeneration(unsigned int generation)
+		{
+			unsigned int next = (generation + 1) & c_generationMask;
+			return next == 0 ? 1 : next;
+		}
+
+		inline unsigned int GetIndex() const { return m_value & c_indexMask; }
+		inline unsigned int GetGeneration() const { return m_value >> c_indexBits; }
+		inline unsigned int GetValue() const { return m_value; }
+		inline bool IsNull() const { return m_value == 0; }
+
+		inline bool operator==(const EntityHandle& other) const { return m_value == other.m_value; }
+		inline bool operator!=(const EntityHandle& other) const { return m_value != other.m_value; }
+		inline bool operator<(const EntityHandle& other) const { return m_value < other.m_value; }
+
+	private:
+		unsigned int m_value;
+	};
+};
@@ -0,0 +1,72 @@
+/*
+ * This source file is part of one of Jeremy Burgess's samples.
+ *
+ * Copyright (c) 2013 Jeremy Burgess 
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+// STL
+#include <string>
+#include <deque>
+#include <unordered_map>
+
+// Boost
+#include <boost/noncopyable.hpp>
+
+namespace ComponentModel
+{
+	/// Interned name (or tag) identifier.
+	typedef unsigned int NameId;
+
+	/// The id of the empty name - interned up front, so it's always valid.
+	const NameId c_noName = 0;
+
+	/**
+	 * \class NameTable
+	 *
+	 * Interns strings as dense ids, so names & tags can be stored, compared & indexed
+	 * as integers. Strings are never removed once interned; references returned by GetString
+	 * stay valid for the lifetime of the table.
+	 */
+	class NameTable : public boost::noncopyable
+	{
+	public:
+		NameTable();
+
+		/// Gets the id for a string, interning it if it hasn't been seen before.
+		NameId Intern(const std::string& name);
+
+		/// Gets the id for a string without interning it - returns false if the string has never been interned.
+		bool TryGetId(const std::string& name, NameId& outId) const;
+
+		/// Gets the string an id was interned from.
+		const std::string& GetString(NameId id) const { return m_strings[id]; }
+
+		/// Number of interned strings (ids are [0, count))
+		size_t GetCount() const { return m_strings.size(); }
+
+	private:
+		std::unordered_map<std::string, NameId> m_ids;
+		// Deque so that references to the strings are stable as the table grows.
+		std::deque<std::string> m_strings;
+	};
+};
@@ -0,0 +1,73 @@
+/*
+ * This source file is part of one of Jeremy Burgess's samples.
+ *
+ * Copyright (c) 2013 Jeremy Burgess 
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+// Component model
+#include "PoolStorage.h"
+
+namespace ComponentModel
+{
+	/// Formats pool statistics can be written in.
+	enum StatisticsFormat
+	{
+		SF_CSV,		///< One row per pool, with a header row when the dump is started.
+		SF_JSON,	///< One JSON object per dump (per line), holding an array of the pools.
+	};
+
+	/**
+	 * \struct PoolStatistics
+	 *
+	 * Occupancy, churn & memory use of one pool (the entity pool or a component pool). Per frame
+	 * figures cover the frame up to the most recent synchronise.
+	 */
+	struct PoolStatistics
+	{
+		PoolStatistics() :
+			m_typeName(""),
+			m_capacityPolicy(PCP_GROW),
+			m_capacity(0),
+			m_liveCount(0),
+			m_highWaterMark(0),
+			m_acquiresPerFrame(0),
+			m_releasesPerFrame(0),
+			m_releaseQueueDepth(0),
+			m_peakReleaseQueueDepth(0),
+			m_bytesPerItem(0),
+			m_reservedBytes(0)
+		{}
+
+		const char* m_typeName;
+		PoolCapacityPolicy m_capacityPolicy;
+		size_t m_capacity;
+		size_t m_liveCount;					///< Handed out (including those pending release)
+		size_t m_highWaterMark;				///< Most ever handed out at once
+		size_t m_acquiresPerFrame;
+		size_t m_releasesPerFrame;
+		size_t m_releaseQueueDepth;			///< Deferred releases processed by the last synchronise
+		size_t m_peakReleaseQueueDepth;		///< Most deferred releases ever processed by one synchronise
+		size_t m_bytesPerItem;
+		size_t m_reservedBytes;				///< Storage for every slot, plus the pool's bookkeeping
+	};
+};
@@ -0,0 +1,113 @@
+/*
+ * This source file is part of one of Jeremy Burgess's samples.
+ *
+ * Copyright (c) 2013 Jeremy Burgess 
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+// STL
+#include <vector>
+
+// Boost
+#include <boost/noncopyable.hpp>
+
+// Eigen (for the aligned allocator - pooled types may hold aligned Eigen members)
+#include "Core/EigenIncludes.h"
+
+namespace ComponentModel
+{
+	/// What a pool does when asked for an object and none are free.
+	enum PoolCapacityPolicy
+	{
+		PCP_FIXED,		///< Logs a warning and hands out nothing (nullptr).
+		PCP_GROW,		///< Adds another chunk of the pool's initial size.
+		PCP_FAIL_FAST,	///< Logs an error and asserts.
+	};
+
+	/// Gets a printable name for a capacity policy.
+	inline const char* GetPoolCapacityPolicyName(PoolCapacityPolicy policy)
+	{
+		switch (policy)
+		{
+		case PCP_FIXED: return "fixed";
+		case PCP_GROW: return "grow";
+		case PCP_FAIL_FAST: return "fail-fast";
+		default: return "unknown";
+		}
+	}
+
+	/**
+	 * \class ChunkedStorage
+	 *
+	 * Stores objects by value in fixed size chunks of contiguous, aligned memory.
+	 * Growing the storage adds a chunk, so objects never move once constructed; pointers
+	 * into the storage remain valid for its whole lifetime.
+	 *
+	 * Objects are default constructed when their chunk is added, and destroyed with the storage.
+	 */
+	template <class T>
+	class ChunkedStorage : public boost::noncopyable
+	{
+	public:
+		ChunkedStorage(size_t chunkSize) :
+			m_chunkSize(chunkSize > 0 ? chunkSize : 1)
+		{}
+
+		~ChunkedStorage()
+		{
+			for (auto chIt = m_chunks.begin(); chIt != m_chunks.end(); ++chIt)
+			{
+				T* chunk = (*chIt);
+				for (size_t i = 0; i < m_chunkSize; ++i)
+				{
+					chunk[i].~T();
+				}
+				m_allocator.deallocate(chunk, m_chunkSize);
+			}
+			m_chunks.clear();
+		}
+
+		/// Allocates & constructs another chunk, returning a pointer to its first object.
+		T* AddChunk()
+		{
+			T* chunk = m_allocator.allocate(m_chunkSize);
+			for (size_t i = 0; i < m_chunkSize; ++i)
+			{
+				new (chunk + i) T();
+			}
+			m_chunks.push_back(chunk);
+			return chunk;
+		}
+
+		size_t GetChunkSize() const { return m_chunkSize; }
+		size_t GetChunkCount() const { return m_chunks.size(); }
+		size_t GetCapacity() const { return m_chunks.size() * m_chunkSize; }
+
+		T& operator[](size_t index) { return m_chunks[index / m_chunkSize][index % m_chunkSize]; }
+		const T& operator[](size_t index) const { return m_chunks[index / m_chunkSize][index % m_chunkSize]; }
+
+	private:
+		Eigen::aligned_allocator<T> m_allocator;
+		std::vector<T*> m_chunks;
+		size_t m_chunkSize;
+	};
+};
@@ -0,0 +1,63 @@
+/*
+ * This source file is part of one of Jeremy Burgess's samples.
+ *
+ * Copyright (c) 2013 Jeremy Burgess 
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+// STL
+#include <vector>
+
+// Component model
+#include "ComponentTypeIndex.h"
+
+namespace ComponentModel
+{
+	/**
+	 * \class Prefab
+	 *
+	 * Describes the components every entity spawned from it starts with, so that batches of
+	 * identical entities can be spawned by the entity component manager in one go.
+	 *
+	 * Component types are resolved when spawning rather than when added to the prefab, so prefabs
+	 * can be built (e.g. as statics) before the types are registered.
+	 */
+	class Prefab
+	{
+	public:
+		/// Gets the type index of a registered component type.
+		typedef ComponentTypeId (*TypeIdGetter)();
+
+	public:
+		/// Adds a component of type T to the prefab. Components are attached in the order added.
+		template <class T> Prefab& AddComponent()
+		{
+			m_componentTypes.push_back(&ComponentTypeIndex<T>::Get);
+			return *this;
+		}
+
+		const std::vector<TypeIdGetter>& GetComponentTypes() const { return m_componentTypes; }
+
+	private:
+		std::vector<TypeIdGetter> m_componentTypes;
+	};
+};
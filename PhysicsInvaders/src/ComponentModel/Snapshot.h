@@ -0,0 +1,171 @@
+/*
+ * This source file is part of one of Jeremy Burgess's samples.
+ *
+ * Copyright (c) 2013 Jeremy Burgess 
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+// STL
+#include <vector>
+#include <cstring>
+
+// Boost
+#include <boost/static_assert.hpp>
+#include <boost/type_traits/has_trivial_copy.hpp>
+
+namespace ComponentModel
+{
+	/// How components of a type are written to a snapshot (see Component::GetSnapshotMode).
+	enum SnapshotMode
+	{
+		SM_NONE,		///< Can't be snapshotted - a snapshot fails if any are live.
+		SM_BITWISE,		///< The type's SnapshotState is copied byte for byte (see Component::GetSnapshotState).
+		SM_CUSTOM,		///< Written & read by the component itself (Component::SaveSnapshot & LoadSnapshot).
+	};
+
+	/// One contiguous buffer holding a snapshot of the component model. Keep it around & snapshot into
+	/// it again - the memory is reused. Snapshots hold pointers, so are only good for the run they're taken in.
+	typedef std::vector<unsigned char> SnapshotBuffer;
+
+	/**
+	 * \class SnapshotWriter
+	 *
+	 * Appends raw values to a snapshot buffer.
+	 */
+	class SnapshotWriter
+	{
+	public:
+		SnapshotWriter(SnapshotBuffer& buffer) : m_buffer(buffer) {}
+
+		void Write(const void* data, size_t size)
+		{
+			const unsigned char* bytes = static_cast<const unsigned char*>(data);
+			m_buffer.insert(m_buffer.end(), bytes, bytes + size);
+		}
+
+		/// Writes a value byte for byte, so only for plain old data.
+		template <class T> void Write(const T& value) 
+		{ 
+			BOOST_STATIC_ASSERT(boost::has_trivial_copy<T>::value);
+			Write(&value, sizeof(T)); 
+		}
+
+		/// Writes the length of the array, then its elements byte for byte.
+		template <class T> void WriteArray(const std::vector<T>& values)
+		{
+			BOOST_STATIC_ASSERT(boost::has_trivial_copy<T>::value);
+			Write(static_cast<unsigned int>(values.size()));
+			if (!values.empty())
+			{
+				Write(&values[0], values.size() * sizeof(T));
+			}
+		}
+
+	private:
+		SnapshotWriter& operator=(const SnapshotWriter&);
+
+		SnapshotBuffer& m_buffer;
+	};
+
+	/**
+	 * \class SnapshotReader
+	 *
+	 * Reads raw values back out of a snapshot buffer, in the order they were written. Reading past
+	 * the end of the buffer zeroes the value & marks the reader as failed.
+	 */
+	class SnapshotReader
+	{
+	public:
+		SnapshotReader(const SnapshotBuffer& buffer) : m_buffer(buffer), m_position(0), m_failed(false) {}
+		SnapshotReader(const SnapshotReader& other) : m_buffer(other.m_buffer), m_position(other.m_position), m_failed(other.m_failed) {}
+
+		bool Read(void* data, size_t size)
+		{
+			if (m_failed || size > m_buffer.size() - m_position)
+			{
+				m_failed = true;
+				std::memset(data, 0, size);
+				return false;
+			}
+			if (size > 0)
+			{
+				std::memcpy(data, &m_buffer[m_position], size);
+				m_position += size;
+			}
+			return true;
+		}
+
+		/// Skips over values which aren't needed.
+		bool Skip(size_t size)
+		{
+			if (m_failed || size > m_buffer.size() - m_position)
+			{
+				m_failed = true;
+				return false;
+			}
+			m_position += size;
+			return true;
+		}
+
+		/// Reads a value byte for byte, so only for plain old data.
+		template <class T> bool Read(T& value) 
+		{ 
+			BOOST_STATIC_ASSERT(boost::has_trivial_copy<T>::value);
+			return Read(&value, sizeof(T)); 
+		}
+		template <class T> T Read() 
+		{ 
+			BOOST_STATIC_ASSERT(boost::has_trivial_copy<T>::value);
+			T value;
+			Read(&value, sizeof(T));
+			return value;
+		}
+
+		/// Reads an array written by SnapshotWriter::WriteArray (replacing the contents of 'values').
+		template <class T> bool ReadArray(std::vector<T>& values)
+		{
+			BOOST_STATIC_ASSERT(boost::has_trivial_copy<T>::value);
+			unsigned int count = Read<unsigned int>();
+			if (m_failed || count > (m_buffer.size() - m_position) / sizeof(T))
+			{
+				m_failed = true;
+				values.clear();
+				return false;
+			}
+			values.resize(count);
+			return count == 0 || Read(&values[0], count * sizeof(T));
+		}
+
+		bool IsValid() const { return !m_failed; }
+
+		/// A reader at the same position (& state), for reading ahead without moving this one.
+		SnapshotReader Fork() const { return SnapshotReader(*this); }
+		bool IsAtEnd() const { return m_position == m_buffer.size(); }
+
+	private:
+		SnapshotReader& operator=(const SnapshotReader&);
+
+		const SnapshotBuffer& m_buffer;
+		size_t m_position;
+		bool m_failed;
+	};
+};
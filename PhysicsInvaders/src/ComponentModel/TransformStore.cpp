@@ -0,0 +1,282 @@
+/*
+ * This source file is part of one of Jeremy Burgess's samples.
+ *
+ * Copyright (c) 2013 Jeremy Burgess 
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "TransformStore.h"
+
+// STL
+#include <cmath>
+
+// SSE
+#include <emmintrin.h>
+
+namespace ComponentModel
+{
+	const size_t TransformStore::c_simdWidth;
+
+	/// out = mask ? previous + (next - previous) * t : out, for 4 slots
+	static inline void BlendKeyframes(float* out, const float* previous, const float* next, __m128 t, __m128 mask)
+	{
+		__m128 from = _mm_load_ps(previous);
+		__m128 value = _mm_add_ps(from, _mm_mul_ps(_mm_sub_ps(_mm_load_ps(next), from), t));
+		_mm_store_ps(out, _mm_or_ps(_mm_and_ps(mask, value), _mm_andnot_ps(mask, _mm_load_ps(out))));
+	}
+
+	TransformStore::Chunk::Chunk(size_t size) :
+		m_stride((size + c_simdWidth - 1) / c_simdWidth * c_simdWidth),
+		m_streams(TS_COUNT * m_stride, 0.f),
+		m_keyframed(m_stride, 0),
+		m_orientations(m_stride, Eigen::Quaternionf::Identity()),
+		m_hasOrientation(m_stride, 0),
+		m_dirty(m_stride, 0),
+		m_localTransforms(m_stride, Eigen::Affine3f::Identity()),
+		m_worldTransforms(m_stride, Eigen::Affine3f::Identity())
+	{
+		for (size_t i = 0; i < m_stride; ++i)
+		{
+			Reset(i);
+		}
+	}
+
+	void TransformStore::Chunk::Reset(size_t slot)
+	{
+		for (int stream = 0; stream < TS_COUNT; ++stream)
+		{
+			Set(static_cast<Stream>(stream), slot, 0.f);
+		}
+		Set(TS_SCALE, slot, 1.f);
+		m_keyframed[slot] = 0;
+		m_hasOrientation[slot] = 0;
+	}
+
+	Eigen::Quaternionf TransformStore::Chunk::GetOrientation(size_t slot) const
+	{
+		if (m_hasOrientation[slot])
+		{
+			return m_orientations[slot];
+		}
+		return Eigen::Quaternionf(Eigen::AngleAxisf(Get(TS_ANGLE, slot), Eigen::Vector3f::UnitZ()));
+	}
+
+	void TransformStore::Chunk::SetOrientation(size_t slot, const Eigen::Quaternionf& orientation)
+	{
+		// Rotations about z (only) fit in the angle stream.
+		if (orientation.x() == 0 && orientation.y() == 0)
+		{
+			SetAngle(slot, 2 * atan2(orientation.z(), orientation.w()));
+		}
+		else
+		{
+			Set(TS_ANGLE, slot, 0.f);
+			m_orientations[slot] = orientation;
+			m_hasOrientation[slot] = 1;
+		}
+	}
+
+	void TransformStore::Chunk::SetAngle(size_t slot, float angle)
+	{
+		Set(TS_ANGLE, slot, angle);
+		m_hasOrientation[slot] = 0;
+	}
+
+	void TransformStore::Chunk::ResetKeyframes(size_t slot, float x, float y, float angle)
+	{
+		Set(TS_PREVIOUS_X, slot, x);
+		Set(TS_PREVIOUS_Y, slot, y);
+		Set(TS_PREVIOUS_ANGLE, slot, angle);
+		Set(TS_NEXT_X, slot, x);
+		Set(TS_NEXT_Y, slot, y);
+		Set(TS_NEXT_ANGLE, slot, angle);
+		m_keyframed[slot] = ~0u;
+		m_hasOrientation[slot] = 0;
+	}
+
+	void TransformStore::Chunk::PushKeyframe(size_t slot, float x, float y, float angle)
+	{
+		Set(TS_PREVIOUS_X, slot, Get(TS_NEXT_X, slot));
+		Set(TS_PREVIOUS_Y, slot, Get(TS_NEXT_Y, slot));
+		Set(TS_PREVIOUS_ANGLE, slot, Get(TS_NEXT_ANGLE, slot));
+		Set(TS_NEXT_X, slot, x);
+		Set(TS_NEXT_Y, slot, y);
+		Set(TS_NEXT_ANGLE, slot, angle);
+	}
+
+	Eigen::Affine3f TransformStore::Chunk::BuildLocalTransform(size_t slot) const
+	{
+		Eigen::Affine3f transform(Eigen::Affine3f::Identity());
+		transform.prerotate(GetOrientation(slot));
+		transform.prescale(Get(TS_SCALE, slot));
+		transform.pretranslate(Eigen::Vector3f(Get(TS_X, slot), Get(TS_Y, slot), Get(TS_Z, slot)));
+		return transform;
+	}
+
+	Eigen::Affine3f TransformStore::Chunk::GetLocalTransform(size_t slot) const
+	{
+		return (m_dirty[slot] & TD_LOCAL) ? BuildLocalTransform(slot) : m_localTransforms[slot];
+	}
+
+	void TransformStore::Chunk::UpdateWorldTransform(size_t slot, const Eigen::Affine3f* parentWorld)
+	{
+		if (m_dirty[slot] & TD_LOCAL)
+		{
+			m_localTransforms[slot] = BuildLocalTransform(slot);
+		}
+		m_worldTransforms[slot] = parentWorld ? (*parentWorld) * m_localTransforms[slot] : m_localTransforms[slot];
+		m_dirty[slot] = 0;
+	}
+
+	void TransformStore::Chunk::CollectDirty(unsigned int firstIndex, size_t count, std::vector<unsigned int>& indices) const
+	{
+		__m128i zero = _mm_setzero_si128();
+		for (size_t i = 0; i < count; i += c_simdWidth)
+		{
+			// Skip 4 clean slots at a time - most slots are.
+			__m128i dirty = _mm_load_si128(reinterpret_cast<const __m128i*>(&m_dirty[i]));
+			if (_mm_movemask_epi8(_mm_cmpeq_epi32(dirty, zero)) == 0xFFFF)
+			{
+				continue;
+			}
+			for (size_t slot = i; slot < i + c_simdWidth && slot < count; ++slot)
+			{
+				if (m_dirty[slot] != 0)
+				{
+					indices.push_back(firstIndex + static_cast<unsigned int>(slot));
+				}
+			}
+		}
+	}
+
+	void TransformStore::Chunk::Save(size_t slot, Record& record) const
+	{
+		for (int stream = 0; stream < TS_COUNT; ++stream)
+		{
+			record.m_values[stream] = Get(static_cast<Stream>(stream), slot);
+		}
+		const Eigen::Quaternionf& orientation = m_orientations[slot];
+		record.m_orientation[0] = orientation.x();
+		record.m_orientation[1] = orientation.y();
+		record.m_orientation[2] = orientation.z();
+		record.m_orientation[3] = orientation.w();
+		record.m_keyframed = m_keyframed[slot];
+		record.m_hasOrientation = m_hasOrientation[slot];
+	}
+
+	void TransformStore::Chunk::Load(size_t slot, const Record& record)
+	{
+		for (int stream = 0; stream < TS_COUNT; ++stream)
+		{
+			Set(static_cast<Stream>(stream), slot, record.m_values[stream]);
+		}
+		m_orientations[slot] = Eigen::Quaternionf(record.m_orientation[3], record.m_orientation[0], record.m_orientation[1], record.m_orientation[2]);
+		m_keyframed[slot] = record.m_keyframed;
+		m_hasOrientation[slot] = record.m_hasOrientation;
+	}
+
+	void TransformStore::Chunk::Interpolate(float t)
+	{
+		__m128 tVector = _mm_set1_ps(t);
+		float* x = GetStream(TS_X);
+		float* y = GetStream(TS_Y);
+		float* angle = GetStream(TS_ANGLE);
+		const float* previousX = GetStream(TS_PREVIOUS_X);
+		const float* previousY = GetStream(TS_PREVIOUS_Y);
+		const float* previousAngle = GetStream(TS_PREVIOUS_ANGLE);
+		const float* nextX = GetStream(TS_NEXT_X);
+		const float* nextY = GetStream(TS_NEXT_Y);
+		const float* nextAngle = GetStream(TS_NEXT_ANGLE);
+		__m128i localDirty = _mm_set1_epi32(TD_LOCAL);
+
+		for (size_t i = 0; i < m_stride; i += c_simdWidth)
+		{
+			__m128i keyframed = _mm_load_si128(reinterpret_cast<const __m128i*>(&m_keyframed[i]));
+			__m128 mask = _mm_castsi128_ps(keyframed);
+			if (_mm_movemask_ps(mask) == 0)
+			{
+				continue;
+			}
+			BlendKeyframes(x + i, previousX + i, nextX + i, tVector, mask);
+			BlendKeyframes(y + i, previousY + i, nextY + i, tVector, mask);
+			BlendKeyframes(angle + i, previousAngle + i, nextAngle + i, tVector, mask);
+
+			// Everything interpolated has moved.
+			__m128i* dirty = reinterpret_cast<__m128i*>(&m_dirty[i]);
+			_mm_store_si128(dirty, _mm_or_si128(_mm_load_si128(dirty), _mm_and_si128(keyframed, localDirty)));
+		}
+	}
+
+	size_t TransformStore::Chunk::GetReservedBytes() const
+	{
+		return m_streams.capacity() * sizeof(float) + 
+			m_keyframed.capacity() * sizeof(unsigned int) + 
+			m_orientations.capacity() * sizeof(Eigen::Quaternionf) +
+			m_hasOrientation.capacity() +
+			m_dirty.capacity() * sizeof(unsigned int) +
+			(m_localTransforms.capacity() + m_worldTransforms.capacity()) * sizeof(Eigen::Affine3f);
+	}
+
+	TransformStore::TransformStore(size_t chunkSize) :
+		m_chunkSize(chunkSize > 0 ? chunkSize : 1)
+	{
+	}
+
+	TransformStore::~TransformStore()
+	{
+		for (auto chIt = m_chunks.begin(); chIt != m_chunks.end(); ++chIt)
+		{
+			delete *chIt;
+		}
+		m_chunks.clear();
+	}
+
+	TransformStore::Chunk* TransformStore::AddChunk()
+	{
+		m_chunks.push_back(new Chunk(m_chunkSize));
+		return m_chunks.back();
+	}
+
+	void TransformStore::Interpolate(float t)
+	{
+		for (auto chIt = m_chunks.begin(); chIt != m_chunks.end(); ++chIt)
+		{
+			(*chIt)->Interpolate(t);
+		}
+	}
+
+	void TransformStore::CollectDirty(std::vector<unsigned int>& indices) const
+	{
+		for (size_t chunk = 0; chunk < m_chunks.size(); ++chunk)
+		{
+			m_chunks[chunk]->CollectDirty(static_cast<unsigned int>(chunk * m_chunkSize), m_chunkSize, indices);
+		}
+	}
+
+	size_t TransformStore::GetReservedBytes() const
+	{
+		size_t bytes = m_chunks.capacity() * sizeof(Chunk*);
+		for (auto chIt = m_chunks.begin(); chIt != m_chunks.end(); ++chIt)
+		{
+			bytes += sizeof(Chunk) + (*chIt)->GetReservedBytes();
+		}
+		return bytes;
+	}
+};
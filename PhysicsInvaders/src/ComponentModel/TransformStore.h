@@ -0,0 +1,191 @@
+/*
+ * This source file is part of one of Jeremy Burgess's samples.
+ *
+ * Copyright (c) 2013 Jeremy Burgess 
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+// STL
+#include <vector>
+
+// Boost
+#include <boost/noncopyable.hpp>
+
+// Eigen
+#include "Core/EigenIncludes.h"
+
+namespace ComponentModel
+{
+	/**
+	 * \class TransformStore
+	 *
+	 * Holds the transforms of all entities as a structure of arrays - x, y, z, angle (about z) & scale
+	 * streams, in chunks matching the chunks of the entity pool (so chunks never move, and entities keep a 
+	 * pointer to theirs). Entities rotated about anything other than z keep a full orientation on the side.
+	 *
+	 * Entities driven by a fixed step simulation push a keyframe (x, y & angle) per step. Interpolate then
+	 * blends every keyframed entity between its last two keyframes in one SIMD pass.
+	 *
+	 * The streams hold each entity's local transform (relative to its parent, if it has one). The local
+	 * & world matrices are cached alongside, behind per slot dirty flags - anything which changes a
+	 * slot's streams flags its local transform dirty, & the entity component manager brings the world
+	 * transforms of everything flagged (and everything beneath it) up to date once a frame.
+	 */
+	class TransformStore : public boost::noncopyable
+	{
+	public:
+		/// The streams of each chunk.
+		enum Stream
+		{
+			TS_X,
+			TS_Y,
+			TS_Z,
+			TS_ANGLE,
+			TS_SCALE,
+			TS_PREVIOUS_X,	///< The keyframes being interpolated between
+			TS_PREVIOUS_Y,
+			TS_PREVIOUS_ANGLE,
+			TS_NEXT_X,
+			TS_NEXT_Y,
+			TS_NEXT_ANGLE,
+			TS_COUNT,
+		};
+
+		/// Streams are padded to a multiple of this, so they can be processed in whole SIMD registers.
+		static const size_t c_simdWidth = 4;
+
+		/// Why a slot's cached transforms are out of date.
+		enum DirtyFlag
+		{
+			TD_LOCAL = 1 << 0,	///< The streams have changed since the local transform was cached.
+			TD_WORLD = 1 << 1,	///< The parent (or the parent's transform) has changed.
+		};
+
+		/// Everything held for one slot, as plain data (for snapshots).
+		struct Record
+		{
+			float m_values[TS_COUNT];
+			float m_orientation[4];		///< x, y, z, w (only valid if m_hasOrientation)
+			unsigned int m_keyframed;
+			unsigned char m_hasOrientation;
+		};
+
+		/**
+		 * \class Chunk
+		 *
+		 * A chunk's worth of transforms. Each stream is 16 byte aligned.
+		 */
+		class Chunk : public boost::noncopyable
+		{
+		public:
+			Chunk(size_t size);
+
+			/// Back to the identity transform (and no keyframes).
+			void Reset(size_t slot);
+
+			inline float Get(Stream stream, size_t slot) const { return m_streams[stream * m_stride + slot]; }
+			inline void Set(Stream stream, size_t slot, float value) 
+			{ 
+				m_streams[stream * m_stride + slot] = value; 
+				m_dirty[slot] |= TD_LOCAL;
+			}
+
+			/// Full orientation, built from the angle for entities only rotated about z.
+			Eigen::Quaternionf GetOrientation(size_t slot) const;
+			void SetOrientation(size_t slot, const Eigen::Quaternionf& orientation);
+			void SetAngle(size_t slot, float angle);
+
+			/// \name Keyframes
+			/// @{
+				/// Starts interpolating the slot, from (and to) the keyframe given.
+				void ResetKeyframes(size_t slot, float x, float y, float angle);
+				/// Adds a keyframe - the slot is interpolated from the last keyframe to this one.
+				void PushKeyframe(size_t slot, float x, float y, float angle);
+				/// Stops interpolating the slot, leaving its transform where it is.
+				void StopKeyframes(size_t slot) { m_keyframed[slot] = 0; }
+				inline bool IsKeyframed(size_t slot) const { return m_keyframed[slot] != 0; }
+			/// @}
+
+			/// \name Cached transforms
+			/// @{
+				inline bool IsDirty(size_t slot) const { return m_dirty[slot] != 0; }
+				inline void MarkWorldDirty(size_t slot) { m_dirty[slot] |= TD_WORLD; }
+				inline void ClearDirty(size_t slot) { m_dirty[slot] = 0; }
+				/// The local transform - the cached one, unless the streams have changed since.
+				Eigen::Affine3f GetLocalTransform(size_t slot) const;
+				/// The world transform as of the last update (only current if neither the slot nor its parents are dirty).
+				inline const Eigen::Affine3f& GetWorldTransform(size_t slot) const { return m_worldTransforms[slot]; }
+				/// Caches the local transform (if dirty) & the world transform, given the parent's (nullptr if none), and clears the flags.
+				void UpdateWorldTransform(size_t slot, const Eigen::Affine3f* parentWorld);
+				/// Appends the indices (from the first index given) of every dirty slot below the count given.
+				void CollectDirty(unsigned int firstIndex, size_t count, std::vector<unsigned int>& indices) const;
+			/// @}
+
+			/// \name Snapshots
+			/// @{
+				void Save(size_t slot, Record& record) const;
+				void Load(size_t slot, const Record& record);
+			/// @}
+
+			/// Blends the transform of every keyframed slot 't' of the way from its previous to its next keyframe.
+			void Interpolate(float t);
+
+			size_t GetReservedBytes() const;
+
+		private:
+			inline float* GetStream(Stream stream) { return &m_streams[stream * m_stride]; }
+			Eigen::Affine3f BuildLocalTransform(size_t slot) const;
+
+		private:
+			size_t m_stride;
+			std::vector<float, Eigen::aligned_allocator<float> > m_streams;
+			// Per slot mask - all bits set while the slot is being interpolated
+			std::vector<unsigned int, Eigen::aligned_allocator<unsigned int> > m_keyframed;
+			// Orientations of slots rotated about anything other than z (only valid where flagged)
+			std::vector<Eigen::Quaternionf, Eigen::aligned_allocator<Eigen::Quaternionf> > m_orientations;
+			std::vector<unsigned char> m_hasOrientation;
+			// Per slot DirtyFlags, and the transforms they guard
+			std::vector<unsigned int, Eigen::aligned_allocator<unsigned int> > m_dirty;
+			std::vector<Eigen::Affine3f, Eigen::aligned_allocator<Eigen::Affine3f> > m_localTransforms;
+			std::vector<Eigen::Affine3f, Eigen::aligned_allocator<Eigen::Affine3f> > m_worldTransforms;
+		};
+
+	public:
+		TransformStore(size_t chunkSize);
+		~TransformStore();
+
+		/// Adds a chunk of identity transforms (to go with a new chunk of entities).
+		Chunk* AddChunk();
+
+		/// Interpolates every keyframed transform (see Chunk::Interpolate).
+		void Interpolate(float t);
+
+		/// Appends the (entity) index of every dirty slot, in index order.
+		void CollectDirty(std::vector<unsigned int>& indices) const;
+
+		size_t GetReservedBytes() const;
+
+	private:
+		std::vector<Chunk*> m_chunks;
+		size_t m_chunkSize;
+	};
+};
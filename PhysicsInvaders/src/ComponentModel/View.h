@@ -0,0 +1,182 @@
+/*
+ * This source file is part of one of Jeremy Burgess's samples.
+ *
+ * Copyright (c) 2013 Jeremy Burgess 
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+// Component model
+#include "ComponentPool.h"
+#include "Component.h"
+
+namespace ComponentModel
+{
+	/// Placeholder for the unused component types of a view.
+	struct NoComponent {};
+
+	/**
+	 * \class ViewBase
+	 *
+	 * Joins the active sets of up to three component pools by entity (see ComponentPool). The pool
+	 * with the fewest active components drives the join, and each of its entities is looked up in the
+	 * sparse sets of the others - so a walk costs in proportion to the smallest pool, and never visits
+	 * an entity missing one of the types.
+	 *
+	 * Active sets only change during the synchronise, so a view may be walked from any update. Views
+	 * hold the pools, not the components, so they stay valid across synchronises.
+	 */
+	class ViewBase
+	{
+	public:
+		static const size_t c_maxViewTypes = 3;
+
+		/// Upper bound on the number of entities the view will visit.
+		size_t GetMaxCount() const 
+		{ 
+			return m_isEmpty ? 0 : m_pools[GetDrivingPool()]->GetActiveCount(); 
+		}
+
+	protected:
+		/// Pools are in view order; a null pool (an unregistered type) makes the view empty.
+		ViewBase(ComponentPool* const* pools, size_t poolCount) :
+			m_poolCount(poolCount),
+			m_isEmpty(false)
+		{
+			for (size_t i = 0; i < poolCount; ++i)
+			{
+				m_pools[i] = pools[i];
+				m_isEmpty = m_isEmpty || pools[i] == nullptr;
+			}
+		}
+
+		/// The pool with the fewest active components.
+		size_t GetDrivingPool() const
+		{
+			size_t driver = 0;
+			for (size_t i = 1; i < m_poolCount; ++i)
+			{
+				if (m_pools[i]->GetActiveCount() < m_pools[driver]->GetActiveCount())
+				{
+					driver = i;
+				}
+			}
+			return driver;
+		}
+
+		/// Advances 'cursor' through the driving pool to the next entity with an active component in
+		/// every pool, filling in 'components' in view order. Returns false once the driving pool is done.
+		bool Next(size_t driver, size_t& cursor, Component** components) const
+		{
+			const ComponentPool* driving = m_pools[driver];
+			for (size_t count = driving->GetActiveCount(); cursor < count; )
+			{
+				size_t position = cursor++;
+				size_t entityIndex = driving->GetActiveEntityIndex(position);
+				if (entityIndex == ComponentPool::c_invalidIndex)
+				{
+					continue;
+				}
+
+				bool matched = true;
+				for (size_t i = 0; i < m_poolCount && matched; ++i)
+				{
+					components[i] = m_pools[i]->FindActiveByEntity(entityIndex);
+					matched = components[i] != nullptr;
+				}
+
+				// Skip later components of the same type on one entity, so each entity is visited once.
+				if (matched && components[driver] == driving->GetActiveComponent(position))
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+	protected:
+		ComponentPool* m_pools[c_maxViewTypes];
+		size_t m_poolCount;
+		bool m_isEmpty;
+	};
+
+	/**
+	 * \class View
+	 *
+	 * Iterates every entity which has an active A, B & C, e.g.
+	 *
+	 *		ecm.GetView<Box2DBodyComponent, MoveableQuadComponent>().ForEach(
+	 *			[](Box2DBodyComponent* body, MoveableQuadComponent* quad) { ... });
+	 *
+	 * Obtain views from EntityComponentManager::GetView. Components are matched by exact type, as with
+	 * Entity::GetComponentByTypeFast. Don't make structural changes to the entities viewed while walking.
+	 */
+	template <class A, class B, class C = NoComponent>
+	class View : public ViewBase
+	{
+	public:
+		explicit View(ComponentPool* const* pools) : 
+			ViewBase(pools, 3) 
+		{}
+
+		/// Calls function(A*, B*, C*) for every entity in the view.
+		template <class Function> void ForEach(Function function) const
+		{
+			if (m_isEmpty)
+			{
+				return;
+			}
+
+			Component* components[3];
+			size_t driver = GetDrivingPool();
+			for (size_t cursor = 0; Next(driver, cursor, components); )
+			{
+				function(static_cast<A*>(components[0]), static_cast<B*>(components[1]), static_cast<C*>(components[2]));
+			}
+		}
+	};
+
+	/// View over two component types.
+	template <class A, class B>
+	class View<A, B, NoComponent> : public ViewBase
+	{
+	public:
+		explicit View(ComponentPool* const* pools) : 
+			ViewBase(pools, 2) 
+		{}
+
+		/// Calls function(A*, B*) for every entity in the view.
+		template <class Function> void ForEach(Function function) const
+		{
+			if (m_isEmpty)
+			{
+				return;
+			}
+
+			Component* components[2];
+			size_t driver = GetDrivingPool();
+			for (size_t cursor = 0; Next(driver, cursor, components); )
+			{
+				function(static_cast<A*>(components[0]), static_cast<B*>(components[1]));
+			}
+		}
+	};
+};
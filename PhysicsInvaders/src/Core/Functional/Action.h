@@ -26,6 +26,8 @@
 
 #include "Invoker.h"
 
+#include <algorithm>
+
 namespace Functional
 {
 	namespace Internal
@@ -47,9 +49,12 @@ namespace Functional
 		Action(Internal::Invoker0* invoker) : m_invoker(invoker) {}
 		Action(const Action& other) : m_invoker(other.m_invoker->Clone()) {}
 		~Action() { delete m_invoker; }
+		Action& operator=(const Action& other) { Action copy(other); Swap(copy); return *this; }
+		void Swap(Action& other) { std::swap(m_invoker, other.m_invoker); }
 
 		void operator()() {	m_invoker->Invoke(); }
 		bool operator==(const Action& other) const { return m_invoker->Equals(other.m_invoker); }
+		const void* GetTarget() const { return m_invoker->GetTarget(); }
 	private:
 		Internal::Invoker0* m_invoker;
 	};
@@ -62,9 +67,12 @@ namespace Functional
 		Action(Internal::Invoker1<Arg1>* invoker) : m_invoker(invoker) {}
 		Action(const Action& other) : m_invoker(other.m_invoker->Clone()) {}
 		~Action() { delete m_invoker; }
+		Action& operator=(const Action& other) { Action copy(other); Swap(copy); return *this; }
+		void Swap(Action& other) { std::swap(m_invoker, other.m_invoker); }
 
 		void operator()(Arg1 arg1) { m_invoker->Invoke(arg1); }
 		bool operator==(const Action<Arg1>& other) const { return m_invoker->Equals(other.m_invoker); }
+		const void* GetTarget() const { return m_invoker->GetTarget(); }
 	private:
 		Internal::Invoker1<Arg1>* m_invoker;
 	};
@@ -77,9 +85,12 @@ namespace Functional
 		Action(Internal::Invoker2<Arg1, Arg2>* invoker) : m_invoker(invoker) {}
 		Action(const Action& other) : m_invoker(other.m_invoker->Clone()) {}
 		~Action() { delete m_invoker; }
+		Action& operator=(const Action& other) { Action copy(other); Swap(copy); return *this; }
+		void Swap(Action& other) { std::swap(m_invoker, other.m_invoker); }
 
 		void operator()(Arg1 arg1, Arg2 arg2) { m_invoker->Invoke(arg1, arg2); }
 		bool operator==(const Action<Arg1, Arg2>& other) const { return m_invoker->Equals(other.m_invoker); }
+		const void* GetTarget() const { return m_invoker->GetTarget(); }
 	private:
 		Internal::Invoker2<Arg1, Arg2>* m_invoker;
 	};
@@ -92,9 +103,12 @@ namespace Functional
 		Action(Internal::Invoker3<Arg1, Arg2, Arg3>* invoker) : m_invoker(invoker) {}
 		Action(const Action& other) : m_invoker(other.m_invoker->Clone()) {}
 		~Action() { delete m_invoker; }
+		Action& operator=(const Action& other) { Action copy(other); Swap(copy); return *this; }
+		void Swap(Action& other) { std::swap(m_invoker, other.m_invoker); }
 
 		void operator()(Arg1 arg1, Arg2 arg2, Arg3 arg3) { m_invoker->Invoke(arg1, arg2, arg3); }
 		bool operator==(const Action<Arg1, Arg2, Arg3>& other) const { return m_invoker->Equals(other.m_invoker); }
+		const void* GetTarget() const { return m_invoker->GetTarget(); }
 	private:
 		Internal::Invoker3<Arg1, Arg2, Arg3>* m_invoker;
 	};
@@ -107,12 +121,15 @@ namespace Functional
 		Action(Internal::Invoker4<Arg1, Arg2, Arg3, Arg4>* invoker) : m_invoker(invoker) {}
 		Action(const Action& other) : m_invoker(other.m_invoker->Clone()) {}
 		~Action() { delete m_invoker; }
+		Action& operator=(const Action& other) { Action copy(other); Swap(copy); return *this; }
+		void Swap(Action& other) { std::swap(m_invoker, other.m_invoker); }
 
 		void operator()(Arg1 arg1, Arg2 arg2, Arg3 arg3, Arg4 arg4) { m_invoker->Invoke(arg1, arg2, arg3, arg4); }
 		bool operator==(const Action<Arg1, Arg2, Arg3, Arg4>& other) const 
 		{ 
 			return m_invoker->Equals(other.m_invoker); 
 		}
+		const void* GetTarget() const { return m_invoker->GetTarget(); }
 	private:
 		Internal::Invoker4<Arg1, Arg2, Arg3, Arg4>* m_invoker;
 	};
@@ -40,6 +40,8 @@ namespace Functional
 			virtual void Invoke() = 0;
 			virtual bool Equals(Invoker0* other) const = 0;
 			virtual InvokerType GetInvokerType() const = 0;
+			/// The object the invoker calls into (nullptr for free functions).
+			virtual const void* GetTarget() const = 0;
 			virtual Invoker0* Clone() const = 0;
 		};
 
@@ -50,6 +52,7 @@ namespace Functional
 			virtual void Invoke(Arg1 arg1) = 0;
 			virtual bool Equals(Invoker1* other) const = 0;
 			virtual InvokerType GetInvokerType() const = 0;
+			virtual const void* GetTarget() const = 0;
 			virtual Invoker1* Clone() const = 0;
 		};
 		
@@ -60,6 +63,7 @@ namespace Functional
 			virtual void Invoke(Arg1 arg1, Arg2 arg2) = 0;
 			virtual bool Equals(Invoker2* other) const = 0;
 			virtual InvokerType GetInvokerType() const = 0;
+			virtual const void* GetTarget() const = 0;
 			virtual Invoker2* Clone() const = 0;
 		};
 
@@ -70,6 +74,7 @@ namespace Functional
 			virtual void Invoke(Arg1 arg1, Arg2 arg2, Arg3 arg3) = 0;
 			virtual bool Equals(Invoker3* other) const = 0;
 			virtual InvokerType GetInvokerType() const = 0;
+			virtual const void* GetTarget() const = 0;
 			virtual Invoker3* Clone() const = 0;
 		};
 
@@ -80,6 +85,7 @@ namespace Functional
 			virtual void Invoke(Arg1 arg1, Arg2 arg2, Arg3 arg3, Arg4 arg4) = 0;
 			virtual bool Equals(Invoker4* other) const = 0;
 			virtual InvokerType GetInvokerType() const = 0;
+			virtual const void* GetTarget() const = 0;
 			virtual Invoker4* Clone() const = 0;
 		};
 		
@@ -100,6 +106,7 @@ namespace Functional
 				return false;
 			}
 			virtual InvokerType GetInvokerType() const { return IT_METHOD; }
+			virtual const void* GetTarget() const { return m_caller; }
 			virtual Invoker0* Clone() const { return new MethodInvoker0(m_caller, m_invoke); }
 		private:
 			Caller* m_caller;
@@ -123,6 +130,7 @@ namespace Functional
 				return false;
 			}
 			virtual InvokerType GetInvokerType() const { return IT_METHOD; }
+			virtual const void* GetTarget() const { return m_caller; }
 			virtual Invoker1* Clone() const { return new MethodInvoker1(m_caller, m_invoke); }
 		private:
 			Caller* m_caller;
@@ -146,6 +154,7 @@ namespace Functional
 				return false;
 			}
 			virtual InvokerType GetInvokerType() const { return IT_METHOD; }
+			virtual const void* GetTarget() const { return m_caller; }
 			virtual Invoker2* Clone() const { return new MethodInvoker2(m_caller, m_invoke); }
 		private:
 			Caller* m_caller;
@@ -169,6 +178,7 @@ namespace Functional
 				return false;
 			}
 			virtual InvokerType GetInvokerType() const { return IT_METHOD; }
+			virtual const void* GetTarget() const { return m_caller; }
 			virtual Invoker3* Clone() const { return new MethodInvoker3(m_caller, m_invoke); }
 		private:
 			Caller* m_caller;
@@ -192,6 +202,7 @@ namespace Functional
 				return false;
 			}
 			virtual InvokerType GetInvokerType() const { return IT_METHOD; }
+			virtual const void* GetTarget() const { return m_caller; }
 			virtual Invoker4* Clone() const { return new MethodInvoker4(m_caller, m_invoke); }
 		private:
 			Caller* m_caller;
@@ -214,6 +225,7 @@ namespace Functional
 				return false;
 			}
 			virtual InvokerType GetInvokerType() const { return IT_FUNCTION; }
+			virtual const void* GetTarget() const { return nullptr; }
 			virtual Invoker0* Clone() const { return new FunctionInvoker0(m_invoke); }
 		private:
 			void(*m_invoke)(void);
@@ -236,6 +248,7 @@ namespace Functional
 				return false;
 			}
 			virtual InvokerType GetInvokerType() const { return IT_FUNCTION; }
+			virtual const void* GetTarget() const { return nullptr; }
 			virtual Invoker1* Clone() const { return new FunctionInvoker1(m_invoke); }
 		private:
 			void(*m_invoke)(Arg1);
@@ -258,6 +271,7 @@ namespace Functional
 				return false;
 			}
 			virtual InvokerType GetInvokerType() const { return IT_FUNCTION; }
+			virtual const void* GetTarget() const { return nullptr; }
 			virtual Invoker2* Clone() const { return new FunctionInvoker2(m_invoke); }
 		private:
 			void(*m_invoke)(Arg1, Arg2);
@@ -280,6 +294,7 @@ namespace Functional
 				return false;
 			}
 			virtual InvokerType GetInvokerType() const { return IT_FUNCTION; }
+			virtual const void* GetTarget() const { return nullptr; }
 			virtual Invoker3* Clone() const { return new FunctionInvoker3(m_invoke); }
 		private:
 			void(*m_invoke)(Arg1, Arg2, Arg3);
@@ -302,6 +317,7 @@ namespace Functional
 				return false;
 			}
 			virtual InvokerType GetInvokerType() const { return IT_FUNCTION; }
+			virtual const void* GetTarget() const { return nullptr; }
 			virtual Invoker4* Clone() const { return new FunctionInvoker4(m_invoke); }
 		private:
 			void(*m_invoke)(Arg1, Arg2, Arg3, Arg4);
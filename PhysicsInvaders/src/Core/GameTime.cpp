@@ -67,6 +67,11 @@ AppTicks GameTime::GetStep() const
 	return m_physicsTime->GetStep(); 
 }
 
+float GameTime::GetPhysicsInterpolation() const
+{
+	return (m_gameTime->GetCurrentTime() - m_physicsTime->GetCurrentTime()) / (float)m_physicsTime->GetStep();
+}
+
 void GameTime::FrameStarted()
 {
 	m_realTime->FrameStarted();
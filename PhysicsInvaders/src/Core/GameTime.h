@@ -42,6 +42,8 @@ public:
 	long GetNumStepsThisFrame() const;
 	float GetStepInSeconds() const;
 	AppTicks GetStep() const;
+	/// How far game time is through the current physics step (0 to 1), for interpolating between steps.
+	float GetPhysicsInterpolation() const;
 
 	// Passthrough for scaled time
 	void SetTimeScale(float timeScale);
@@ -0,0 +1,195 @@
+/*
+ * This source file is part of one of Jeremy Burgess's samples.
+ *
+ * Copyright (c) 2013 Jeremy Burgess 
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "WorkerPool.h"
+
+#include <algorithm>
+
+#include <boost/bind.hpp>
+#include <boost/assert.hpp>
+
+size_t TaskGraph::AddTask(const Task& task)
+{
+	Node node;
+	node.m_task = task;
+	node.m_dependencyCount = 0;
+	m_nodes.push_back(node);
+	return m_nodes.size() - 1;
+}
+
+void TaskGraph::AddDependency(size_t before, size_t after)
+{
+	BOOST_ASSERT(before < after && after < m_nodes.size());
+	m_nodes[before].m_successors.push_back(after);
+	++m_nodes[after].m_dependencyCount;
+}
+
+WorkerPool::WorkerPool(size_t workerCount) :
+	m_shutdown(false)
+{
+	for (size_t i = 0; i < workerCount; ++i)
+	{
+		m_workers.create_thread(boost::bind(&WorkerPool::WorkerLoop, this));
+	}
+}
+
+WorkerPool::~WorkerPool()
+{
+	{
+		boost::lock_guard<boost::mutex> lock(m_mutex);
+		m_shutdown = true;
+		m_wake.notify_all();
+	}
+	m_workers.join_all();
+}
+
+size_t WorkerPool::GetDefaultWorkerCount(size_t busyThreads)
+{
+	size_t hardwareThreads = boost::thread::hardware_concurrency();
+	return hardwareThreads > busyThreads ? hardwareThreads - busyThreads : 0;
+}
+
+void WorkerPool::Run(const TaskGraph& graph)
+{
+	if (graph.m_nodes.empty())
+	{
+		return;
+	}
+
+	GraphRun run;
+	run.m_graph = &graph;
+	run.m_batch.m_remaining = graph.m_nodes.size();
+	run.m_pendingDependencies.reserve(graph.m_nodes.size());
+	for (size_t i = 0; i < graph.m_nodes.size(); ++i)
+	{
+		run.m_pendingDependencies.push_back(graph.m_nodes[i].m_dependencyCount);
+	}
+
+	boost::unique_lock<boost::mutex> lock(m_mutex);
+	for (size_t i = 0; i < graph.m_nodes.size(); ++i)
+	{
+		if (run.m_pendingDependencies[i] == 0)
+		{
+			Enqueue(Job(boost::bind(&WorkerPool::RunGraphTask, this, &run, i), &run.m_batch));
+		}
+	}
+	Wait(run.m_batch, lock);
+}
+
+void WorkerPool::ParallelFor(size_t count, size_t minChunkSize, const RangeTask& task)
+{
+	size_t chunkCount = std::min(m_workers.size() + 1, count / std::max<size_t>(minChunkSize, 1));
+	if (chunkCount <= 1)
+	{
+		task(0, count);
+		return;
+	}
+	// Round the chunks up to a multiple of the minimum size (so they start on a multiple of it).
+	size_t alignment = std::max<size_t>(minChunkSize, 1);
+	size_t chunkSize = ((count + chunkCount - 1) / chunkCount + alignment - 1) / alignment * alignment;
+	chunkCount = (count + chunkSize - 1) / chunkSize;
+
+	Batch batch;
+	batch.m_remaining = chunkCount - 1;
+	boost::unique_lock<boost::mutex> lock(m_mutex);
+	for (size_t i = 1; i < chunkCount; ++i)
+	{
+		Enqueue(Job(boost::bind(task, i * chunkSize, std::min(count, (i + 1) * chunkSize)), &batch));
+	}
+	lock.unlock();
+
+	task(0, std::min(count, chunkSize));
+
+	lock.lock();
+	Wait(batch, lock);
+}
+
+void WorkerPool::Enqueue(const Job& job)
+{
+	m_jobs.push_back(job);
+	m_wake.notify_all();
+}
+
+void WorkerPool::ExecuteJob(boost::unique_lock<boost::mutex>& lock)
+{
+	Job job = m_jobs.front();
+	m_jobs.pop_front();
+
+	lock.unlock();
+	job.m_task();
+	lock.lock();
+
+	if (--job.m_batch->m_remaining == 0)
+	{
+		m_wake.notify_all();
+	}
+}
+
+void WorkerPool::Wait(Batch& batch, boost::unique_lock<boost::mutex>& lock)
+{
+	// Help out rather than sit idle - the jobs run needn't be from this batch.
+	while (batch.m_remaining > 0)
+	{
+		if (!m_jobs.empty())
+		{
+			ExecuteJob(lock);
+		}
+		else
+		{
+			m_wake.wait(lock);
+		}
+	}
+}
+
+void WorkerPool::RunGraphTask(GraphRun* run, size_t index)
+{
+	const TaskGraph::Node& node = run->m_graph->m_nodes[index];
+	node.m_task();
+
+	// Successors are queued before this task counts as done, so the batch can't finish early.
+	boost::lock_guard<boost::mutex> lock(m_mutex);
+	for (auto sIt = node.m_successors.begin(); sIt != node.m_successors.end(); ++sIt)
+	{
+		if (--run->m_pendingDependencies[*sIt] == 0)
+		{
+			Enqueue(Job(boost::bind(&WorkerPool::RunGraphTask, this, run, *sIt), &run->m_batch));
+		}
+	}
+}
+
+void WorkerPool::WorkerLoop()
+{
+	boost::unique_lock<boost::mutex> lock(m_mutex);
+	while (!m_shutdown)
+	{
+		if (!m_jobs.empty())
+		{
+			ExecuteJob(lock);
+		}
+		else
+		{
+			m_wake.wait(lock);
+		}
+	}
+}
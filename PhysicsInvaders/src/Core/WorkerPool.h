@@ -0,0 +1,148 @@
+/*
+ * This source file is part of one of Jeremy Burgess's samples.
+ *
+ * Copyright (c) 2013 Jeremy Burgess 
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+// STL
+#include <vector>
+#include <deque>
+
+// Boost
+#include <boost/noncopyable.hpp>
+#include <boost/function.hpp>
+#include <boost/thread.hpp>
+
+/**
+ * \class TaskGraph
+ *
+ * A set of tasks along with the order they must run in - a task is only started once every
+ * task it depends on has finished. Built once, then run by a WorkerPool as often as desired.
+ */
+class TaskGraph
+{
+public:
+	typedef boost::function<void ()> Task;
+	friend class WorkerPool;
+
+public:
+	/// Adds a task, returning its index in the graph.
+	size_t AddTask(const Task& task);
+
+	/// Makes the task at index 'after' wait for the task at index 'before' to finish.
+	/// Dependencies may only point forward (before < after), so a graph can never deadlock.
+	void AddDependency(size_t before, size_t after);
+
+	size_t GetTaskCount() const { return m_nodes.size(); }
+	void Clear() { m_nodes.clear(); }
+
+private:
+	struct Node
+	{
+		Task m_task;
+		std::vector<size_t> m_successors;
+		size_t m_dependencyCount;
+	};
+	std::vector<Node> m_nodes;
+};
+
+/**
+ * \class WorkerPool
+ *
+ * A fixed set of worker threads, which run tasks handed to them by whichever thread calls Run.
+ *
+ * The calling thread doesn't just block - it runs queued tasks itself until everything it
+ * asked for is done. So a pool with no workers simply runs everything on the caller, and a
+ * task may itself Run more work on the pool without starving it.
+ */
+class WorkerPool : public boost::noncopyable
+{
+public:
+	typedef boost::function<void ()> Task;
+	/// Task run over the index range [begin, end)
+	typedef boost::function<void (size_t begin, size_t end)> RangeTask;
+
+public:
+	/// Starts the number of worker threads given.
+	explicit WorkerPool(size_t workerCount);
+	~WorkerPool();
+
+	/// Runs every task in the graph (respecting its dependencies), returning once all are done.
+	void Run(const TaskGraph& graph);
+
+	/// Splits [0, count) into at most one chunk per thread (never smaller than the minimum chunk size
+	/// given), runs the task over every chunk & returns once all are done. The split only depends on
+	/// the count & number of workers, and the caller runs the first chunk itself. Every chunk starts at
+	/// a multiple of the minimum chunk size, so chunks never share a word of a bit array indexed the same way.
+	void ParallelFor(size_t count, size_t minChunkSize, const RangeTask& task);
+
+	size_t GetWorkerCount() const { return m_workers.size(); }
+
+	/// Number of workers which keeps every hardware thread busy, given how many
+	/// threads (including the one which will call Run) the application already keeps busy.
+	static size_t GetDefaultWorkerCount(size_t busyThreads);
+
+private:
+	/// A set of queued tasks, which is done once none remain.
+	struct Batch
+	{
+		size_t m_remaining;
+	};
+
+	/// A queued task & the batch it belongs to.
+	struct Job
+	{
+		Job(const Task& task, Batch* batch) : m_task(task), m_batch(batch) {}
+		Task m_task;
+		Batch* m_batch;
+	};
+
+	/// Book-keeping for one run of a graph.
+	struct GraphRun
+	{
+		const TaskGraph* m_graph;
+		std::vector<size_t> m_pendingDependencies;
+		Batch m_batch;
+	};
+
+	/// Queues a job. The mutex must be held.
+	void Enqueue(const Job& job);
+
+	/// Runs the job at the front of the queue, releasing the lock while it runs.
+	void ExecuteJob(boost::unique_lock<boost::mutex>& lock);
+
+	/// Runs queued jobs until the batch is done.
+	void Wait(Batch& batch, boost::unique_lock<boost::mutex>& lock);
+
+	/// Runs a task in a graph, then queues any tasks which were only waiting on it.
+	void RunGraphTask(GraphRun* run, size_t index);
+
+	void WorkerLoop();
+
+	boost::thread_group m_workers;
+	boost::mutex m_mutex;
+	// Signalled whenever a job is queued or a batch finishes.
+	boost::condition_variable m_wake;
+	std::deque<Job> m_jobs;
+	bool m_shutdown;
+};
@@ -29,15 +29,55 @@
 #include <Box2D/Box2D.h>
 
 // Project headers
-#include "Physics/EigenToBox2D.h"
 #include "Core/GameTime.h"
 #include "Core/ITimeSource.h"
-#include "Utility/Helpers.h"
+#include "Game/GameContext.h"
+#include "ComponentModel/Entity.h"
+
+// Standard library
+#include <algorithm>
+
+using namespace ComponentModel;
+
+// How a body is kept in a snapshot - followed by its fixtures, then its joints.
+struct Box2DBodyRecord
+{
+	b2BodyType m_type;
+	b2Vec2 m_position;
+	float m_angle;
+	b2Vec2 m_linearVelocity;
+	float m_angularVelocity;
+	float m_linearDamping;
+	float m_angularDamping;
+	float m_gravityScale;
+	bool m_awake;
+	bool m_fixedRotation;
+	bool m_bullet;
+	bool m_active;
+	bool m_allowSleep;
+	unsigned int m_fixtureCount;
+};
+
+// How a fixture is kept in a snapshot (only circles & polygons are used, so only they are kept).
+struct Box2DFixtureRecord
+{
+	b2Shape::Type m_shapeType;
+	float m_radius;
+	b2Vec2 m_centre; // Circles
+	unsigned int m_vertexCount; // Polygons
+	b2Vec2 m_vertices[b2_maxPolygonVertices];
+	float m_density;
+	float m_friction;
+	float m_restitution;
+	b2Filter m_filter;
+	bool m_isSensor;
+};
 
 Box2DBodyComponent::Box2DBodyComponent(void) :
 	m_body(nullptr),
 	m_mostRecentPos(b2Vec2_zero),
-	m_previousPos(b2Vec2_zero)
+	m_mostRecentRot(0),
+	m_isRestApplied(false)
 {
 }
 
@@ -53,26 +93,43 @@ void Box2DBodyComponent::ApplyForceToCenter(const b2Vec2& force)
 void Box2DBodyComponent::FirstCoreUpdate(const GameTime& time, const GameContext& /*gameContext*/)
 {
 	m_mostRecentPos = m_body->GetPosition();
-	m_previousPos = m_body->GetPosition();
 	m_mostRecentRot = m_body->GetAngle();
-	m_previousRot = m_mostRecentRot;
 	m_previousPhysicsTime = time.GetPhysicsTime()->GetCurrentTime();
+	m_isRestApplied = false;
+	m_entity->ResetKeyframes(BOX2D_SCALE_FACTOR * m_mostRecentPos.x, BOX2D_SCALE_FACTOR * m_mostRecentPos.y, m_mostRecentRot);
 }
 
 void Box2DBodyComponent::CoreUpdate(const GameTime& time, const GameContext& /*gameContext*/)
 {
 	AppTicks physicsTime = time.GetPhysicsTime()->GetCurrentTime();
-	if (physicsTime != m_previousPhysicsTime)
+	if (physicsTime == m_previousPhysicsTime)
+	{
+		return;
+	}
+	m_previousPhysicsTime = physicsTime;
+
+	// Static & sleeping bodies can still be moved (by SetTransform), so check they really haven't.
+	b2Vec2 pos = m_body->GetPosition();
+	float rot = m_body->GetAngle();
+	bool isAtRest = (m_body->GetType() == b2_staticBody || !m_body->IsAwake()) && pos == m_mostRecentPos && rot == m_mostRecentRot;
+
+	// Once at rest, one more keyframe leaves both keyframes holding the rest transform - after which
+	// interpolating would only rebuild the same transforms, so stop until the body moves again.
+	if (isAtRest && m_isRestApplied)
+	{
+		m_entity->StopKeyframes();
+	}
+	else
 	{
-		m_previousPhysicsTime = physicsTime;
-		m_previousPos = m_mostRecentPos;
-		m_mostRecentPos = m_body->GetPosition();
-		m_previousRot = m_mostRecentRot;
-		m_mostRecentRot = m_body->GetAngle();
+		if (!m_entity->IsKeyframed())
+		{
+			m_entity->ResetKeyframes(BOX2D_SCALE_FACTOR * m_mostRecentPos.x, BOX2D_SCALE_FACTOR * m_mostRecentPos.y, m_mostRecentRot);
+		}
+		m_mostRecentPos = pos;
+		m_mostRecentRot = rot;
+		m_entity->PushKeyframe(BOX2D_SCALE_FACTOR * pos.x, BOX2D_SCALE_FACTOR * pos.y, rot);
 	}
-	float t = (time.GetGameTime()->GetCurrentTime() - time.GetPhysicsTime()->GetCurrentTime()) / (float)time.GetStep();
-	m_entity->SetPosition(EigenToBox2D::Box2DVector2ToEigenVector3(BOX2D_SCALE_FACTOR * Helpers::Lerp<b2Vec2>(m_previousPos, m_mostRecentPos, t), m_entity->GetPosition()[2]));
-	m_entity->SetOrientation(Eigen::Quaternionf(Eigen::AngleAxisf(Helpers::Lerp<float>(m_previousRot, m_mostRecentRot, t), Eigen::Vector3f(0, 0, 1))));
+	m_isRestApplied = isAtRest;
 }
 
 void Box2DBodyComponent::Cleanup(const GameContext& /*gameContext*/)
@@ -84,9 +141,182 @@ void Box2DBodyComponent::Cleanup(const GameContext& /*gameContext*/)
 	}
 }
 
+void Box2DBodyComponent::SaveSnapshot(SnapshotWriter& writer) const
+{
+	writer.Write(m_mostRecentPos);
+	writer.Write(m_mostRecentRot);
+	writer.Write(m_previousPhysicsTime);
+	writer.Write(m_isRestApplied);
+	writer.Write(m_body != nullptr);
+	if (m_body == nullptr)
+	{
+		return;
+	}
+
+	Box2DBodyRecord body;
+	body.m_type = m_body->GetType();
+	body.m_position = m_body->GetPosition();
+	body.m_angle = m_body->GetAngle();
+	body.m_linearVelocity = m_body->GetLinearVelocity();
+	body.m_angularVelocity = m_body->GetAngularVelocity();
+	body.m_linearDamping = m_body->GetLinearDamping();
+	body.m_angularDamping = m_body->GetAngularDamping();
+	body.m_gravityScale = m_body->GetGravityScale();
+	body.m_awake = m_body->IsAwake();
+	body.m_fixedRotation = m_body->IsFixedRotation();
+	body.m_bullet = m_body->IsBullet();
+	body.m_active = m_body->IsActive();
+	body.m_allowSleep = m_body->IsSleepingAllowed();
+	body.m_fixtureCount = 0;
+	for (const b2Fixture* fixture = m_body->GetFixtureList(); fixture != nullptr; fixture = fixture->GetNext())
+	{
+		++body.m_fixtureCount;
+	}
+	writer.Write(body);
+
+	for (const b2Fixture* fixture = m_body->GetFixtureList(); fixture != nullptr; fixture = fixture->GetNext())
+	{
+		Box2DFixtureRecord record = Box2DFixtureRecord();
+		record.m_shapeType = fixture->GetType();
+		record.m_radius = fixture->GetShape()->m_radius;
+		if (record.m_shapeType == b2Shape::e_circle)
+		{
+			record.m_centre = static_cast<const b2CircleShape*>(fixture->GetShape())->m_p;
+		}
+		else if (record.m_shapeType == b2Shape::e_polygon)
+		{
+			const b2PolygonShape* polygon = static_cast<const b2PolygonShape*>(fixture->GetShape());
+			record.m_vertexCount = polygon->GetVertexCount();
+			std::copy(polygon->m_vertices, polygon->m_vertices + polygon->GetVertexCount(), record.m_vertices);
+		}
+		record.m_density = fixture->GetDensity();
+		record.m_friction = fixture->GetFriction();
+		record.m_restitution = fixture->GetRestitution();
+		record.m_filter = fixture->GetFilterData();
+		record.m_isSensor = fixture->IsSensor();
+		writer.Write(record);
+	}
+
+	std::vector<RopeJointRecord> joints;
+	for (const b2JointEdge* edge = m_body->GetJointList(); edge != nullptr; edge = edge->next)
+	{
+		if (edge->joint->GetType() != e_ropeJoint || edge->joint->GetBodyA() != m_body)
+		{
+			continue;
+		}
+		const b2RopeJoint* rope = static_cast<const b2RopeJoint*>(edge->joint);
+		RopeJointRecord joint;
+		joint.m_otherEntity = GetBodyEntityHandle(edge->joint->GetBodyB()).GetValue();
+		joint.m_localAnchorA = rope->GetLocalAnchorA();
+		joint.m_localAnchorB = rope->GetLocalAnchorB();
+		joint.m_maxLength = rope->GetMaxLength();
+		joint.m_collideConnected = rope->GetCollideConnected();
+		joints.push_back(joint);
+	}
+	writer.WriteArray(joints);
+}
+
+void Box2DBodyComponent::LoadSnapshot(SnapshotReader& reader, const GameContext& gameContext)
+{
+	reader.Read(m_mostRecentPos);
+	reader.Read(m_mostRecentRot);
+	reader.Read(m_previousPhysicsTime);
+	reader.Read(m_isRestApplied);
+	m_body = nullptr;
+	m_restoredJoints.clear();
+	if (!reader.Read<bool>())
+	{
+		return;
+	}
+
+	Box2DBodyRecord body;
+	reader.Read(body);
+	b2BodyDef def;
+	def.type = body.m_type;
+	def.position = body.m_position;
+	def.angle = body.m_angle;
+	def.linearVelocity = body.m_linearVelocity;
+	def.angularVelocity = body.m_angularVelocity;
+	def.linearDamping = body.m_linearDamping;
+	def.angularDamping = body.m_angularDamping;
+	def.gravityScale = body.m_gravityScale;
+	def.awake = body.m_awake;
+	def.fixedRotation = body.m_fixedRotation;
+	def.bullet = body.m_bullet;
+	def.active = body.m_active;
+	def.allowSleep = body.m_allowSleep;
+	b2Body* newBody = gameContext.GetBox2DWorld().CreateBody(&def);
+
+	for (unsigned int i = 0; i < body.m_fixtureCount && reader.IsValid(); ++i)
+	{
+		Box2DFixtureRecord record;
+		if (!reader.Read(record))
+		{
+			break;
+		}
+
+		b2CircleShape circle;
+		b2PolygonShape polygon;
+		b2FixtureDef fixDef;
+		if (record.m_shapeType == b2Shape::e_circle)
+		{
+			circle.m_radius = record.m_radius;
+			circle.m_p = record.m_centre;
+			fixDef.shape = &circle;
+		}
+		else if (record.m_shapeType == b2Shape::e_polygon && record.m_vertexCount >= 3 && record.m_vertexCount <= b2_maxPolygonVertices)
+		{
+			polygon.Set(record.m_vertices, record.m_vertexCount);
+			polygon.m_radius = record.m_radius;
+			fixDef.shape = &polygon;
+		}
+		else
+		{
+			continue;
+		}
+		fixDef.density = record.m_density;
+		fixDef.friction = record.m_friction;
+		fixDef.restitution = record.m_restitution;
+		fixDef.filter = record.m_filter;
+		fixDef.isSensor = record.m_isSensor;
+		newBody->CreateFixture(&fixDef);
+	}
+
+	SetBody(newBody);
+	reader.ReadArray(m_restoredJoints);
+}
+
+void Box2DBodyComponent::OnRestored(const GameContext& gameContext)
+{
+	for (auto jointIt = m_restoredJoints.begin(); jointIt != m_restoredJoints.end(); ++jointIt)
+	{
+		Entity* other = ResolveEntityHandle(EntityHandle::FromValue(jointIt->m_otherEntity));
+		Box2DBodyComponent* otherBody = other != nullptr ? other->GetComponentByTypeFast<Box2DBodyComponent>() : nullptr;
+		if (m_body == nullptr || otherBody == nullptr || otherBody->GetBody() == nullptr)
+		{
+			continue;
+		}
+
+		b2RopeJointDef jointDef;
+		jointDef.bodyA = m_body;
+		jointDef.bodyB = otherBody->GetBody();
+		jointDef.localAnchorA = jointIt->m_localAnchorA;
+		jointDef.localAnchorB = jointIt->m_localAnchorB;
+		jointDef.maxLength = jointIt->m_maxLength;
+		jointDef.collideConnected = jointIt->m_collideConnected;
+		gameContext.GetBox2DWorld().CreateJoint(&jointDef);
+	}
+	m_restoredJoints.clear();
+}
+
 void Box2DBodyComponent::SetBody(b2Body* body)
 { 
 	m_body = body;
-	// Allow the body to get back to its entity.
-	m_body->SetUserData(this->m_entity);
+	// Allow the body to get back to its entity - via a handle, so a stale body can't alias a recycled entity.
+	m_body->SetUserData(reinterpret_cast<void*>(static_cast<size_t>(m_entity->GetHandle().GetValue())));
+}
+
+ComponentModel::EntityHandle Box2DBodyComponent::GetBodyEntityHandle(const b2Body* body)
+{
+	return ComponentModel::EntityHandle::FromValue(static_cast<unsigned int>(reinterpret_cast<size_t>(body->GetUserData())));
 }
\ No newline at end of file
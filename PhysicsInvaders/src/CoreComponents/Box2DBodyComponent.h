@@ -33,6 +33,9 @@ class b2Body;
 // Box2D types
 #include <Box2D/Common/b2Math.h>
 
+// Standard library
+#include <vector>
+
 class Box2DBodyComponent : public ComponentModel::Component
 {
 public:
@@ -46,31 +49,64 @@ public:
 	/// Returns a pointer to the body.
 	b2Body* GetBody() const { return m_body; }
 
+	/// Gets the handle of the entity owning a body (stored in the body's user data by SetBody).
+	static ComponentModel::EntityHandle GetBodyEntityHandle(const b2Body* body);
+
 	/// Helper passthrough for b2D method.
 	void ApplyForceToCenter(const b2Vec2& force);
 
-	/// Gets the initial positions.
+	/// Starts keyframing the entity from the body's initial position.
 	virtual void FirstCoreUpdate(const GameTime& time, const GameContext& /*gameContext*/);
 
-	/// Core update propagates changes on the body to the entity.
+	/// Core update pushes a keyframe to the entity for each physics step (the entity manager interpolates
+	/// all of them between steps). Bodies which are static or asleep & haven't moved stop pushing keyframes.
 	virtual void CoreUpdate(const GameTime& time, const GameContext& /*gameContext*/);
 	
 	/// Cleans up the component
 	virtual void Cleanup(const GameContext& gameContext);
+
+	/// \name Snapshots
+	/// The body is rebuilt from its definition & fixtures. Rope joints are kept by the body they start from,
+	/// and rebuilt once every body is back.
+	/// @{
+		virtual void SaveSnapshot(ComponentModel::SnapshotWriter& writer) const;
+		virtual void LoadSnapshot(ComponentModel::SnapshotReader& reader, const GameContext& gameContext);
+		virtual void OnRestored(const GameContext& gameContext);
+	/// @}
 public:
 	static bool HasPhysicsUpdate() { return false; }
 	static bool HasCoreUpdate() { return true; }
 	static bool HasRenderUpdate() { return false; }
 	static bool HasSynchroniseRenderData() { return false; }
+	static ComponentModel::DataAccessMask GetReadAccess() { return ComponentModel::DA_PHYSICS; }
+	static ComponentModel::DataAccessMask GetWriteAccess() { return ComponentModel::DA_ENTITY_TRANSFORM; }
+	static bool IsParallelSafe() { return true; }
+	static ComponentModel::SnapshotMode GetSnapshotMode() { return ComponentModel::SM_CUSTOM; }
 
 
+private:
+	/// How a rope joint is kept in a snapshot.
+	struct RopeJointRecord
+	{
+		unsigned int m_otherEntity; // Handle (value) of the entity owning body B
+		b2Vec2 m_localAnchorA;
+		b2Vec2 m_localAnchorB;
+		float m_maxLength;
+		bool m_collideConnected;
+	};
+
 private:
 	b2Body* m_body;
 
+	// The body's transform as of the last keyframe pushed
 	b2Vec2 m_mostRecentPos;
-	b2Vec2 m_previousPos;
 	float m_mostRecentRot;
-	float m_previousRot;
 	AppTicks m_previousPhysicsTime;
+
+	// Whether both of the entity's keyframes hold the transform the body came to rest at
+	bool m_isRestApplied;
+
+	// Joints read from a snapshot, waiting on the other bodies to be restored.
+	std::vector<RopeJointRecord> m_restoredJoints;
 };
 
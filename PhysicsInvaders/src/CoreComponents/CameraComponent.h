@@ -94,6 +94,8 @@ public:
 	static bool HasCoreUpdate() { return false; }
 	static bool HasRenderUpdate() { return false; }
 	static bool HasSynchroniseRenderData() { return true; }
+	static ComponentModel::DataAccessMask GetReadAccess() { return ComponentModel::DA_ENTITY_TRANSFORM; }
+	static ComponentModel::DataAccessMask GetWriteAccess() { return ComponentModel::DA_RENDER_DATA; }
 
 private:
 	/// \name Core properties
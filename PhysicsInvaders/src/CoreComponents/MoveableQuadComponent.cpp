@@ -28,6 +28,7 @@
 // Project headers
 #include "Graphics/MoveableTexturedQuad.h"
 #include "Graphics/QuadRendererD3D.h"
+#include "Graphics/QuadRenderPacket.h"
 
 MoveableQuadComponent::MoveableQuadComponent(void) :
 	m_colour(Eigen::Vector4f::Ones())
@@ -40,14 +41,66 @@ MoveableQuadComponent::~MoveableQuadComponent(void)
 
 void MoveableQuadComponent::SynchroniseRenderData(const GameContext& /*gameContext*/)
 {
-	m_quad->SetPosition(m_entity->GetPosition());
-	m_quad->SetOrientation(m_entity->GetOrientation());	
+	m_quad->SetPosition(m_entity->GetWorldPosition());
+	m_quad->SetOrientation(m_entity->GetWorldOrientation());	
 	m_quad->SetColour(m_colour);
+
+	// Each quad has its own packet (at its position in the pool), so quads can synchronise in parallel.
+	QuadRenderPacket* packet = m_renderer->GetRenderPacket(GetActivePosition());
+	if (packet != nullptr)
+	{
+		m_quad->FillRenderPacket(*packet);
+	}
+}
+
+// Eigen types aren't plain old data, so their coefficients are written.
+template <class EigenType> static void WriteCoefficients(ComponentModel::SnapshotWriter& writer, const EigenType& value)
+{
+	writer.Write(value.data(), value.size() * sizeof(float));
 }
 
-void MoveableQuadComponent::RenderUpdate(const GameTime& /*time*/, const GameContext& /*gameContext*/)
+template <class EigenType> static EigenType ReadCoefficients(ComponentModel::SnapshotReader& reader)
 {
-	m_renderer->AddToRenderList(m_quad);
+	EigenType value;
+	reader.Read(value.data(), value.size() * sizeof(float));
+	return value;
+}
+
+void MoveableQuadComponent::SaveSnapshot(ComponentModel::SnapshotWriter& writer) const
+{
+	writer.Write(m_quad != nullptr);
+	if (m_quad != nullptr)
+	{
+		writer.Write(m_quad->GetTexture());
+		writer.Write(m_quad->GetSizeMode());
+		WriteCoefficients(writer, m_quad->GetSizeScale());
+		WriteCoefficients(writer, m_quad->GetOrientationCenter());
+		WriteCoefficients(writer, m_quad->GetPosition());
+		WriteCoefficients(writer, m_quad->GetOrientation().coeffs());
+		WriteCoefficients(writer, m_quad->GetPositionOffset());
+		WriteCoefficients(writer, m_quad->GetColour());
+	}
+	writer.Write(m_renderer);
+	WriteCoefficients(writer, m_colour);
+}
+
+void MoveableQuadComponent::LoadSnapshot(ComponentModel::SnapshotReader& reader, const GameContext& /*gameContext*/)
+{
+	m_quad = nullptr;
+	if (reader.Read<bool>())
+	{
+		// The base size comes from the texture & size mode, so setting those rebuilds it.
+		m_quad = new MoveableTexturedQuad(reader.Read<const ITexture2D*>());
+		m_quad->SetSizeMode(reader.Read<MoveableTexturedQuad::SizeMode>());
+		m_quad->SetSizeScale(ReadCoefficients<Eigen::Vector2f>(reader));
+		m_quad->SetOrientationCenter(ReadCoefficients<Eigen::Vector2f>(reader));
+		m_quad->SetPosition(ReadCoefficients<Eigen::Vector3f>(reader));
+		m_quad->SetOrientation(Eigen::Quaternionf(ReadCoefficients<Eigen::Vector4f>(reader)));
+		m_quad->SetPositionOffset(ReadCoefficients<Eigen::Vector2f>(reader));
+		m_quad->SetColour(ReadCoefficients<Eigen::Vector4f>(reader));
+	}
+	reader.Read(m_renderer);
+	m_colour = ReadCoefficients<Eigen::Vector4f>(reader);
 }
 
 void MoveableQuadComponent::Cleanup(const GameContext& /*gameContext*/)
@@ -53,23 +53,31 @@ public:
 	/// Sets the renderer to use - really this should not be platform specific.
 	void SetRenderer(QuadRendererD3D* renderer) { m_renderer = renderer; }
 		
-	/// Prop transform changes from the entity to the quad.
+	/// Prop transform changes from the entity to the quad, and write its render packet.
 	virtual void SynchroniseRenderData(const GameContext& /*gameContext*/);
 
-	/// Add the quad to the quad renderer's render queue.
-	virtual void RenderUpdate(const GameTime& time, const GameContext& /*gameContext*/);
-
 	/// Delete the quad
 	virtual void Cleanup(const GameContext& gameContext);
 
 	/// Set colour
 	inline void SetColour(const Eigen::Vector4f& colour) { m_colour = colour; }
 
+	/// \name Snapshots
+	/// The quad is written as its settings (its texture belongs to the texture manager), and rebuilt from them.
+	/// @{
+		virtual void SaveSnapshot(ComponentModel::SnapshotWriter& writer) const;
+		virtual void LoadSnapshot(ComponentModel::SnapshotReader& reader, const GameContext& /*gameContext*/);
+	/// @}
+
 public:
 	static bool HasPhysicsUpdate() { return false; }
 	static bool HasCoreUpdate() { return false; }
-	static bool HasRenderUpdate() { return true; }
+	static bool HasRenderUpdate() { return false; }
 	static bool HasSynchroniseRenderData() { return true; }
+	static ComponentModel::DataAccessMask GetReadAccess() { return ComponentModel::DA_ENTITY_TRANSFORM; }
+	static ComponentModel::DataAccessMask GetWriteAccess() { return ComponentModel::DA_RENDER_DATA; }
+	static bool IsParallelSafe() { return true; }
+	static ComponentModel::SnapshotMode GetSnapshotMode() { return ComponentModel::SM_CUSTOM; }
 
 private:
 	MoveableTexturedQuad* m_quad;
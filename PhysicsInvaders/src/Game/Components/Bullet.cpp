@@ -47,23 +47,56 @@ void Bullet::Initialise(const GameContext& gameContext)
 {
 	m_dead = false;
 	m_hitType = BHT_NONE;
-	m_body = m_entity->GetComponentByType<Box2DBodyComponent>()->GetBody();
+	Subscribe(gameContext);
+}
+
+void Bullet::Subscribe(const GameContext& gameContext)
+{
+	m_body = m_entity->GetComponentByTypeFast<Box2DBodyComponent>()->GetBody();
 	GameMessageHub::PhysicsInterestRegistration interest;
 	interest.m_bodyOfInterest = m_body;
-	gameContext.GetMessageHub().SubscribeContactStartEvent(interest, Functional::Creator::CreateAction(this, &Bullet::OnCollide));
-	gameContext.GetMessageHub().SubscribeGameEvent(GameEventTypes::GE_ALL_INVADERS_DESTROYED, Functional::Creator::CreateAction(this, &Bullet::OnAllInvadersDestroyed));
-	
+	GameMessageHub& hub = gameContext.GetMessageHub();
+	m_collideSubscription.Reset(hub, hub.SubscribeContactStartEvent(interest, Functional::Creator::CreateAction(this, &Bullet::OnCollide)));
+	m_allInvadersDestroyedSubscription.Reset(hub, hub.SubscribeGameEvent(GameEventTypes::GE_ALL_INVADERS_DESTROYED, Functional::Creator::CreateAction(this, &Bullet::OnAllInvadersDestroyed)));
 }
 
 void Bullet::Cleanup(const GameContext& gameContext)
 {
-	GameMessageHub::PhysicsInterestRegistration interest;
-	interest.m_bodyOfInterest = m_body;
-	gameContext.GetMessageHub().UnsubscribeContactStartEvent(interest, Functional::Creator::CreateAction(this, &Bullet::OnCollide));
-	gameContext.GetMessageHub().UnsubscribeGameEvent(GameEventTypes::GE_ALL_INVADERS_DESTROYED, Functional::Creator::CreateAction(this, &Bullet::OnAllInvadersDestroyed));
+	m_collideSubscription.Reset();
+	m_allInvadersDestroyedSubscription.Reset();
+	BulkCleanup(gameContext);
+}
+
+void Bullet::BulkCleanup(const GameContext& /*gameContext*/)
+{
+	m_collideSubscription.Release();
+	m_allInvadersDestroyedSubscription.Release();
 	m_body = nullptr;
 }
 
+void Bullet::SaveSnapshot(ComponentModel::SnapshotWriter& writer) const
+{
+	writer.Write(m_speed);
+	writer.Write(m_damage);
+	writer.Write(m_dead);
+	writer.Write(m_ownerType);
+	writer.Write(m_hitType);
+}
+
+void Bullet::LoadSnapshot(ComponentModel::SnapshotReader& reader, const GameContext& /*gameContext*/)
+{
+	reader.Read(m_speed);
+	reader.Read(m_damage);
+	reader.Read(m_dead);
+	reader.Read(m_ownerType);
+	reader.Read(m_hitType);
+}
+
+void Bullet::OnRestored(const GameContext& gameContext)
+{
+	Subscribe(gameContext);
+}
+
 void Bullet::PhysicsUpdate(const GameTime& time, const GameContext& /*gameContext*/)
 {
 	b2Vec2 pos = m_body->GetPosition();
@@ -32,6 +32,9 @@ struct PhysicsContactEvent;
 // Game event types
 #include "Game/Messaging/GameEventTypes.h"
 
+// Message hub (for subscriptions)
+#include "Game/Messaging/GameMessageHub.h"
+
 class Bullet : public ComponentModel::Component
 {
 public:
@@ -57,6 +60,16 @@ public:
 	
 	/// Nullifies all internal refs
 	virtual void Cleanup(const GameContext& gameContext);
+
+	/// Cleanup for a world reset (the pool has already dropped our subscriptions)
+	virtual void BulkCleanup(const GameContext& gameContext);
+
+	/// \name Snapshots
+	/// @{
+		virtual void SaveSnapshot(ComponentModel::SnapshotWriter& writer) const;
+		virtual void LoadSnapshot(ComponentModel::SnapshotReader& reader, const GameContext& /*gameContext*/);
+		virtual void OnRestored(const GameContext& gameContext);
+	/// @}
 		
 	/// Moves the bullet, or destroys it when necessary.
 	virtual void PhysicsUpdate(const GameTime& time, const GameContext& /*gameContext*/);
@@ -78,8 +91,12 @@ public:
 	static bool HasCoreUpdate() { return false; }
 	static bool HasRenderUpdate() { return false; }
 	static bool HasSynchroniseRenderData() { return false; }
+	static ComponentModel::DataAccessMask GetReadAccess() { return ComponentModel::DA_MESSAGE_HUB; }
+	static ComponentModel::DataAccessMask GetWriteAccess() { return ComponentModel::DA_PHYSICS; }
+	static ComponentModel::SnapshotMode GetSnapshotMode() { return ComponentModel::SM_CUSTOM; }
 
 private:
+	void Subscribe(const GameContext& gameContext);
 	void OnCollide(const PhysicsContactEvent& contactEvent);
 	void OnAllInvadersDestroyed(GameEventTypes::GameEvent, ComponentModel::Entity*);
 	bool TestBoundary(float currY);
@@ -88,6 +105,10 @@ private:
 	// Body (for collision events)
 	b2Body* m_body;
 
+	// Subscriptions
+	ScopedSubscription m_collideSubscription;
+	ScopedSubscription m_allInvadersDestroyedSubscription;
+
 	// Speed for the bullet
 	float m_speed;
 
@@ -32,6 +32,7 @@
 #include "Core/Functional/Action.h"
 #include "Core/GameTime.h"
 #include "Game/GameContext.h"
+#include "ComponentModel/EntityComponentManager.h"
 #include "Game/Messaging/PhysicsContactEvent.h"
 #include "Game/Messaging/GameMessageHub.h"
 #include "Game/Physics/GamePhysicsConstants.h"
@@ -46,44 +47,68 @@ Invader::Invader() :
 	m_config(0, 10, 0, 0),
 	m_isPowered(false),
 	m_isConnectedToRoot(false),
-	m_bullet(nullptr),
 	m_image(nullptr)
 {}
 
 void Invader::Initialise(const GameContext& gameContext)
+{
+	m_fireThisFrame = false;
+	m_bullet = ComponentModel::EntityHandle();
+	m_bulletDead = false;
+	m_levelUp = false;
+
+	Subscribe(gameContext);
+}
+
+void Invader::Subscribe(const GameContext& gameContext)
 {
 	// Get cached items.
 	m_body = m_entity->GetComponentByTypeFast<Box2DBodyComponent>()->GetBody();
 	m_image = m_entity->GetComponentByTypeFast<MoveableQuadComponent>();
 	
 	// Register for events.
+	GameMessageHub& hub = gameContext.GetMessageHub();
 	GameMessageHub::PhysicsInterestRegistration interest;
 	interest.m_bodyOfInterest = m_body;
-	gameContext.GetMessageHub().SubscribeContactStartEvent(interest, Functional::Creator::CreateAction(this, &Invader::OnCollide));
+	interest.m_otherLayersOfInterest = GamePhysicsConstants::c_playerBulletLayer | GamePhysicsConstants::c_floorLayer | GamePhysicsConstants::c_playerTurretLayer;
+	m_collideSubscription.Reset(hub, hub.SubscribeContactStartEvent(interest, Functional::Creator::CreateAction(this, &Invader::OnCollide)));
 	for (auto invIt = m_connectedInvaders.begin(); invIt != m_connectedInvaders.end(); ++invIt)
 	{
-		gameContext.GetMessageHub().SubscribeGameEvent(m_invaderMap[(*invIt)], Functional::Creator::CreateAction(this, &Invader::OnConnectedInvaderEvent)); 
+		ConnectedInvader& connected = m_invaderMap[(*invIt)];
+		if (ComponentModel::Entity* invaderEntity = gameContext.GetComponentManager().ResolveHandle(connected.m_handle))
+		{
+			connected.m_subscription = hub.SubscribeGameEvent(invaderEntity, Functional::Creator::CreateAction(this, &Invader::OnConnectedInvaderEvent)); 
+		}
+	}
+	if (ComponentModel::Entity* bullet = gameContext.GetComponentManager().ResolveHandle(m_bullet))
+	{
+		m_bulletSubscription.Reset(hub, hub.SubscribeGameEvent(bullet, Functional::Creator::CreateAction(this, &Invader::OnBulletDiedEvent)));
 	}
-
-	m_fireThisFrame = false;
-	m_bullet = nullptr;
-	m_bulletDead = false;
-	m_levelUp = false;
 }
 
 void Invader::Cleanup(const GameContext& gameContext)
 {
 	// Unregister all events.
-	GameMessageHub::PhysicsInterestRegistration interest;
-	interest.m_bodyOfInterest = m_body;
-	gameContext.GetMessageHub().UnsubscribeContactStartEvent(interest, Functional::Creator::CreateAction(this, &Invader::OnCollide));
-	for (auto invIt = m_connectedInvaders.begin(); invIt != m_connectedInvaders.end(); ++invIt)
+	m_collideSubscription.Reset();
+	for (auto invIt = m_invaderMap.begin(); invIt != m_invaderMap.end(); ++invIt)
 	{
-		gameContext.GetMessageHub().UnsubscribeGameEvent(m_invaderMap[(*invIt)], Functional::Creator::CreateAction(this, &Invader::OnConnectedInvaderEvent)); 
+		// Invaders which have already been recycled took their subscriptions with them (so the token does nothing).
+		gameContext.GetMessageHub().Unsubscribe(invIt->second.m_subscription);
 	}
 	
 	// If the bullet is not null, unregister
-	UnregisterBullet(gameContext.GetMessageHub());
+	UnregisterBullet(gameContext);
+
+	BulkCleanup(gameContext);
+}
+
+void Invader::BulkCleanup(const GameContext& /*gameContext*/)
+{
+	// Forget the bullet, and any subscriptions (the pool has dropped them already).
+	m_bulletDead = false;
+	m_bullet = ComponentModel::EntityHandle();
+	m_collideSubscription.Release();
+	m_bulletSubscription.Release();
 
 	// Nullify pointers.
 	m_body = nullptr;
@@ -97,26 +122,80 @@ void Invader::Cleanup(const GameContext& gameContext)
 	m_isConnectedToRoot = false;
 }
 
+void Invader::SaveSnapshot(ComponentModel::SnapshotWriter& writer) const
+{
+	writer.Write(m_config);
+	writer.Write(m_health);
+	writer.Write(m_isConnectedToRoot);
+	writer.Write(m_isPowered);
+	writer.Write(m_fireThisFrame);
+	writer.Write(m_bulletDead);
+	writer.Write(m_levelUp);
+	writer.Write(m_deathCause);
+	writer.Write(m_bullet);
+
+	std::vector<ComponentModel::EntityHandle> connectedHandles;
+	for (auto invIt = m_connectedInvaders.begin(); invIt != m_connectedInvaders.end(); ++invIt)
+	{
+		connectedHandles.push_back(m_invaderMap.find(*invIt)->second.m_handle);
+	}
+	writer.WriteArray(m_connectedInvaders);
+	writer.WriteArray(connectedHandles);
+	writer.WriteArray(std::vector<Invader*>(m_destroyedInvaders.begin(), m_destroyedInvaders.end()));
+}
+
+void Invader::LoadSnapshot(ComponentModel::SnapshotReader& reader, const GameContext& /*gameContext*/)
+{
+	reader.Read(m_config);
+	reader.Read(m_health);
+	reader.Read(m_isConnectedToRoot);
+	reader.Read(m_isPowered);
+	reader.Read(m_fireThisFrame);
+	reader.Read(m_bulletDead);
+	reader.Read(m_levelUp);
+	reader.Read(m_deathCause);
+	reader.Read(m_bullet);
+
+	std::vector<ComponentModel::EntityHandle> connectedHandles;
+	reader.ReadArray(m_connectedInvaders);
+	reader.ReadArray(connectedHandles);
+	m_invaderMap.clear();
+	for (size_t i = 0; i < m_connectedInvaders.size() && i < connectedHandles.size(); ++i)
+	{
+		m_invaderMap[m_connectedInvaders[i]].m_handle = connectedHandles[i];
+	}
+	std::vector<Invader*> destroyedInvaders;
+	reader.ReadArray(destroyedInvaders);
+	m_destroyedInvaders.assign(destroyedInvaders.begin(), destroyedInvaders.end());
+}
+
+void Invader::OnRestored(const GameContext& gameContext)
+{
+	Subscribe(gameContext);
+}
+
 void Invader::CoreUpdate(const GameTime& /*time*/, const GameContext& gameContext)
 {
-	ClearDestroyedInvaders(gameContext.GetMessageHub());
+	ClearDestroyedInvaders(gameContext);
 
 	if (m_health <= 0)
 	{
 		m_entity->Destroy();
 	}
 
-	if (m_fireThisFrame && m_bullet == nullptr)
+	if (m_fireThisFrame && m_bullet.IsNull())
 	{
 		m_bulletDead = false;
-		m_bullet = ShouldBeDataDriven::CreateBullet(m_body, gameContext, false);
-		gameContext.GetMessageHub().SubscribeGameEvent(m_bullet, Functional::Creator::CreateAction(this, &Invader::OnBulletDiedEvent));
+		ComponentModel::Entity* bullet = ShouldBeDataDriven::CreateBullet(m_body, gameContext, false);
+		m_bullet = bullet->GetHandle();
+		GameMessageHub& hub = gameContext.GetMessageHub();
+		m_bulletSubscription.Reset(hub, hub.SubscribeGameEvent(bullet, Functional::Creator::CreateAction(this, &Invader::OnBulletDiedEvent)));
 		m_fireThisFrame = false;
 	}
 
 	if (m_bulletDead)
 	{
-		UnregisterBullet(gameContext.GetMessageHub());
+		UnregisterBullet(gameContext);
 	}
 
 	if (m_levelUp)
@@ -140,7 +219,7 @@ void Invader::SetupInvader(const Invader::InvaderConfig& config)
 // Adds a connected invader
 void Invader::AddConnectedEntity(Invader* invader)
 {
-	m_invaderMap[invader] = invader->m_entity;
+	m_invaderMap[invader].m_handle = invader->m_entity->GetHandle();
 	m_connectedInvaders.push_back(invader);
 }
 
@@ -162,8 +241,8 @@ void Invader::OnCollide(const PhysicsContactEvent& contactEvent)
 	if (m_health > 0 && category == GamePhysicsConstants::c_playerBulletLayer)
 	{
 		// Get the entity from the target, and get the bullet component.
-		ComponentModel::Entity* other = reinterpret_cast<ComponentModel::Entity*>(contactEvent.m_fixtureB->GetBody()->GetUserData());
-		Bullet* ob = other->GetComponentByType<Bullet>();
+		ComponentModel::Entity* other = ResolveEntityHandle(Box2DBodyComponent::GetBodyEntityHandle(contactEvent.m_fixtureB->GetBody()));
+		Bullet* ob = other->GetComponentByTypeFast<Bullet>();
 
 		m_health = (unsigned int)Helpers::Max(0, (int)(m_health - ob->GetDamage()));
 		if (m_health == 0)
@@ -188,13 +267,13 @@ void Invader::OnConnectedInvaderEvent(GameEventTypes::GameEvent event, Component
 	}
 }
 
-void Invader::ClearDestroyedInvaders(GameMessageHub& hub)
+void Invader::ClearDestroyedInvaders(const GameContext& gameContext)
 {
 	for (auto invIt = m_destroyedInvaders.begin(); invIt != m_destroyedInvaders.end(); ++invIt)
 	{
-		// Remove subscription...
+		// Remove subscription (if the entity has already been recycled, it's gone already)...
 		Invader* invader = *invIt;
-		hub.UnsubscribeGameEvent(m_invaderMap[invader], Functional::Creator::CreateAction(this, &Invader::OnConnectedInvaderEvent)); 
+		gameContext.GetMessageHub().Unsubscribe(m_invaderMap[invader].m_subscription);
 		// Stop caring about them.
 		m_connectedInvaders.erase(std::find(m_connectedInvaders.cbegin(), m_connectedInvaders.cend(), invader));
 		m_invaderMap.erase(invader);
@@ -214,11 +293,12 @@ void Invader::OnBulletDiedEvent(GameEventTypes::GameEvent event, ComponentModel:
 	}
 }
 
-void Invader::UnregisterBullet(GameMessageHub& hub)
+void Invader::UnregisterBullet(const GameContext& /*gameContext*/)
 {
-	hub.UnsubscribeGameEvent(m_bullet, Functional::Creator::CreateAction(this, &Invader::OnBulletDiedEvent));
+	// If the bullet has already been recycled its subscriptions went with it, and this does nothing.
+	m_bulletSubscription.Reset();
 	m_bulletDead = false;
-	m_bullet = nullptr;
+	m_bullet = ComponentModel::EntityHandle();
 }
 
 void Invader::LevelUp(const GameContext& gameContext)
@@ -35,6 +35,9 @@ class MoveableQuadComponent;
 // Game event types header
 #include "Game/Messaging/GameEventTypes.h"
 
+// Message hub (for subscriptions)
+#include "Game/Messaging/GameMessageHub.h"
+
 // STL
 #include <vector>
 #include <map>
@@ -76,6 +79,17 @@ public:
 	/// Nullifies all internal refs
 	virtual void Cleanup(const GameContext& gameContext);
 
+	/// Cleanup for a world reset (the pool has already dropped our subscriptions)
+	virtual void BulkCleanup(const GameContext& gameContext);
+
+	/// \name Snapshots
+	/// Connected invaders & the bullet are restored along with us, so keep the same addresses & handles.
+	/// @{
+		virtual void SaveSnapshot(ComponentModel::SnapshotWriter& writer) const;
+		virtual void LoadSnapshot(ComponentModel::SnapshotReader& reader, const GameContext& /*gameContext*/);
+		virtual void OnRestored(const GameContext& gameContext);
+	/// @}
+
 	/// Waits until health drops to 0 (as a result of collisions with
 	/// bullets or walls...), and then kills the invader.
 	virtual void CoreUpdate(const GameTime& time, const GameContext& /*gameContext*/);
@@ -112,13 +126,17 @@ public:
 	static bool HasCoreUpdate() { return true; }
 	static bool HasRenderUpdate() { return false; }
 	static bool HasSynchroniseRenderData() { return false; }
+	static ComponentModel::DataAccessMask GetReadAccess() { return ComponentModel::DA_PHYSICS | ComponentModel::DA_COMPONENT_DATA | ComponentModel::DA_MESSAGE_HUB; }
+	static ComponentModel::DataAccessMask GetWriteAccess() { return ComponentModel::DA_MESSAGE_HUB | ComponentModel::DA_PHYSICS | ComponentModel::DA_COMPONENT_DATA | ComponentModel::DA_RENDER_DATA; }
+	static ComponentModel::SnapshotMode GetSnapshotMode() { return ComponentModel::SM_CUSTOM; }
 
 private:
+	void Subscribe(const GameContext& gameContext);
 	void OnCollide(const PhysicsContactEvent& contactEvent);
 	void OnConnectedInvaderEvent(GameEventTypes::GameEvent, ComponentModel::Entity*);
 	void OnBulletDiedEvent(GameEventTypes::GameEvent, ComponentModel::Entity*);
-	void ClearDestroyedInvaders(GameMessageHub& hub);
-	void UnregisterBullet(GameMessageHub& hub);
+	void ClearDestroyedInvaders(const GameContext& gameContext);
+	void UnregisterBullet(const GameContext& gameContext);
 	void LevelUp(const GameContext& context);
 	float GetCurrentAlpha();
 	
@@ -148,16 +166,29 @@ private:
 	// What killed us
 	DeathCause m_deathCause;
 
+	// What we know about a connected invader.
+	struct ConnectedInvader
+	{
+		// Entity of the invader.
+		ComponentModel::EntityHandle m_handle;
+		// Our subscription to its events.
+		GameMessageHub::Subscription m_subscription;
+	};
+
 	// Vector of other invaders we're connected to
 	std::vector<Invader*> m_connectedInvaders;
 	// Mapping of invaders to entities - destruction order could cause badness, so we need to
 	// actually know which invader maps to which entity.
-	std::map<Invader*, ComponentModel::Entity*> m_invaderMap;
+	std::map<Invader*, ConnectedInvader> m_invaderMap;
 	// List of destroyed invaders so we can safely unsubscribe from them during our update.
 	std::list<Invader*> m_destroyedInvaders;
 
 	// Entity which is the bullet we listen to - we can only have one at a time.
-	ComponentModel::Entity* m_bullet;
+	ComponentModel::EntityHandle m_bullet;
+	
+	// Subscriptions
+	ScopedSubscription m_collideSubscription;
+	ScopedSubscription m_bulletSubscription;
 	
 	// Visual
 	MoveableQuadComponent* m_image;
@@ -54,21 +54,65 @@ void InvaderWaveManager::Initialise(const GameContext& gameContext)
 	// Get cached items.
 	m_recalculatePower = true;
 	
+	Subscribe(gameContext);
+
+	// Zero number of dead invaders
+	m_numberOfDeadInvaders = 0;
+	m_numberOfPoweredInvaders = 0;
+}
+
+void InvaderWaveManager::Subscribe(const GameContext& gameContext)
+{
 	// Register for events.
-	gameContext.GetMessageHub().SubscribeGameEvent(GameEventTypes::GE_ENTITY_DESTROYED, Functional::Creator::CreateAction(this, &InvaderWaveManager::OnEntityDestroyedEvent));
+	GameMessageHub& hub = gameContext.GetMessageHub();
+	m_entityDestroyedSubscription.Reset(hub, hub.SubscribeGameEvent(GameEventTypes::GE_ENTITY_DESTROYED, Functional::Creator::CreateAction(this, &InvaderWaveManager::OnEntityDestroyedEvent)));
 
 	// Cache invader wave mover pointer.
 	m_mover = m_entity->GetComponentByTypeFast<InvaderWaveMover>();
+}
 
-	// Zero number of dead invaders
-	m_numberOfDeadInvaders = 0;
-	m_numberOfPoweredInvaders = 0;
+void InvaderWaveManager::SaveSnapshot(SnapshotWriter& writer) const
+{
+	writer.Write(m_recalculatePower);
+	writer.Write(m_numberOfDeadInvaders);
+	writer.Write(m_numberOfPoweredInvaders);
+	writer.Write(m_currentDifficulty);
+	writer.Write(m_timeLastFired);
+	writer.Write(m_config);
+	std::vector< std::pair<Entity*, Invader*> > invaders(m_entityInvaders.begin(), m_entityInvaders.end());
+	writer.WriteArray(invaders);
+}
+
+void InvaderWaveManager::LoadSnapshot(SnapshotReader& reader, const GameContext& /*gameContext*/)
+{
+	reader.Read(m_recalculatePower);
+	reader.Read(m_numberOfDeadInvaders);
+	reader.Read(m_numberOfPoweredInvaders);
+	reader.Read(m_currentDifficulty);
+	reader.Read(m_timeLastFired);
+	reader.Read(m_config);
+	std::vector< std::pair<Entity*, Invader*> > invaders;
+	reader.ReadArray(invaders);
+	m_entityInvaders.clear();
+	m_entityInvaders.insert(invaders.begin(), invaders.end());
+}
+
+void InvaderWaveManager::OnRestored(const GameContext& gameContext)
+{
+	Subscribe(gameContext);
 }
 
 void InvaderWaveManager::Cleanup(const GameContext& gameContext)
 {
 	// Unregister all events.
-	gameContext.GetMessageHub().UnsubscribeGameEvent(GameEventTypes::GE_ENTITY_DESTROYED, Functional::Creator::CreateAction(this, &InvaderWaveManager::OnEntityDestroyedEvent)); 
+	m_entityDestroyedSubscription.Reset();
+
+	BulkCleanup(gameContext);
+}
+
+void InvaderWaveManager::BulkCleanup(const GameContext& /*gameContext*/)
+{
+	m_entityDestroyedSubscription.Release();
 
 	// Clear data.
 	m_entityInvaders.clear();
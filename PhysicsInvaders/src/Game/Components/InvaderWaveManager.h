@@ -33,6 +33,9 @@ class InvaderWaveMover;
 // Game event types header
 #include "Game/Messaging/GameEventTypes.h"
 
+// Message hub (for subscriptions)
+#include "Game/Messaging/GameMessageHub.h"
+
 // STL
 #include <map>
 
@@ -55,6 +58,17 @@ public:
 	/// Nullifies all internal refs
 	virtual void Cleanup(const GameContext& gameContext);
 
+	/// Cleanup for a world reset (the pool has already dropped our subscriptions)
+	virtual void BulkCleanup(const GameContext& gameContext);
+
+	/// \name Snapshots
+	/// Invader entities & components are restored along with us, so the map is kept as it is.
+	/// @{
+		virtual void SaveSnapshot(ComponentModel::SnapshotWriter& writer) const;
+		virtual void LoadSnapshot(ComponentModel::SnapshotReader& reader, const GameContext& /*gameContext*/);
+		virtual void OnRestored(const GameContext& gameContext);
+	/// @}
+
 	/// Zeros the shoot timer.
 	virtual void FirstCoreUpdate(const GameTime& time, const GameContext& gameContext);
 
@@ -73,8 +87,12 @@ public:
 	static bool HasCoreUpdate() { return true; }
 	static bool HasRenderUpdate() { return false; }
 	static bool HasSynchroniseRenderData() { return false; }
+	static ComponentModel::DataAccessMask GetReadAccess() { return ComponentModel::DA_COMPONENT_DATA | ComponentModel::DA_MESSAGE_HUB; }
+	static ComponentModel::DataAccessMask GetWriteAccess() { return ComponentModel::DA_MESSAGE_HUB | ComponentModel::DA_COMPONENT_DATA; }
+	static ComponentModel::SnapshotMode GetSnapshotMode() { return ComponentModel::SM_CUSTOM; }
 
 private:
+	void Subscribe(const GameContext& gameContext);
 	void OnEntityDestroyedEvent(GameEventTypes::GameEvent, ComponentModel::Entity*);
 	void UpdatePoweredStatus();
 	float GetCurrentFireRate() const;
@@ -86,6 +104,8 @@ private:
 	std::map<ComponentModel::Entity*, Invader*> m_entityInvaders;
 	// Cache of our invader wave mover.
 	InvaderWaveMover* m_mover;
+	// Subscription to entity destruction
+	ScopedSubscription m_entityDestroyedSubscription;
 	// Count of invaders which have died since we began.
 	unsigned int m_numberOfDeadInvaders;
 	// Number of current powered invaders
@@ -39,6 +39,10 @@
 // Box 2D
 #include <Box2D/Box2D.h>
 
+// STL
+#include <vector>
+#include <iterator>
+
 InvaderWaveMover::InvaderWaveMover(void) :
 	m_body(nullptr),
 	m_leftWall(nullptr),
@@ -58,22 +62,33 @@ InvaderWaveMover::~InvaderWaveMover(void)
 void InvaderWaveMover::Initialise(const GameContext& gameContext)
 {
 	m_velocity = b2Vec2_zero;
-	GameMessageHub::PhysicsInterestRegistration interest;
-	interest.m_bodyOfInterest = m_leftWall;
-	gameContext.GetMessageHub().SubscribeContactStartEvent(interest, Functional::Creator::CreateAction(this, &InvaderWaveMover::OnHitLeftWall));
-	interest.m_bodyOfInterest = m_rightWall;
-	gameContext.GetMessageHub().SubscribeContactStartEvent(interest, Functional::Creator::CreateAction(this, &InvaderWaveMover::OnHitRightWall));
-	m_body = m_entity->GetComponentByType<Box2DBodyComponent>();
 	m_currentDifficulty = 0;
+	Subscribe(gameContext);
 }
 
-void InvaderWaveMover::Cleanup(const GameContext& gameContext)
+void InvaderWaveMover::Subscribe(const GameContext& gameContext)
 {
+	GameMessageHub& hub = gameContext.GetMessageHub();
 	GameMessageHub::PhysicsInterestRegistration interest;
+	interest.m_otherLayersOfInterest = GamePhysicsConstants::c_invaderUnitLayer;
 	interest.m_bodyOfInterest = m_leftWall;
-	gameContext.GetMessageHub().UnsubscribeContactStartEvent(interest, Functional::Creator::CreateAction(this, &InvaderWaveMover::OnHitLeftWall));
+	m_leftWallSubscription.Reset(hub, hub.SubscribeContactStartEvent(interest, Functional::Creator::CreateAction(this, &InvaderWaveMover::OnHitLeftWall)));
 	interest.m_bodyOfInterest = m_rightWall;
-	gameContext.GetMessageHub().UnsubscribeContactStartEvent(interest, Functional::Creator::CreateAction(this, &InvaderWaveMover::OnHitRightWall));
+	m_rightWallSubscription.Reset(hub, hub.SubscribeContactStartEvent(interest, Functional::Creator::CreateAction(this, &InvaderWaveMover::OnHitRightWall)));
+	m_body = m_entity->GetComponentByTypeFast<Box2DBodyComponent>();
+}
+
+void InvaderWaveMover::Cleanup(const GameContext& gameContext)
+{
+	m_leftWallSubscription.Reset();
+	m_rightWallSubscription.Reset();
+	BulkCleanup(gameContext);
+}
+
+void InvaderWaveMover::BulkCleanup(const GameContext& /*gameContext*/)
+{
+	m_leftWallSubscription.Release();
+	m_rightWallSubscription.Release();
 	m_body = nullptr;
 	m_leftWall = nullptr;
 	m_rightWall = nullptr;
@@ -87,6 +102,76 @@ void InvaderWaveMover::Cleanup(const GameContext& gameContext)
 	m_config = InvaderMoverConfig();
 }
 
+void InvaderWaveMover::SaveSnapshot(ComponentModel::SnapshotWriter& writer) const
+{
+	writer.Write(m_leftWall != nullptr ? Box2DBodyComponent::GetBodyEntityHandle(m_leftWall) : ComponentModel::EntityHandle());
+	writer.Write(m_rightWall != nullptr ? Box2DBodyComponent::GetBodyEntityHandle(m_rightWall) : ComponentModel::EntityHandle());
+	writer.Write(m_config);
+	writer.Write(m_timeInCurrentPhase);
+	writer.Write(m_velocity);
+	writer.Write(m_currentDifficulty);
+
+	// The current phase is only set once we've been updated.
+	unsigned int currentPhase = static_cast<unsigned int>(m_movementPhases.size());
+	if (GetState() >= CS_FIRSTUPDATED)
+	{
+		currentPhase = static_cast<unsigned int>(std::distance(m_movementPhases.begin(), std::list<MovementPhase*>::const_iterator(m_currentMovementPhase)));
+	}
+	writer.Write(currentPhase);
+	writer.Write(static_cast<unsigned int>(m_movementPhases.size()));
+	for (auto movIt = m_movementPhases.begin(); movIt != m_movementPhases.end(); ++movIt)
+	{
+		(*movIt)->Save(writer);
+	}
+	writer.WriteArray(std::vector<WallContactEvent>(m_wallContactEvents.begin(), m_wallContactEvents.end()));
+}
+
+void InvaderWaveMover::LoadSnapshot(ComponentModel::SnapshotReader& reader, const GameContext& /*gameContext*/)
+{
+	reader.Read(m_restoredLeftWall);
+	reader.Read(m_restoredRightWall);
+	reader.Read(m_config);
+	reader.Read(m_timeInCurrentPhase);
+	reader.Read(m_velocity);
+	reader.Read(m_currentDifficulty);
+
+	unsigned int currentPhase = reader.Read<unsigned int>();
+	unsigned int phaseCount = reader.Read<unsigned int>();
+	for (unsigned int i = 0; i < phaseCount && reader.IsValid(); ++i)
+	{
+		if (MovementPhase* phase = MovementPhase::Load(reader))
+		{
+			m_movementPhases.push_back(phase);
+		}
+	}
+	m_currentMovementPhase = m_movementPhases.begin();
+	for (unsigned int i = 0; i < currentPhase && m_currentMovementPhase != m_movementPhases.end(); ++i)
+	{
+		++m_currentMovementPhase;
+	}
+	if (m_currentMovementPhase == m_movementPhases.end())
+	{
+		m_currentMovementPhase = m_movementPhases.begin();
+	}
+
+	std::vector<WallContactEvent> wallContactEvents;
+	reader.ReadArray(wallContactEvents);
+	m_wallContactEvents.assign(wallContactEvents.begin(), wallContactEvents.end());
+}
+
+void InvaderWaveMover::OnRestored(const GameContext& gameContext)
+{
+	ComponentModel::Entity* leftWall = ResolveEntityHandle(m_restoredLeftWall);
+	ComponentModel::Entity* rightWall = ResolveEntityHandle(m_restoredRightWall);
+	if (leftWall != nullptr && rightWall != nullptr)
+	{
+		SetWalls(leftWall->GetComponentByTypeFast<Box2DBodyComponent>(), rightWall->GetComponentByTypeFast<Box2DBodyComponent>());
+	}
+	m_restoredLeftWall = ComponentModel::EntityHandle();
+	m_restoredRightWall = ComponentModel::EntityHandle();
+	Subscribe(gameContext);
+}
+
 void InvaderWaveMover::FirstCoreUpdate(const GameTime& /*time*/, const GameContext& /*gameContext*/)
 {
 	m_timeInCurrentPhase = 0;
@@ -131,24 +216,19 @@ void InvaderWaveMover::PhysicsUpdate(const GameTime& time, const GameContext& /*
 	}
 }
 
-void InvaderWaveMover::OnHitLeftWall(const PhysicsContactEvent& contactEvent)
+// Only invaders hitting the walls are subscribed to.
+void InvaderWaveMover::OnHitLeftWall(const PhysicsContactEvent& /*contactEvent*/)
 {
-	if (contactEvent.m_fixtureB->GetFilterData().categoryBits == GamePhysicsConstants::c_invaderUnitLayer)
-	{
-		WallContactEvent ev;
-		ev.m_wallWasLeft = true;
-		m_wallContactEvents.push_back(ev);
-	}
+	WallContactEvent ev;
+	ev.m_wallWasLeft = true;
+	m_wallContactEvents.push_back(ev);
 }
 
-void InvaderWaveMover::OnHitRightWall(const PhysicsContactEvent& contactEvent)
+void InvaderWaveMover::OnHitRightWall(const PhysicsContactEvent& /*contactEvent*/)
 {
-	if (contactEvent.m_fixtureB->GetFilterData().categoryBits == GamePhysicsConstants::c_invaderUnitLayer)
-	{
-		WallContactEvent ev;
-		ev.m_wallWasLeft = false;
-		m_wallContactEvents.push_back(ev);
-	}
+	WallContactEvent ev;
+	ev.m_wallWasLeft = false;
+	m_wallContactEvents.push_back(ev);
 }
 
 void InvaderWaveMover::SetWalls(Box2DBodyComponent* leftWall, Box2DBodyComponent* rightWall) 
@@ -173,6 +253,25 @@ float InvaderWaveMover::GetCurrentAcceleration() const
 	return Helpers::Lerp(m_config.m_minMoverAcceleration, m_config.m_maxMoverAcceleration, m_currentDifficulty);
 }
 
+InvaderWaveMover::MovementPhase* InvaderWaveMover::MovementPhase::Load(ComponentModel::SnapshotReader& reader)
+{
+	switch (reader.Read<MovementPhaseType>())
+	{
+	case MPT_PAUSE:
+		return new MovementPhasePause(reader.Read<AppTicks>());
+	case MPT_SIDEWAYS_TO_WALL:
+		return new MovementPhaseSidewaysToWall(reader.Read<bool>());
+	case MPT_DESCEND_BY_DISTANCE:
+		{
+			float distance = reader.Read<float>();
+			float yOnEnter = reader.Read<float>();
+			return new MovementPhaseDescendByDistance(distance, yOnEnter);
+		}
+	default:
+		return nullptr;
+	}
+}
+
 bool InvaderWaveMover::MovementPhasePause::ShouldContinue(const std::list<WallContactEvent>& /*events*/, 
 														  AppTicks timeInPhase, 
 														  InvaderWaveMover* /*mover*/, 
@@ -186,6 +285,12 @@ void InvaderWaveMover::MovementPhasePause::BecomeActive(InvaderWaveMover* mover,
 	mover->m_velocity = b2Vec2_zero;
 }
 
+void InvaderWaveMover::MovementPhasePause::Save(ComponentModel::SnapshotWriter& writer) const
+{
+	writer.Write(MPT_PAUSE);
+	writer.Write(m_timeToPause);
+}
+
 bool InvaderWaveMover::MovementPhaseSidewaysToWall::ShouldContinue(const std::list<WallContactEvent>& events, 
 																   AppTicks /*timeInPhase*/, 
 																   InvaderWaveMover* /*mover*/, 
@@ -220,6 +325,12 @@ void InvaderWaveMover::MovementPhaseSidewaysToWall::DoWork(InvaderWaveMover* mov
 	}
 }
 
+void InvaderWaveMover::MovementPhaseSidewaysToWall::Save(ComponentModel::SnapshotWriter& writer) const
+{
+	writer.Write(MPT_SIDEWAYS_TO_WALL);
+	writer.Write(m_leftWallIsTarget);
+}
+
 bool InvaderWaveMover::MovementPhaseDescendByDistance::ShouldContinue(const std::list<WallContactEvent>& /*events*/, 
 																	  AppTicks /*timeInPhase*/, 
 																	  InvaderWaveMover* /*mover*/, 
@@ -251,3 +362,10 @@ void InvaderWaveMover::MovementPhaseDescendByDistance::DoWork(InvaderWaveMover*
 		mover->m_velocity *= mover->GetCurrentMaxSpeed();
 	}
 }
+
+void InvaderWaveMover::MovementPhaseDescendByDistance::Save(ComponentModel::SnapshotWriter& writer) const
+{
+	writer.Write(MPT_DESCEND_BY_DISTANCE);
+	writer.Write(m_distance);
+	writer.Write(m_yOnEnter);
+}
@@ -32,6 +32,9 @@ class b2Body;
 // Base header
 #include "ComponentModel/Component.h"
 
+// Message hub (for subscriptions)
+#include "Game/Messaging/GameMessageHub.h"
+
 // Box2D types
 #include <Box2D/Common/b2Math.h>
 
@@ -50,10 +53,24 @@ private:
 public:
 	class MovementPhase
 	{
+	public:
+		/// Tags the phases in a snapshot.
+		enum MovementPhaseType
+		{
+			MPT_PAUSE,
+			MPT_SIDEWAYS_TO_WALL,
+			MPT_DESCEND_BY_DISTANCE
+		};
+
 	public:
 		virtual bool ShouldContinue(const std::list<WallContactEvent>& events, AppTicks timeInPhase, InvaderWaveMover* mover, Box2DBodyComponent* body) = 0;
 		virtual void BecomeActive(InvaderWaveMover* mover, Box2DBodyComponent* body) = 0;
 		virtual void DoWork(InvaderWaveMover* mover, Box2DBodyComponent* body, const GameTime& time) = 0;
+
+		/// Writes the phase's type, then its state.
+		virtual void Save(ComponentModel::SnapshotWriter& writer) const = 0;
+		/// Creates a phase from a snapshot (nullptr if the type isn't known).
+		static MovementPhase* Load(ComponentModel::SnapshotReader& reader);
 	};
 	
 	class MovementPhasePause : public MovementPhase
@@ -64,6 +81,7 @@ public:
 		virtual bool ShouldContinue(const std::list<WallContactEvent>& events, AppTicks timeInPhase, InvaderWaveMover* mover, Box2DBodyComponent* body);
 		virtual void BecomeActive(InvaderWaveMover* /*mover*/, Box2DBodyComponent* /*body*/);
 		virtual void DoWork(InvaderWaveMover* /*mover*/, Box2DBodyComponent* /*body*/, const GameTime& /*time*/) {}
+		virtual void Save(ComponentModel::SnapshotWriter& writer) const;
 	private:
 		AppTicks m_timeToPause;
 	};
@@ -76,6 +94,7 @@ public:
 		virtual bool ShouldContinue(const std::list<WallContactEvent>& events, AppTicks timeInPhase, InvaderWaveMover* mover, Box2DBodyComponent* body);
 		virtual void BecomeActive(InvaderWaveMover* /*mover*/, Box2DBodyComponent* /*body*/);
 		virtual void DoWork(InvaderWaveMover* mover, Box2DBodyComponent* body, const GameTime& time);
+		virtual void Save(ComponentModel::SnapshotWriter& writer) const;
 	private:
 		bool m_leftWallIsTarget;
 	};
@@ -83,11 +102,12 @@ public:
 	class MovementPhaseDescendByDistance : public MovementPhase
 	{
 	public:
-		MovementPhaseDescendByDistance(float distance) : m_distance(distance), m_yOnEnter(0) {}
+		MovementPhaseDescendByDistance(float distance, float yOnEnter = 0) : m_distance(distance), m_yOnEnter(yOnEnter) {}
 
 		virtual bool ShouldContinue(const std::list<WallContactEvent>& events, AppTicks timeInPhase, InvaderWaveMover* mover, Box2DBodyComponent* body);
 		virtual void BecomeActive(InvaderWaveMover* mover, Box2DBodyComponent* body);
 		virtual void DoWork(InvaderWaveMover* mover, Box2DBodyComponent* body, const GameTime& time);
+		virtual void Save(ComponentModel::SnapshotWriter& writer) const;
 	private:
 		float m_distance;
 		float m_yOnEnter;
@@ -116,6 +136,17 @@ public:
 	/// Nullifies all internal refs
 	virtual void Cleanup(const GameContext& gameContext);
 
+	/// Cleanup for a world reset (the pool has already dropped our subscriptions)
+	virtual void BulkCleanup(const GameContext& gameContext);
+
+	/// \name Snapshots
+	/// The walls are rebuilt along with us, so they're kept by the handles of their entities.
+	/// @{
+		virtual void SaveSnapshot(ComponentModel::SnapshotWriter& writer) const;
+		virtual void LoadSnapshot(ComponentModel::SnapshotReader& reader, const GameContext& /*gameContext*/);
+		virtual void OnRestored(const GameContext& gameContext);
+	/// @}
+
 	/// Does whatever needs to be done to the invader wave.
 	virtual void PhysicsUpdate(const GameTime& time, const GameContext& /*gameContext*/);
 
@@ -139,8 +170,13 @@ public:
 	static bool HasCoreUpdate() { return false; }
 	static bool HasRenderUpdate() { return false; }
 	static bool HasSynchroniseRenderData() { return false; }
+	static ComponentModel::DataAccessMask GetReadAccess() { return ComponentModel::DA_COMPONENT_DATA | ComponentModel::DA_MESSAGE_HUB; }
+	static ComponentModel::DataAccessMask GetWriteAccess() { return ComponentModel::DA_PHYSICS; }
+	static ComponentModel::SnapshotMode GetSnapshotMode() { return ComponentModel::SM_CUSTOM; }
 
 private:
+	void Subscribe(const GameContext& gameContext);
+
 	/// Callback for contact started events - we listen for all contacts involving invaders.
 	void OnHitLeftWall(const PhysicsContactEvent& contactEvent);
 	void OnHitRightWall(const PhysicsContactEvent& contactEvent);
@@ -153,6 +189,8 @@ private:
 	Box2DBodyComponent* m_body;
 	b2Body* m_leftWall;
 	b2Body* m_rightWall;
+	ScopedSubscription m_leftWallSubscription;
+	ScopedSubscription m_rightWallSubscription;
 	
 	// Invader wave config
 	InvaderMoverConfig m_config;
@@ -168,4 +206,8 @@ private:
 
 	// Wall contact events
 	std::list<WallContactEvent> m_wallContactEvents;
+
+	// Wall entities read from a snapshot, resolved once their bodies are back.
+	ComponentModel::EntityHandle m_restoredLeftWall;
+	ComponentModel::EntityHandle m_restoredRightWall;
 };
\ No newline at end of file
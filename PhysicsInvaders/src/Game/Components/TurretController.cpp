@@ -33,6 +33,7 @@
 #include "Core/ScaledTime.h"
 #include "Utility/ApplicationTime.h"
 #include "Game/GameContext.h"
+#include "ComponentModel/EntityComponentManager.h"
 #include "Game/Messaging/PhysicsContactEvent.h"
 #include "Game/Messaging/GameMessageHub.h"
 #include "Game/Physics/GamePhysicsConstants.h"
@@ -43,7 +44,6 @@
 
 TurretController::TurretController() :
 	m_body(nullptr),
-	m_killingEntity(nullptr),
 	m_image(nullptr),
 	m_numLives(0),
 	m_hitThisFrame(false)
@@ -54,31 +54,70 @@ TurretController::~TurretController()
 
 void TurretController::Initialise(const GameContext& gameContext)
 {
-	m_body = m_entity->GetComponentByTypeFast<Box2DBodyComponent>()->GetBody();
-	m_image = m_entity->GetComponentByTypeFast<MoveableQuadComponent>();
 	m_hitThisFrame = false;
-	m_killingEntity = nullptr;
+	m_killingEntity = ComponentModel::EntityHandle();
 	m_invulnerable = false;
+	Subscribe(gameContext);
+}
+
+void TurretController::Subscribe(const GameContext& gameContext)
+{
+	m_body = m_entity->GetComponentByTypeFast<Box2DBodyComponent>()->GetBody();
+	m_image = m_entity->GetComponentByTypeFast<MoveableQuadComponent>();
 	GameMessageHub::PhysicsInterestRegistration interest;
 	interest.m_bodyOfInterest = m_body;
-	gameContext.GetMessageHub().SubscribeContactStartEvent(interest, Functional::Creator::CreateAction(this, &TurretController::OnCollide));
+	interest.m_otherLayersOfInterest = GamePhysicsConstants::c_invaderUnitLayer | GamePhysicsConstants::c_invaderBulletLayer;
+	GameMessageHub& hub = gameContext.GetMessageHub();
+	m_collideSubscription.Reset(hub, hub.SubscribeContactStartEvent(interest, Functional::Creator::CreateAction(this, &TurretController::OnCollide)));
 }
 
 void TurretController::Cleanup(const GameContext& gameContext)
 {
+	m_collideSubscription.Reset();
+	BulkCleanup(gameContext);
+}
+
+void TurretController::BulkCleanup(const GameContext& /*gameContext*/)
+{
+	m_collideSubscription.Release();
 	m_body = nullptr;
-	m_killingEntity = nullptr;
+	m_killingEntity = ComponentModel::EntityHandle();
 	m_image = nullptr;
-	GameMessageHub::PhysicsInterestRegistration interest;
-	interest.m_bodyOfInterest = m_body;
-	gameContext.GetMessageHub().UnsubscribeContactStartEvent(interest, Functional::Creator::CreateAction(this, &TurretController::OnCollide));	
+}
+
+void TurretController::SaveSnapshot(ComponentModel::SnapshotWriter& writer) const
+{
+	writer.Write(m_killingEntity);
+	writer.Write(m_numLives);
+	writer.Write(m_hitThisFrame);
+	writer.Write(m_waveHitThisFrame);
+	writer.Write(m_invulnerable);
+	writer.Write(m_timeToBecomeVulnerable);
+	writer.Write(m_timeToRemainInvulnerableAfterDying);
+}
+
+void TurretController::LoadSnapshot(ComponentModel::SnapshotReader& reader, const GameContext& /*gameContext*/)
+{
+	reader.Read(m_killingEntity);
+	reader.Read(m_numLives);
+	reader.Read(m_hitThisFrame);
+	reader.Read(m_waveHitThisFrame);
+	reader.Read(m_invulnerable);
+	reader.Read(m_timeToBecomeVulnerable);
+	reader.Read(m_timeToRemainInvulnerableAfterDying);
+}
+
+void TurretController::OnRestored(const GameContext& gameContext)
+{
+	Subscribe(gameContext);
 }
 
 void TurretController::CoreUpdate(const GameTime& time, const GameContext& gameContext)
 {
 	if (m_hitThisFrame)
 	{
-		Die(time, gameContext, m_killingEntity->GetComponentByTypeFast<Invader>() != nullptr);
+		ComponentModel::Entity* killingEntity = gameContext.GetComponentManager().ResolveHandle(m_killingEntity);
+		Die(time, gameContext, killingEntity != nullptr && killingEntity->HasComponent<Invader>());
 	}
 	if (m_invulnerable && m_timeToBecomeVulnerable < time.GetGameTime()->GetCurrentTime())
 	{
@@ -92,7 +131,7 @@ void TurretController::OnCollide(const PhysicsContactEvent& contactEvent)
 	if (!m_hitThisFrame)		
 	{		
 		// Get the entity that hit us
-		ComponentModel::Entity* entity = (ComponentModel::Entity*)(contactEvent.m_fixtureB->GetBody()->GetUserData());
+		ComponentModel::Entity* entity = ResolveEntityHandle(Box2DBodyComponent::GetBodyEntityHandle(contactEvent.m_fixtureB->GetBody()));
 		// If it's an invader, only look at it if it's powered - if it's a bullet, it's always a successful hit.
 		if (category == GamePhysicsConstants::c_invaderUnitLayer)
 		{
@@ -107,7 +146,7 @@ void TurretController::OnCollide(const PhysicsContactEvent& contactEvent)
 		// If we were hit this frame, store the killer.
 		if (m_hitThisFrame)
 		{
-			m_killingEntity = entity;
+			m_killingEntity = entity->GetHandle();
 		}
 	}
 }
@@ -124,7 +163,7 @@ void TurretController::SetInvulnerable(bool vulnerable)
 	if (vulnerable)
 	{
 		m_image->SetColour(Eigen::Vector4f(1, 1, 1, 0.5f));
-		m_killingEntity = nullptr;
+		m_killingEntity = ComponentModel::EntityHandle();
 	}
 	else
 	{
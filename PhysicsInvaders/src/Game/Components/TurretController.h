@@ -32,6 +32,9 @@ class MoveableQuadComponent;
 // Base header
 #include "ComponentModel/Component.h"
 
+// Message hub (for subscriptions)
+#include "Game/Messaging/GameMessageHub.h"
+
 /**
  * Class which manages the state of a user turret. Tracks how many lives the user has,
  * and generates appropriate events when the user is hit.
@@ -48,6 +51,17 @@ public:
 	/// Nullifies all internal refs
 	virtual void Cleanup(const GameContext& gameContext);
 
+	/// Cleanup for a world reset (the pool has already dropped our subscriptions)
+	virtual void BulkCleanup(const GameContext& gameContext);
+
+	/// \name Snapshots
+	/// The invulnerable filter is kept with the body's fixtures, so only our own state is written.
+	/// @{
+		virtual void SaveSnapshot(ComponentModel::SnapshotWriter& writer) const;
+		virtual void LoadSnapshot(ComponentModel::SnapshotReader& reader, const GameContext& /*gameContext*/);
+		virtual void OnRestored(const GameContext& gameContext);
+	/// @}
+
 	/// Does whatever needs to be done to the turret itself.
 	virtual void CoreUpdate(const GameTime& time, const GameContext& /*gameContext*/);
 
@@ -58,15 +72,20 @@ public:
 	void SetTimeToRemainInvulnerableAfterDeath(float time);
 
 	/// Gets the entity that killed us
-	ComponentModel::Entity* GetKillingEntity() const { return m_killingEntity; }
+	ComponentModel::EntityHandle GetKillingEntity() const { return m_killingEntity; }
 
 public:
 	static bool HasPhysicsUpdate() { return false; }
 	static bool HasCoreUpdate() { return true; }
 	static bool HasRenderUpdate() { return false; }
 	static bool HasSynchroniseRenderData() { return false; }
+	static ComponentModel::DataAccessMask GetReadAccess() { return ComponentModel::DA_ENTITY_STRUCTURE | ComponentModel::DA_MESSAGE_HUB; }
+	static ComponentModel::DataAccessMask GetWriteAccess() { return ComponentModel::DA_PHYSICS | ComponentModel::DA_MESSAGE_HUB | ComponentModel::DA_ENTITY_STATE | ComponentModel::DA_COMPONENT_DATA | ComponentModel::DA_RENDER_DATA; }
+	static ComponentModel::SnapshotMode GetSnapshotMode() { return ComponentModel::SM_CUSTOM; }
 
 private:
+	void Subscribe(const GameContext& gameContext);
+
 	/// Sets whether we're currently invulnerable (i.e., we don't die)
 	void SetInvulnerable(bool invulnerable);
 
@@ -77,7 +96,8 @@ private:
 
 private:
 	b2Body* m_body;
-	ComponentModel::Entity* m_killingEntity;
+	ScopedSubscription m_collideSubscription;
+	ComponentModel::EntityHandle m_killingEntity;
 	MoveableQuadComponent* m_image;
 	int m_numLives;
 	bool m_hitThisFrame;
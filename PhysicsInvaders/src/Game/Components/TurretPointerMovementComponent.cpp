@@ -48,11 +48,11 @@ const float MAX_DIST_FOR_TWEEN = 32;
 
 TurretPointerMovementComponent::TurretPointerMovementComponent(void) :
 	m_yoke(nullptr),
-	m_body(nullptr),
-	m_movementMethod(TPMM_DESIRED_LOCATION),
-	m_cameraLeft(0.0f),
-	m_cameraRight(0.0f)
+	m_body(nullptr)
 {
+	m_snapshotState.m_movementMethod = TPMM_DESIRED_LOCATION;
+	m_snapshotState.m_cameraLeft = 0.0f;
+	m_snapshotState.m_cameraRight = 0.0f;
 }
 
 TurretPointerMovementComponent::~TurretPointerMovementComponent(void)
@@ -61,14 +61,14 @@ TurretPointerMovementComponent::~TurretPointerMovementComponent(void)
 
 void TurretPointerMovementComponent::Initialise(const GameContext& gameContext)
 {
-	m_yoke = m_entity->GetComponentByType<TurretYokeComponent>();
+	m_yoke = m_entity->GetComponentByTypeFast<TurretYokeComponent>();
 	m_body = m_entity->GetComponentByTypeFast<Box2DBodyComponent>();
 	// Hardcoded name of camera here. Ideally would get component by type, but for
 	// now just trying to fix coordinate bug
 	ComponentModel::Entity* camera = gameContext.GetComponentManager().FindEntityByName("Camera");
 	CameraComponent* cameraComponent = camera->GetComponentByTypeFast<CameraComponent>();
-	m_cameraLeft = cameraComponent->GetOrthographicRect().m_left;
-	m_cameraRight = cameraComponent->GetOrthographicRect().m_right;
+	m_snapshotState.m_cameraLeft = cameraComponent->GetOrthographicRect().m_left;
+	m_snapshotState.m_cameraRight = cameraComponent->GetOrthographicRect().m_right;
 }
 
 void TurretPointerMovementComponent::Cleanup(const GameContext& /*gameContext*/)
@@ -77,12 +77,18 @@ void TurretPointerMovementComponent::Cleanup(const GameContext& /*gameContext*/)
 	m_yoke = nullptr;
 }
 
+void TurretPointerMovementComponent::OnRestored(const GameContext& /*gameContext*/)
+{
+	m_yoke = m_entity->GetComponentByTypeFast<TurretYokeComponent>();
+	m_body = m_entity->GetComponentByTypeFast<Box2DBodyComponent>();
+}
+
 void TurretPointerMovementComponent::PhysicsUpdate(const GameTime& /*time*/, const GameContext& /*gameContext*/)
 {
 	float targetX = 0.0f;
 	if (InputSystem::IsActive() && InputSystem::GetCurrentPointerState().GetPositionValid())
 	{
-		switch (m_movementMethod)
+		switch (m_snapshotState.m_movementMethod)
 		{
 		case TPMM_SCREEN_EDGE:
 			targetX = GetDesiredXScreenEdge((InputSystem::GetCurrentPointerState().GetXNormalised() * 2) - 1);
@@ -111,8 +117,8 @@ float TurretPointerMovementComponent::GetDesiredXScreenEdge(float currentPointer
 
 float TurretPointerMovementComponent::GetDesiredXDesiredLoc(float currentPointerPosX, float maxX) const
 {
-	float xRange = m_cameraRight - m_cameraLeft;
-	float xPos = (-m_body->GetBody()->GetPosition().x * BOX2D_SCALE_FACTOR) - m_cameraLeft;
+	float xRange = m_snapshotState.m_cameraRight - m_snapshotState.m_cameraLeft;
+	float xPos = (-m_body->GetBody()->GetPosition().x * BOX2D_SCALE_FACTOR) - m_snapshotState.m_cameraLeft;
 	float bodyPos = (xPos / xRange) * maxX;
 	float difference = (currentPointerPosX - bodyPos) / MAX_DIST_FOR_TWEEN;
 	float delta = Helpers::Clamp(difference, -1.f, 1.f);
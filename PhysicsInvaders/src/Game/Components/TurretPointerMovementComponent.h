@@ -54,13 +54,29 @@ public:
 	virtual void PhysicsUpdate(const GameTime& time, const GameContext& /*gameContext*/);
 
 	/// Sets the input method
-	void SetInputMethod(TurretPointerMovementMethod method) { m_movementMethod = method; }
+	void SetInputMethod(TurretPointerMovementMethod method) { m_snapshotState.m_movementMethod = method; }
+
+	/// \name Snapshots
+	/// @{
+		struct SnapshotState
+		{
+			TurretPointerMovementMethod m_movementMethod;
+			float m_cameraLeft;
+			float m_cameraRight;
+		};
+		SnapshotState* GetSnapshotState() { return &m_snapshotState; }
+		const SnapshotState* GetSnapshotState() const { return &m_snapshotState; }
+		virtual void OnRestored(const GameContext& /*gameContext*/);
+	/// @}
 
 public:
 	static bool HasPhysicsUpdate() { return true; }
 	static bool HasCoreUpdate() { return false; }
 	static bool HasRenderUpdate() { return false; }
 	static bool HasSynchroniseRenderData() { return false; }
+	static ComponentModel::DataAccessMask GetReadAccess() { return ComponentModel::DA_INPUT | ComponentModel::DA_PHYSICS | ComponentModel::DA_COMPONENT_DATA; }
+	static ComponentModel::DataAccessMask GetWriteAccess() { return ComponentModel::DA_COMPONENT_DATA; }
+	static ComponentModel::SnapshotMode GetSnapshotMode() { return ComponentModel::SM_BITWISE; }
 
 private:
 	float GetDesiredXScreenEdge(float currentPointerPosX) const;
@@ -69,8 +85,6 @@ private:
 private:
 	TurretYokeComponent* m_yoke;
 	Box2DBodyComponent* m_body;
-	TurretPointerMovementMethod m_movementMethod;
-	float m_cameraLeft;
-	float m_cameraRight;
+	SnapshotState m_snapshotState;
 };
 
@@ -40,11 +40,13 @@
 const float FORCE_TO_APPLY = 50;
 
 TurretYokeComponent::TurretYokeComponent(void) :
-	m_direction(0),
-	m_body(nullptr),
-	m_maxSpeed(1),
-	m_fireDelay(1)
+	m_body(nullptr)
 {
+	m_snapshotState.m_direction = 0;
+	m_snapshotState.m_fire = false;
+	m_snapshotState.m_maxSpeed = 1;
+	m_snapshotState.m_fireDelay = 1;
+	m_snapshotState.m_lastFire = 0;
 }
 
 TurretYokeComponent::~TurretYokeComponent(void)
@@ -53,32 +55,37 @@ TurretYokeComponent::~TurretYokeComponent(void)
 
 void TurretYokeComponent::Initialise(const GameContext& /*gameContext*/)
 {
-	m_body = m_entity->GetComponentByType<Box2DBodyComponent>();
-	m_fire = false;
+	m_body = m_entity->GetComponentByTypeFast<Box2DBodyComponent>();
+	m_snapshotState.m_fire = false;
 }
 
 void TurretYokeComponent::Cleanup(const GameContext& /*gameContext*/)
 {
 	m_body = nullptr;
-	m_maxSpeed = 0;
+	m_snapshotState.m_maxSpeed = 0;
+}
+
+void TurretYokeComponent::OnRestored(const GameContext& /*gameContext*/)
+{
+	m_body = m_entity->GetComponentByTypeFast<Box2DBodyComponent>();
 }
 
 void TurretYokeComponent::FirstCoreUpdate(const GameTime& time, const GameContext& /*gameContext*/)
 {
-	m_lastFire = time.GetPhysicsTime()->GetCurrentTime() - m_fireDelay;
+	m_snapshotState.m_lastFire = time.GetPhysicsTime()->GetCurrentTime() - m_snapshotState.m_fireDelay;
 }
 
 void TurretYokeComponent::PhysicsUpdate(const GameTime& time, const GameContext& gameContext)
 {
 	b2Vec2 speed = m_body->GetBody()->GetLinearVelocity();
-	if (Helpers::Sign(speed.x) != Helpers::Sign(-m_direction) || abs(speed.x) < m_maxSpeed)
+	if (Helpers::Sign(speed.x) != Helpers::Sign(-m_snapshotState.m_direction) || abs(speed.x) < m_snapshotState.m_maxSpeed)
 	{
-		m_body->ApplyForceToCenter(b2Vec2(m_direction * -FORCE_TO_APPLY, 0));
+		m_body->ApplyForceToCenter(b2Vec2(m_snapshotState.m_direction * -FORCE_TO_APPLY, 0));
 	}
-	if (m_fire && time.GetPhysicsTime()->GetCurrentTime() - m_lastFire > m_fireDelay)
+	if (m_snapshotState.m_fire && time.GetPhysicsTime()->GetCurrentTime() - m_snapshotState.m_lastFire > m_snapshotState.m_fireDelay)
 	{
 		ShouldBeDataDriven::CreateBullet(m_body->GetBody(), gameContext, true);
-		m_lastFire = time.GetPhysicsTime()->GetCurrentTime();
+		m_snapshotState.m_lastFire = time.GetPhysicsTime()->GetCurrentTime();
 	}
-	m_fire = false;
+	m_snapshotState.m_fire = false;
 }
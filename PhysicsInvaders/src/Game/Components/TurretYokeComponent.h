@@ -36,10 +36,10 @@ public:
 	~TurretYokeComponent(void);
 	
 	/// Sets the desired direction - -1 for left, 1 for right..
-	void SetDesiredDirection(float direction) { m_direction = direction; }
+	void SetDesiredDirection(float direction) { m_snapshotState.m_direction = direction; }
 
 	/// Sets whether to fire this frame.
-	void Fire() { m_fire = true; }
+	void Fire() { m_snapshotState.m_fire = true; }
 
 	/// Initialises the component
 	virtual void Initialise(const GameContext& gameContext);
@@ -54,23 +54,37 @@ public:
 	virtual void FirstCoreUpdate(const GameTime& time, const GameContext& /*gameContext*/);
 
 	/// Sets the maximum speed of the turret.
-	void SetMaxSpeed(float speed) { m_maxSpeed = speed; }
+	void SetMaxSpeed(float speed) { m_snapshotState.m_maxSpeed = speed; }
 
 	/// Sets how long the turret needs to wait between shots in ticks (milliseconds)
-	void SetFireDelay(AppTicks fireDelay) { m_fireDelay = fireDelay; }
+	void SetFireDelay(AppTicks fireDelay) { m_snapshotState.m_fireDelay = fireDelay; }
+
+	/// \name Snapshots
+	/// @{
+		struct SnapshotState
+		{
+			float m_direction;
+			bool m_fire;
+			float m_maxSpeed;
+			AppTicks m_fireDelay;
+			AppTicks m_lastFire;
+		};
+		SnapshotState* GetSnapshotState() { return &m_snapshotState; }
+		const SnapshotState* GetSnapshotState() const { return &m_snapshotState; }
+		virtual void OnRestored(const GameContext& /*gameContext*/);
+	/// @}
 
 public:
 	static bool HasPhysicsUpdate() { return true; }
 	static bool HasCoreUpdate() { return false; }
 	static bool HasRenderUpdate() { return false; }
 	static bool HasSynchroniseRenderData() { return false; }
+	static ComponentModel::DataAccessMask GetReadAccess() { return ComponentModel::DA_COMPONENT_DATA; }
+	static ComponentModel::DataAccessMask GetWriteAccess() { return ComponentModel::DA_PHYSICS | ComponentModel::DA_RENDER_DATA; }
+	static ComponentModel::SnapshotMode GetSnapshotMode() { return ComponentModel::SM_BITWISE; }
 
 private:
 	Box2DBodyComponent* m_body;
-	float m_direction;
-	bool m_fire;
-	float m_maxSpeed;
-	AppTicks m_fireDelay;
-	AppTicks m_lastFire;
+	SnapshotState m_snapshotState;
 };
 
@@ -43,10 +43,12 @@
 #include "Core/GameTime.h"
 #include "Core/ITimeSource.h"
 #include "Core/StateMachine/ThreadedStateMachine.h"
+#include "Core/WorkerPool.h"
 #include "Input/InputSystem.h"
 
 // Component model.
 #include "ComponentModel/EntityComponentManager.h"
+#include "CoreComponents/MoveableQuadComponent.h"
 
 // Setup/data
 #include "ShouldBeDataDriven/GameSetup.h"
@@ -67,11 +69,23 @@
 #include "Debug/DebugGameTimeController.h"
 #endif
 
+// Update independent component pools concurrently (comment out to compare against serial updates).
+#define ENABLE_PARALLEL_COMPONENT_UPDATES
+
+// Queue messages & pump them at set points in the update (comment out to publish them as they're raised).
+#define ENABLE_QUEUED_MESSAGES
+
+// Dump pool occupancy & churn once a second or so in debug builds, for sizing the pools under load.
+#ifdef BUILD_DEBUG
+#define ENABLE_POOL_STATISTICS_DUMP
+#endif
+
 using namespace ComponentModel;
 using namespace Eigen;
 
 GameWorld::GameWorld(const RendererD3D& renderer, HUDScreen& hud, ProgressScreen& victory, ProgressScreen& defeat) :
-	m_renderer(renderer)
+	m_renderer(renderer),
+	m_workerPool(nullptr)
 {
 	// Create time.
 	m_gameTime = new GameTime();
@@ -82,9 +96,12 @@ GameWorld::GameWorld(const RendererD3D& renderer, HUDScreen& hud, ProgressScreen
 
 	// Create our message hub.
 	m_messageHub = new GameMessageHub(m_box2DWorld);
+#ifdef ENABLE_QUEUED_MESSAGES
+	m_messageHub->SetPublishMode(GameMessageHub::PM_QUEUED);
+#endif
 	
-	// Create our manager
-	m_entityManager = new EntityComponentManager(80);
+	// Create our manager (the entity pool grows if a wave needs more than this)
+	m_entityManager = new EntityComponentManager(80, PCP_GROW);
 
 	// Create the texture manager.
 	m_textureManager = new TextureManager();
@@ -95,6 +112,16 @@ GameWorld::GameWorld(const RendererD3D& renderer, HUDScreen& hud, ProgressScreen
 	// Setup the entity manager
 	m_entityManager->SetGameContext(m_gameContext);
 	ShouldBeDataDriven::SetupEntityManager(m_entityManager);
+
+#ifdef ENABLE_PARALLEL_COMPONENT_UPDATES
+	// The update & render threads are already busy, so only use what's left.
+	m_workerPool = new WorkerPool(WorkerPool::GetDefaultWorkerCount(2));
+	m_entityManager->SetUpdateScheduling(EntityComponentManager::US_PARALLEL, m_workerPool);
+#endif
+
+#ifdef ENABLE_POOL_STATISTICS_DUMP
+	m_entityManager->StartPoolStatisticsDump("PoolStatistics.csv", SF_CSV, 60);
+#endif
 	
 	// State of the game
 	m_stateOfTheGame = new StateOfTheGame(5, 5, *m_messageHub);
@@ -117,8 +144,12 @@ GameWorld::GameWorld(const RendererD3D& renderer, HUDScreen& hud, ProgressScreen
 
 GameWorld::~GameWorld(void)
 {
+	// Report how much of each pool we actually used, so they can be sized sensibly.
+	m_entityManager->LogPoolUsage();
+
 	delete m_stateMachine;
 	delete m_entityManager;
+	delete m_workerPool;
 	delete m_quadRenderer;
 	delete m_stateOfTheGame;
 	delete m_gameStateContext;
@@ -132,15 +163,17 @@ void GameWorld::CoreUpdate()
 	// Update the state machine
 	m_stateMachine->CoreUpdate(m_gameStateContext);
 
-	// Update the physics world
+	// Update the physics world, delivering each step's contacts (and anything else raised) before the next.
 	for (int i = 0; i < m_gameTime->GetNumStepsThisFrame(); ++i)
 	{
 		m_entityManager->PhysicsUpdate(*m_gameTime);
 		m_box2DWorld->Step(1.f/60.f, 8, 2);
+		m_messageHub->Pump();
 	}	
 
-	// Do the core update
+	// Do the core update, then deliver what it raised.
 	m_entityManager->CoreUpdate(*m_gameTime);
+	m_messageHub->Pump();
 }
 
 void GameWorld::RenderUpdate()
@@ -148,7 +181,6 @@ void GameWorld::RenderUpdate()
 	m_stateMachine->RenderUpdate(m_gameStateContext);
 	m_entityManager->RenderUpdate(*m_gameTime);	
 	m_quadRenderer->Render(m_renderer, m_camera);
-	m_quadRenderer->ClearRenderList();
 }
 
 void GameWorld::SynchroniseRenderData()
@@ -160,8 +192,13 @@ void GameWorld::SynchroniseRenderData()
 	// Update gametime
 	m_gameTime->FrameStarted();
 
+	// Quads write their render packets as they synchronise, one per active quad (any written by synchronises 
+	// during the update are dropped, they'll all be written again now).
 	m_stateMachine->SynchroniseRenderData(m_gameStateContext);
+	ComponentModel::ComponentPool* quads = m_entityManager->GetComponentPool<MoveableQuadComponent>();
+	m_quadRenderer->BeginRenderPackets(quads != nullptr ? quads->GetActiveCount() : 0);
 	m_entityManager->SynchroniseRenderData();
+	m_quadRenderer->SwapRenderPackets();
 }
 
 
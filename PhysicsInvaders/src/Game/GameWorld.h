@@ -37,6 +37,7 @@ class GameStateContext;
 class StateOfTheGame;
 class HUDScreen;
 class ProgressScreen;
+class WorkerPool;
 template<typename UpdateArgType>
 class ThreadedStateMachine;
 namespace ComponentModel
@@ -93,6 +94,9 @@ private:
 	// Entity component manager.
 	ComponentModel::EntityComponentManager* m_entityManager;
 
+	// Workers for the entity manager's parallel updates (nullptr if updating serially).
+	WorkerPool* m_workerPool;
+
 	// The camera for this game
 	ICamera* m_camera;
 
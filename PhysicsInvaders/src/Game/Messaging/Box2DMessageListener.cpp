@@ -43,4 +43,9 @@ void Box2DMessageListener::BeginContact(b2Contact* contact)
 void Box2DMessageListener::EndContact(b2Contact* contact)
 {
 	m_messageHub->RaiseContactEndEvent(contact);
+}
+
+void Box2DMessageListener::SayGoodbye(b2Fixture* fixture)
+{
+	m_messageHub->DiscardContactEvents(fixture);
 }
\ No newline at end of file
@@ -33,9 +33,10 @@ class GameMessageHub;
 /**
  * Our implmentation of the Box2D collision event listener. Talks directly
  * to the game message hub. Seperated out so that the game message hub itself
- * does not need to listen to the box 2d world directly.
+ * does not need to listen to the box 2d world directly. Also listens for
+ * fixtures being destroyed, so the hub can drop queued events about them.
  */
-class Box2DMessageListener : public b2ContactListener
+class Box2DMessageListener : public b2ContactListener, public b2DestructionListener
 {
 public:
 	Box2DMessageListener(GameMessageHub* messageHub);
@@ -46,6 +47,12 @@ public:
 		virtual void EndContact(b2Contact* contact);
 	/// @}
 
+	/// \name b2DestructionListener members
+	/// @{
+		virtual void SayGoodbye(b2Joint* /*joint*/) {}
+		virtual void SayGoodbye(b2Fixture* fixture);
+	/// @}
+
 private:
 	GameMessageHub* m_messageHub;
 };
\ No newline at end of file
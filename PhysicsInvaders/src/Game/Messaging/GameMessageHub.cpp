@@ -28,106 +28,334 @@
 
 #include <Box2D/Box2D.h>
 
+#include <algorithm>
+#include <boost/thread/locks.hpp>
+
 GameMessageHub::GameMessageHub(b2World* world) :
-	m_physicsWorld(world)
+	m_physicsWorld(world),
+	m_publishDepth(0),
+	m_publishMode(PM_IMMEDIATE),
+	m_threadBuffer(&GameMessageHub::KeepMessageBuffer)
 {
 	m_messageListener = new Box2DMessageListener(this);
 	m_physicsWorld->SetContactListener(m_messageListener);
+	m_physicsWorld->SetDestructionListener(m_messageListener);
 }
 
 GameMessageHub::~GameMessageHub()
 {
 	m_physicsWorld->SetContactListener(nullptr);
+	m_physicsWorld->SetDestructionListener(nullptr);
+	for (auto bufIt = m_messageBuffers.begin(); bufIt != m_messageBuffers.end(); ++bufIt)
+	{
+		delete *bufIt;
+	}
 }
 
 void GameMessageHub::RaiseContactStartEvent(b2Contact* contact)
 {
-	// Just publish directly for now.
+	if (m_publishMode == PM_QUEUED)
+	{
+		QueueMessage(QM_CONTACT_START, contact->GetFixtureA(), contact->GetFixtureB(), GameEventTypes::GE_ENTITY_DESTROYED, nullptr);
+		return;
+	}
 	PublishContactStartEvent(contact);
 }
 
 void GameMessageHub::RaiseContactEndEvent(b2Contact* contact)
 {
-	// Just publish directly for now.
+	if (m_publishMode == PM_QUEUED)
+	{
+		QueueMessage(QM_CONTACT_END, contact->GetFixtureA(), contact->GetFixtureB(), GameEventTypes::GE_ENTITY_DESTROYED, nullptr);
+		return;
+	}
 	PublishContactEndEvent(contact);
 }
 
 void GameMessageHub::RaiseGameEvent(GameEventTypes::GameEvent gameEvent, ComponentModel::Entity* relevantEntity)
 {
-	// Just publish immediately for now.
+	if (m_publishMode == PM_QUEUED)
+	{
+		QueueMessage(QM_GAME_EVENT, nullptr, nullptr, gameEvent, relevantEntity);
+		return;
+	}
 	PublishGameEvent(gameEvent, relevantEntity);
 }
-	
-void GameMessageHub::SubscribeContactStartEvent(const GameMessageHub::PhysicsInterestRegistration& interestGroup, Functional::Action<const PhysicsContactEvent&> actionToInvoke)
+
+void GameMessageHub::Pump()
 {
-	if (interestGroup.m_bodyOfInterest != nullptr)
+	// Pumping from a listener (e.g. one which resets the world) is left to the pump that's already going.
+	if (m_publishDepth > 0)
 	{
-		m_contactStartActions.m_bodyMap[interestGroup.m_bodyOfInterest].push_back(actionToInvoke);
+		return;
 	}
 
-	if (interestGroup.m_layerOfInterest != 0)
+	// Listeners may raise more messages, so keep going until there aren't any.
+	while (GatherQueuedMessages())
 	{
-		m_contactStartActions.m_layerMap[interestGroup.m_layerOfInterest].push_back(actionToInvoke);
+		// Work out everywhere each message goes, then put the deliveries in receiver order so each
+		// receiver's listeners are looked up once, and called with all of its messages together.
+		m_deliveries.clear();
+		for (unsigned int i = 0; i < m_pumpMessages.size(); ++i)
+		{
+			AddDeliveries(i);
+		}
+		std::sort(m_deliveries.begin(), m_deliveries.end());
+
+		BeginPublish();
+		for (DeliveryIterator delIt = m_deliveries.begin(); delIt != m_deliveries.end(); )
+		{
+			DeliveryIterator groupEnd = delIt + 1;
+			while (groupEnd != m_deliveries.end() && groupEnd->m_table == delIt->m_table && groupEnd->m_key == delIt->m_key)
+			{
+				++groupEnd;
+			}
+			DeliverGroup(delIt, groupEnd);
+			delIt = groupEnd;
+		}
+		EndPublish();
 	}
+	m_pumpMessages.clear();
 }
 
-void GameMessageHub::UnsubscribeContactStartEvent(const GameMessageHub::PhysicsInterestRegistration& interestGroup, Functional::Action<const PhysicsContactEvent&> actionToInvoke)
+void GameMessageHub::DiscardContactEvents(b2Fixture* fixture)
 {
-	if (interestGroup.m_bodyOfInterest != nullptr)
+	// Both the buffers & any batch being pumped (a listener may be what's destroying the fixture).
+	for (auto bufIt = m_messageBuffers.begin(); bufIt != m_messageBuffers.end(); ++bufIt)
 	{
-		m_contactStartActions.m_bodyMap[interestGroup.m_bodyOfInterest].remove(actionToInvoke);
+		for (auto msgIt = (*bufIt)->begin(); msgIt != (*bufIt)->end(); ++msgIt)
+		{
+			if (msgIt->m_fixtureA == fixture || msgIt->m_fixtureB == fixture)
+			{
+				msgIt->m_type = QM_DISCARDED;
+			}
+		}
 	}
-
-	if (interestGroup.m_layerOfInterest != 0)
+	for (auto msgIt = m_pumpMessages.begin(); msgIt != m_pumpMessages.end(); ++msgIt)
 	{
-		m_contactStartActions.m_layerMap[interestGroup.m_layerOfInterest].remove(actionToInvoke);
+		if (msgIt->m_fixtureA == fixture || msgIt->m_fixtureB == fixture)
+		{
+			msgIt->m_type = QM_DISCARDED;
+		}
 	}
 }
+	
+GameMessageHub::Subscription GameMessageHub::SubscribeContactStartEvent(const GameMessageHub::PhysicsInterestRegistration& interestGroup, Functional::Action<const PhysicsContactEvent&> actionToInvoke)
+{
+	return SubscribeContactEvent(m_contactStartActions, Subscription::SK_CONTACT_START, interestGroup, actionToInvoke);
+}
 
-void GameMessageHub::SubscribeContactEndEvent(const GameMessageHub::PhysicsInterestRegistration& interestGroup, Functional::Action<const PhysicsContactEvent&> actionToInvoke)
+void GameMessageHub::UnsubscribeContactStartEvent(const GameMessageHub::PhysicsInterestRegistration& interestGroup, Functional::Action<const PhysicsContactEvent&> actionToInvoke)
 {
+	if (m_publishDepth > 0)
+	{
+		m_deferredChanges.push_back([=]() { UnsubscribeContactStartEvent(interestGroup, actionToInvoke); });
+		return;
+	}
+
 	if (interestGroup.m_bodyOfInterest != nullptr)
 	{
-		m_contactEndActions.m_bodyMap[interestGroup.m_bodyOfInterest].push_back(actionToInvoke);
+		m_contactStartActions.m_bodyMap.Remove(interestGroup.m_bodyOfInterest, ContactListener(actionToInvoke, interestGroup.m_otherLayersOfInterest));
 	}
 
 	if (interestGroup.m_layerOfInterest != 0)
 	{
-		m_contactEndActions.m_layerMap[interestGroup.m_layerOfInterest].push_back(actionToInvoke);
+		m_contactStartActions.m_layerMap.Remove(interestGroup.m_layerOfInterest, ContactListener(actionToInvoke, interestGroup.m_otherLayersOfInterest));
 	}
 }
 
+GameMessageHub::Subscription GameMessageHub::SubscribeContactEndEvent(const GameMessageHub::PhysicsInterestRegistration& interestGroup, Functional::Action<const PhysicsContactEvent&> actionToInvoke)
+{
+	return SubscribeContactEvent(m_contactEndActions, Subscription::SK_CONTACT_END, interestGroup, actionToInvoke);
+}
+
 void GameMessageHub::UnsubscribeContactEndEvent(const GameMessageHub::PhysicsInterestRegistration& interestGroup, Functional::Action<const PhysicsContactEvent&> actionToInvoke)
 {
+	if (m_publishDepth > 0)
+	{
+		m_deferredChanges.push_back([=]() { UnsubscribeContactEndEvent(interestGroup, actionToInvoke); });
+		return;
+	}
+
 	if (interestGroup.m_bodyOfInterest != nullptr)
 	{
-		m_contactEndActions.m_bodyMap[interestGroup.m_bodyOfInterest].remove(actionToInvoke);
+		m_contactEndActions.m_bodyMap.Remove(interestGroup.m_bodyOfInterest, ContactListener(actionToInvoke, interestGroup.m_otherLayersOfInterest));
 	}
 
 	if (interestGroup.m_layerOfInterest != 0)
 	{
-		m_contactEndActions.m_layerMap[interestGroup.m_layerOfInterest].remove(actionToInvoke);
+		m_contactEndActions.m_layerMap.Remove(interestGroup.m_layerOfInterest, ContactListener(actionToInvoke, interestGroup.m_otherLayersOfInterest));
 	}
 }
 
-void GameMessageHub::SubscribeGameEvent(GameEventTypes::GameEvent gameEvent, Functional::Action<GameEventTypes::GameEvent, ComponentModel::Entity*> action)
+GameMessageHub::Subscription GameMessageHub::SubscribeGameEvent(GameEventTypes::GameEvent gameEvent, Functional::Action<GameEventTypes::GameEvent, ComponentModel::Entity*> action)
 {
-	m_gameEventListeners[gameEvent].push_back(action);
+	Subscription subscription;
+	subscription.m_kind = Subscription::SK_GAME_EVENT;
+	subscription.m_first = m_gameEventListeners.Reserve();
+	if (m_publishDepth > 0)
+	{
+		ListenerHandle handle = subscription.m_first;
+		m_deferredChanges.push_back([=]() { m_gameEventListeners.Insert(handle, gameEvent, action); });
+	}
+	else
+	{
+		m_gameEventListeners.Insert(subscription.m_first, gameEvent, action);
+	}
+	return subscription;
 }
 
-void GameMessageHub::SubscribeGameEvent(ComponentModel::Entity* relevantEntity, Functional::Action<GameEventTypes::GameEvent, ComponentModel::Entity*> action)
+GameMessageHub::Subscription GameMessageHub::SubscribeGameEvent(ComponentModel::Entity* relevantEntity, Functional::Action<GameEventTypes::GameEvent, ComponentModel::Entity*> action)
 {
-	m_entityEventListeners[relevantEntity].push_back(action);
+	Subscription subscription;
+	subscription.m_kind = Subscription::SK_ENTITY_EVENT;
+	subscription.m_first = m_entityEventListeners.Reserve();
+	if (m_publishDepth > 0)
+	{
+		ListenerHandle handle = subscription.m_first;
+		m_deferredChanges.push_back([=]() { m_entityEventListeners.Insert(handle, relevantEntity, action); });
+	}
+	else
+	{
+		m_entityEventListeners.Insert(subscription.m_first, relevantEntity, action);
+	}
+	return subscription;
 }
 
 void GameMessageHub::UnsubscribeGameEvent(GameEventTypes::GameEvent gameEvent, Functional::Action<GameEventTypes::GameEvent, ComponentModel::Entity*> action)
 {
-	m_gameEventListeners[gameEvent].remove(action);
+	if (m_publishDepth > 0)
+	{
+		m_deferredChanges.push_back([=]() { UnsubscribeGameEvent(gameEvent, action); });
+		return;
+	}
+
+	m_gameEventListeners.Remove(gameEvent, action);
 }
 
 void GameMessageHub::UnsubscribeGameEvent(ComponentModel::Entity* relevantEntity, Functional::Action<GameEventTypes::GameEvent, ComponentModel::Entity*> action)
 {
-	m_entityEventListeners[relevantEntity].remove(action);
+	if (m_publishDepth > 0)
+	{
+		m_deferredChanges.push_back([=]() { UnsubscribeGameEvent(relevantEntity, action); });
+		return;
+	}
+
+	m_entityEventListeners.Remove(relevantEntity, action);
+}
+
+void GameMessageHub::UnsubscribeAllGameEvents(ComponentModel::Entity* relevantEntity)
+{
+	if (m_publishDepth > 0)
+	{
+		m_deferredChanges.push_back([=]() { UnsubscribeAllGameEvents(relevantEntity); });
+		return;
+	}
+
+	m_entityEventListeners.RemoveKey(relevantEntity);
+}
+
+void GameMessageHub::UnsubscribeAllTargets(const std::vector<const void*>& sortedTargets)
+{
+	if (m_publishDepth > 0)
+	{
+		m_deferredChanges.push_back([=]() { UnsubscribeAllTargets(sortedTargets); });
+		return;
+	}
+
+	if (sortedTargets.empty())
+	{
+		return;
+	}
+
+	m_contactStartActions.m_bodyMap.RemoveTargets(sortedTargets);
+	m_contactStartActions.m_layerMap.RemoveTargets(sortedTargets);
+	m_contactEndActions.m_bodyMap.RemoveTargets(sortedTargets);
+	m_contactEndActions.m_layerMap.RemoveTargets(sortedTargets);
+	m_gameEventListeners.RemoveTargets(sortedTargets);
+	m_entityEventListeners.RemoveTargets(sortedTargets);
+}
+
+void GameMessageHub::Unsubscribe(GameMessageHub::Subscription& subscription)
+{
+	if (subscription.IsNull())
+	{
+		return;
+	}
+
+	if (m_publishDepth > 0)
+	{
+		Subscription removed = subscription;
+		m_deferredChanges.push_back([=]() { RemoveSubscription(removed); });
+	}
+	else
+	{
+		RemoveSubscription(subscription);
+	}
+	subscription = Subscription();
+}
+
+GameMessageHub::Subscription GameMessageHub::SubscribeContactEvent(GameMessageHub::PhysicsEventActionMap& eventMap, GameMessageHub::Subscription::Kind kind, 
+	const GameMessageHub::PhysicsInterestRegistration& interestGroup, const GameMessageHub::ContactAction& action)
+{
+	Subscription subscription;
+	subscription.m_kind = kind;
+	if (interestGroup.m_bodyOfInterest != nullptr)
+	{
+		subscription.m_first = eventMap.m_bodyMap.Reserve();
+	}
+	if (interestGroup.m_layerOfInterest != 0)
+	{
+		subscription.m_second = eventMap.m_layerMap.Reserve();
+	}
+
+	if (m_publishDepth > 0)
+	{
+		PhysicsEventActionMap* deferredMap = &eventMap;
+		m_deferredChanges.push_back([=]() { InsertContactListeners(*deferredMap, subscription, interestGroup, action); });
+	}
+	else
+	{
+		InsertContactListeners(eventMap, subscription, interestGroup, action);
+	}
+	return subscription;
+}
+
+void GameMessageHub::InsertContactListeners(GameMessageHub::PhysicsEventActionMap& eventMap, const GameMessageHub::Subscription& subscription, 
+	const GameMessageHub::PhysicsInterestRegistration& interestGroup, const GameMessageHub::ContactAction& action)
+{
+	ContactListener listener(action, interestGroup.m_otherLayersOfInterest);
+	if (!subscription.m_first.IsNull())
+	{
+		eventMap.m_bodyMap.Insert(subscription.m_first, interestGroup.m_bodyOfInterest, listener);
+	}
+	if (!subscription.m_second.IsNull())
+	{
+		eventMap.m_layerMap.Insert(subscription.m_second, interestGroup.m_layerOfInterest, listener);
+	}
+}
+
+void GameMessageHub::RemoveSubscription(const GameMessageHub::Subscription& subscription)
+{
+	switch (subscription.m_kind)
+	{
+	case Subscription::SK_CONTACT_START:
+		m_contactStartActions.m_bodyMap.Remove(subscription.m_first);
+		m_contactStartActions.m_layerMap.Remove(subscription.m_second);
+		break;
+	case Subscription::SK_CONTACT_END:
+		m_contactEndActions.m_bodyMap.Remove(subscription.m_first);
+		m_contactEndActions.m_layerMap.Remove(subscription.m_second);
+		break;
+	case Subscription::SK_GAME_EVENT:
+		m_gameEventListeners.Remove(subscription.m_first);
+		break;
+	case Subscription::SK_ENTITY_EVENT:
+		m_entityEventListeners.Remove(subscription.m_first);
+		break;
+	default:
+		break;
+	}
 }
 
 void GameMessageHub::PublishContactEvent(b2Contact* contact, GameMessageHub::PhysicsEventActionMap& eventMap)
@@ -136,15 +364,15 @@ void GameMessageHub::PublishContactEvent(b2Contact* contact, GameMessageHub::Phy
 	b2Fixture* fixtureA = contact->GetFixtureA();
 	b2Fixture* fixtureB = contact->GetFixtureB();
 
-	// Create the events
-	PhysicsContactEvent evAB(fixtureA, fixtureB);
-	PhysicsContactEvent evBA(fixtureB, fixtureA);
-
-	// Notify all subscribers.
-	InvokeMappedActions<b2Body*, const PhysicsContactEvent&>(fixtureA->GetBody(), evAB, eventMap.m_bodyMap);
-	InvokeMappedActions<b2Body*, const PhysicsContactEvent&>(fixtureB->GetBody(), evBA, eventMap.m_bodyMap);
-	InvokeMappedActions<unsigned short, const PhysicsContactEvent&>(fixtureA->GetFilterData().categoryBits, evAB, eventMap.m_layerMap);
-	InvokeMappedActions<unsigned short, const PhysicsContactEvent&>(fixtureB->GetFilterData().categoryBits, evBA, eventMap.m_layerMap);
+	// Notify all subscribers (each side's event is only built for listeners interested in the other side).
+	ContactNotifier notifyA(fixtureA, fixtureB);
+	ContactNotifier notifyB(fixtureB, fixtureA);
+	BeginPublish();
+	NotifyContactListeners(eventMap.m_bodyMap.Find(fixtureA->GetBody()), notifyA);
+	NotifyContactListeners(eventMap.m_bodyMap.Find(fixtureB->GetBody()), notifyB);
+	eventMap.m_layerMap.ForEach(fixtureA->GetFilterData().categoryBits, notifyA);
+	eventMap.m_layerMap.ForEach(fixtureB->GetFilterData().categoryBits, notifyB);
+	EndPublish();
 }
 
 void GameMessageHub::PublishContactStartEvent(b2Contact* contact)
@@ -160,6 +388,194 @@ void GameMessageHub::PublishContactEndEvent(b2Contact* contact)
 
 void GameMessageHub::PublishGameEvent(GameEventTypes::GameEvent gameEvent, ComponentModel::Entity* relevantEntity)
 {
+	BeginPublish();
 	InvokeMappedActions(gameEvent, gameEvent, relevantEntity, m_gameEventListeners);
 	InvokeMappedActions(relevantEntity, gameEvent, relevantEntity, m_entityEventListeners);
+	EndPublish();
+}
+
+void GameMessageHub::QueueMessage(GameMessageHub::QueuedMessageType type, b2Fixture* fixtureA, b2Fixture* fixtureB, 
+	GameEventTypes::GameEvent gameEvent, ComponentModel::Entity* entity)
+{
+	QueuedMessage message;
+	message.m_type = type;
+	message.m_gameEvent = gameEvent;
+	message.m_fixtureA = fixtureA;
+	message.m_fixtureB = fixtureB;
+	message.m_entity = entity;
+	GetThreadBuffer()->push_back(message);
+}
+
+GameMessageHub::MessageBuffer* GameMessageHub::GetThreadBuffer()
+{
+	MessageBuffer* buffer = m_threadBuffer.get();
+	if (buffer == nullptr)
+	{
+		// First message from this thread.
+		buffer = new MessageBuffer();
+		m_threadBuffer.reset(buffer);
+		boost::lock_guard<boost::mutex> lock(m_bufferMutex);
+		m_messageBuffers.push_back(buffer);
+	}
+	return buffer;
+}
+
+bool GameMessageHub::GatherQueuedMessages()
+{
+	m_pumpMessages.clear();
+	for (auto bufIt = m_messageBuffers.begin(); bufIt != m_messageBuffers.end(); ++bufIt)
+	{
+		m_pumpMessages.insert(m_pumpMessages.end(), (*bufIt)->begin(), (*bufIt)->end());
+		(*bufIt)->clear();
+	}
+	return !m_pumpMessages.empty();
+}
+
+void GameMessageHub::AddDeliveries(unsigned int messageIndex)
+{
+	// The same places, in the same order, as publishing the message immediately.
+	const QueuedMessage& message = m_pumpMessages[messageIndex];
+	switch (message.m_type)
+	{
+	case QM_CONTACT_START:
+	case QM_CONTACT_END:
+		{
+			bool start = message.m_type == QM_CONTACT_START;
+			DeliveryTable bodyTable = start ? DT_CONTACT_START_BODY : DT_CONTACT_END_BODY;
+			DeliveryTable layerTable = start ? DT_CONTACT_START_LAYER : DT_CONTACT_END_LAYER;
+			AddDelivery(bodyTable, reinterpret_cast<size_t>(message.m_fixtureA->GetBody()), messageIndex, false);
+			AddDelivery(bodyTable, reinterpret_cast<size_t>(message.m_fixtureB->GetBody()), messageIndex, true);
+			AddDelivery(layerTable, message.m_fixtureA->GetFilterData().categoryBits, messageIndex, false);
+			AddDelivery(layerTable, message.m_fixtureB->GetFilterData().categoryBits, messageIndex, true);
+		}
+		break;
+	case QM_GAME_EVENT:
+		AddDelivery(DT_GAME_EVENT, message.m_gameEvent, messageIndex, false);
+		AddDelivery(DT_ENTITY_EVENT, reinterpret_cast<size_t>(message.m_entity), messageIndex, false);
+		break;
+	default:
+		break;
+	}
+}
+
+void GameMessageHub::AddDelivery(GameMessageHub::DeliveryTable table, size_t key, unsigned int messageIndex, bool reversed)
+{
+	Delivery delivery;
+	delivery.m_table = table;
+	delivery.m_key = key;
+	delivery.m_message = messageIndex;
+	delivery.m_reversed = reversed;
+	m_deliveries.push_back(delivery);
+}
+
+void GameMessageHub::DeliverGroup(GameMessageHub::DeliveryIterator first, GameMessageHub::DeliveryIterator last)
+{
+	size_t key = first->m_key;
+	switch (first->m_table)
+	{
+	case DT_CONTACT_START_BODY:
+		DeliverContactEvents(reinterpret_cast<b2Body*>(key), first, last, m_contactStartActions.m_bodyMap);
+		break;
+	case DT_CONTACT_START_LAYER:
+		DeliverContactEvents(static_cast<unsigned short>(key), first, last, m_contactStartActions.m_layerMap);
+		break;
+	case DT_CONTACT_END_BODY:
+		DeliverContactEvents(reinterpret_cast<b2Body*>(key), first, last, m_contactEndActions.m_bodyMap);
+		break;
+	case DT_CONTACT_END_LAYER:
+		DeliverContactEvents(static_cast<unsigned short>(key), first, last, m_contactEndActions.m_layerMap);
+		break;
+	case DT_GAME_EVENT:
+		DeliverGameEvents(static_cast<GameEventTypes::GameEvent>(key), first, last, m_gameEventListeners);
+		break;
+	case DT_ENTITY_EVENT:
+		DeliverGameEvents(reinterpret_cast<ComponentModel::Entity*>(key), first, last, m_entityEventListeners);
+		break;
+	default:
+		break;
+	}
+}
+
+template<typename Key>
+void GameMessageHub::DeliverContactEvents(Key key, GameMessageHub::DeliveryIterator first, GameMessageHub::DeliveryIterator last, ListenerTable<Key, GameMessageHub::ContactListener>& map)
+{
+	if (typename ListenerTable<Key, ContactListener>::Listeners* listeners = map.Find(key))
+	{
+		for (DeliveryIterator delIt = first; delIt != last; ++delIt)
+		{
+			// Skip events whose fixtures have gone (which may have happened during this batch).
+			const QueuedMessage& message = m_pumpMessages[delIt->m_message];
+			if (message.m_type == QM_DISCARDED)
+			{
+				continue;
+			}
+
+			ContactNotifier notifier = delIt->m_reversed ? 
+				ContactNotifier(message.m_fixtureB, message.m_fixtureA) : 
+				ContactNotifier(message.m_fixtureA, message.m_fixtureB);
+			NotifyContactListeners(listeners, notifier);
+		}
+	}
+}
+
+void GameMessageHub::DeliverContactEvents(unsigned short layers, GameMessageHub::DeliveryIterator first, GameMessageHub::DeliveryIterator last, LayerListenerTable<GameMessageHub::ContactListener>& map)
+{
+	for (DeliveryIterator delIt = first; delIt != last; ++delIt)
+	{
+		const QueuedMessage& message = m_pumpMessages[delIt->m_message];
+		if (message.m_type == QM_DISCARDED)
+		{
+			continue;
+		}
+
+		ContactNotifier notifier = delIt->m_reversed ? 
+			ContactNotifier(message.m_fixtureB, message.m_fixtureA) : 
+			ContactNotifier(message.m_fixtureA, message.m_fixtureB);
+		map.ForEach(layers, notifier);
+	}
+}
+
+template<typename Key>
+void GameMessageHub::DeliverGameEvents(Key key, GameMessageHub::DeliveryIterator first, GameMessageHub::DeliveryIterator last, ListenerTable<Key, GameMessageHub::GameEventAction>& map)
+{
+	if (typename ListenerTable<Key, GameEventAction>::Listeners* listeners = map.Find(key))
+	{
+		for (DeliveryIterator delIt = first; delIt != last; ++delIt)
+		{
+			const QueuedMessage& message = m_pumpMessages[delIt->m_message];
+			for (auto lisIt = listeners->begin(); lisIt != listeners->end(); ++lisIt)
+			{
+				lisIt->m_action(message.m_gameEvent, message.m_entity);
+			}
+		}
+	}
+}
+
+GameMessageHub::ContactNotifier::ContactNotifier(b2Fixture* fixture, b2Fixture* other) :
+	m_fixture(fixture),
+	m_other(other),
+	m_otherLayers(other->GetFilterData().categoryBits)
+{}
+
+void GameMessageHub::ContactNotifier::operator()(GameMessageHub::ContactListener& listener) const
+{
+	if ((listener.m_otherLayers & m_otherLayers) != 0)
+	{
+		listener.m_action(PhysicsContactEvent(m_fixture, m_other));
+	}
+}
+
+void GameMessageHub::EndPublish()
+{
+	if (--m_publishDepth > 0 || m_deferredChanges.empty())
+	{
+		return;
+	}
+
+	std::vector< boost::function<void ()> > changes;
+	changes.swap(m_deferredChanges);
+	for (auto chIt = changes.begin(); chIt != changes.end(); ++chIt)
+	{
+		(*chIt)();
+	}
 }
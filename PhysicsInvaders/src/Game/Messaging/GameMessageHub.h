@@ -38,24 +38,34 @@ namespace ComponentModel
 
 #include "Core/Functional/Action.h"
 #include "GameEventTypes.h"
-#include <map>
-#include <list>
+#include "ListenerTable.h"
+#include "LayerListenerTable.h"
+#include <vector>
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
 
 /**
  * Class which acts as a hub for messaging. Supports publish/subscribe 
- * and understands what to do with different message types. Will publish 
- * all incoming messages as soon as they arrive (for now). This means that
- * in the current implementation it is expected that no messages will be
- * generated outside of the main thread (if this becomes the case the
- * message hub will need to cache these in a queue and push them out 
- * during a 'pump' phase).
+ * and understands what to do with different message types. Has two
+ * publish modes:
+ *  - PM_IMMEDIATE publishes every message as soon as it's raised. Messages
+ *    must then only be raised on the main thread, and contact listeners are
+ *    called from inside Box2D's step (so can't create or destroy bodies).
+ *  - PM_QUEUED appends each message to a buffer belonging to the raising
+ *    thread (so raising takes no locks), and Pump publishes them all at a
+ *    point of the game's choosing, grouped by receiver.
  *
- * In case this is needed there are 4 methods associated with a given event:
+ * There are 4 methods associated with a given event:
  *  - RaiseEvent (Tells the hub the event has happened)
  *  - PublishEvent (Private, the hub uses this to notify all subscribers)
  *  - SubscribeEvent (Tells the hub to notify a given listener action, with specific interest actions)
  *  - UnsubscribeEvent (Tells the hub to no longer notify a given listener action)
- * NOTE: Subscribe/Unsubscribes should not be called during a publish.
+ * Subscribing hands back a Subscription, which Unsubscribe removes in constant time (without building
+ * an action to compare against). ScopedSubscription unsubscribes one automatically.
+ * Subscribes/unsubscribes made during a publish (i.e. by listeners) are deferred until the publish
+ * is done, in the order they were made - so the publish itself goes to the listeners it started with.
  */
 class GameMessageHub
 {
@@ -68,44 +78,201 @@ public:
 	{
 		PhysicsInterestRegistration() :
 			m_layerOfInterest(0),
-			m_bodyOfInterest(nullptr)
+			m_bodyOfInterest(nullptr),
+			m_otherLayersOfInterest(c_allLayers)
 		{ }
 
-		/// Layer of interest for the registration. Note that this cannot be
-		/// a true bitmask - the system internally will only use this to lookup
-		/// single layers, and will only work for entities which are in only
-		/// a single category.
+		/// Layers of interest for the registration - a mask of collision categories. 
+		/// The listener's told about contacts involving fixtures in any of them (once 
+		/// per contact, however many of the fixture's categories it's interested in).
 		unsigned short m_layerOfInterest;
 
 		/// A body you want to listen to.
 		b2Body* m_bodyOfInterest;
+
+		/// Layers the other fixture in a contact must be in (any of) for the listener to
+		/// be told about it - filtered by the hub, before any event is built. All by default.
+		unsigned short m_otherLayersOfInterest;
+
+		static const unsigned short c_allLayers = 0xFFFF;
+	};
+
+	/**
+	 * \class Subscription
+	 *
+	 * Token for one subscription. Tokens are plain data - once the subscription has gone (however it 
+	 * went, e.g. along with the entity it was about), unsubscribing with the token does nothing.
+	 */
+	class Subscription
+	{
+	public:
+		Subscription() : m_kind(SK_NONE) {}
+		bool IsNull() const { return m_kind == SK_NONE; }
+
+	private:
+		friend class GameMessageHub;
+		enum Kind
+		{
+			SK_NONE,
+			SK_CONTACT_START,
+			SK_CONTACT_END,
+			SK_GAME_EVENT,
+			SK_ENTITY_EVENT,
+		};
+
+		Kind m_kind;
+		ListenerHandle m_first;		///< The listener (or the body listener, for contacts)
+		ListenerHandle m_second;	///< The layer listener, for contacts
+	};
+
+	/// How raised messages reach the listeners.
+	enum PublishMode
+	{
+		PM_IMMEDIATE,	///< Published as they're raised.
+		PM_QUEUED,		///< Buffered until Pump.
 	};
 
 public:
 	GameMessageHub(b2World* world);
 	~GameMessageHub();
 
+	/// \name Queueing
+	/// Pump must be called where nothing can be raising messages (i.e. not during the parallel updates).
+	/// Messages about one receiver arrive in the order they were raised, but different receivers' messages
+	/// are delivered in batches, not interleaved as they were raised. Subscriptions changed by listeners
+	/// take effect once their batch is done; messages raised by listeners are pumped in a further batch.
+	/// @{
+		void SetPublishMode(PublishMode mode) { m_publishMode = mode; }
+		PublishMode GetPublishMode() const { return m_publishMode; }
+
+		/// Publishes everything queued. Does nothing in immediate mode (unless messages were queued before 
+		/// switching to it).
+		void Pump();
+
+		/// Drops queued contact events involving the fixture (Box2D tells us when it destroys one, as
+		/// the events would otherwise point at it).
+		void DiscardContactEvents(b2Fixture* fixture);
+	/// @}
+
 	void RaiseContactStartEvent(b2Contact* /*contact*/);
 	void RaiseContactEndEvent(b2Contact* /*contact*/);
 	void RaiseGameEvent(GameEventTypes::GameEvent gameEvent, ComponentModel::Entity* relevantEntity);
 	
-	void SubscribeContactStartEvent(const PhysicsInterestRegistration& /*interestGroup*/, Functional::Action<const PhysicsContactEvent&> /*actionToInvoke*/);
+	Subscription SubscribeContactStartEvent(const PhysicsInterestRegistration& /*interestGroup*/, Functional::Action<const PhysicsContactEvent&> /*actionToInvoke*/);
 	void UnsubscribeContactStartEvent(const PhysicsInterestRegistration& /*interestGroup*/, Functional::Action<const PhysicsContactEvent&> /*actionToInvoke*/);
 
-	void SubscribeContactEndEvent(const PhysicsInterestRegistration& /*interestGroup*/, Functional::Action<const PhysicsContactEvent&> /*actionToInvoke*/);
+	Subscription SubscribeContactEndEvent(const PhysicsInterestRegistration& /*interestGroup*/, Functional::Action<const PhysicsContactEvent&> /*actionToInvoke*/);
 	void UnsubscribeContactEndEvent(const PhysicsInterestRegistration& /*interestGroup*/, Functional::Action<const PhysicsContactEvent&> /*actionToInvoke*/);
 
-	void SubscribeGameEvent(GameEventTypes::GameEvent gameEvent, Functional::Action<GameEventTypes::GameEvent, ComponentModel::Entity*>);
-	void SubscribeGameEvent(ComponentModel::Entity* relevantEntity, Functional::Action<GameEventTypes::GameEvent, ComponentModel::Entity*>);
+	Subscription SubscribeGameEvent(GameEventTypes::GameEvent gameEvent, Functional::Action<GameEventTypes::GameEvent, ComponentModel::Entity*>);
+	Subscription SubscribeGameEvent(ComponentModel::Entity* relevantEntity, Functional::Action<GameEventTypes::GameEvent, ComponentModel::Entity*>);
 	void UnsubscribeGameEvent(GameEventTypes::GameEvent gameEvent, Functional::Action<GameEventTypes::GameEvent, ComponentModel::Entity*>);
 	void UnsubscribeGameEvent(ComponentModel::Entity* relevantEntity, Functional::Action<GameEventTypes::GameEvent, ComponentModel::Entity*>);
+	/// Drops every subscription to events about the entity (the entity manager does this when it recycles an entity).
+	void UnsubscribeAllGameEvents(ComponentModel::Entity* relevantEntity);
+	/// Drops every subscription (of any kind) whose action calls into one of the objects given, in a single
+	/// sweep of the hub. The targets must be sorted. Used to drop the subscriptions of a whole component pool at once.
+	void UnsubscribeAllTargets(const std::vector<const void*>& sortedTargets);
+
+	/// Removes the subscription (if it's still there), in constant time. The token's left null.
+	void Unsubscribe(Subscription& subscription);
 
 private:
+	typedef Functional::Action<const PhysicsContactEvent&> ContactAction;
+	typedef Functional::Action<GameEventTypes::GameEvent, ComponentModel::Entity*> GameEventAction;
+
+	/// A contact listener, along with the layers the other fixture must be in for it to be told.
+	struct ContactListener
+	{
+		ContactListener(const ContactAction& action, unsigned short otherLayers) : m_action(action), m_otherLayers(otherLayers) {}
+
+		void Swap(ContactListener& other) 
+		{ 
+			m_action.Swap(other.m_action); 
+			std::swap(m_otherLayers, other.m_otherLayers); 
+		}
+		/// Only the actions are compared (unsubscribing by action goes whatever the filter).
+		bool operator==(const ContactListener& other) const { return m_action == other.m_action; }
+		const void* GetTarget() const { return m_action.GetTarget(); }
+
+		ContactAction m_action;
+		unsigned short m_otherLayers;
+	};
+
+	/// Tells contact listeners about one fixture's side of a contact, if they're interested in the other.
+	class ContactNotifier
+	{
+	public:
+		ContactNotifier(b2Fixture* fixture, b2Fixture* other);
+		void operator()(ContactListener& listener) const;
+
+	private:
+		b2Fixture* m_fixture;
+		b2Fixture* m_other;
+		unsigned short m_otherLayers;
+	};
+
 	struct PhysicsEventActionMap
 	{
-		std::map< b2Body*, std::list< Functional::Action<const PhysicsContactEvent&> > > m_bodyMap;
-		std::map< unsigned short, std::list< Functional::Action<const PhysicsContactEvent&> > > m_layerMap;
+		ListenerTable<b2Body*, ContactListener> m_bodyMap;
+		LayerListenerTable<ContactListener> m_layerMap;
+	};
+
+	enum QueuedMessageType
+	{
+		QM_CONTACT_START,
+		QM_CONTACT_END,
+		QM_GAME_EVENT,
+		QM_DISCARDED,		///< Contact event whose fixture has been destroyed.
+	};
+
+	/// A raised message waiting for the pump. Plain data, so queueing one is just a copy.
+	struct QueuedMessage
+	{
+		QueuedMessageType m_type;
+		GameEventTypes::GameEvent m_gameEvent;
+		b2Fixture* m_fixtureA;
+		b2Fixture* m_fixtureB;
+		ComponentModel::Entity* m_entity;
+	};
+
+	/// One thread's queued messages. Only that thread appends to it, & only the pump takes from it.
+	typedef std::vector<QueuedMessage> MessageBuffer;
+
+	/// Which listener table a delivery goes through.
+	enum DeliveryTable
+	{
+		DT_CONTACT_START_BODY,
+		DT_CONTACT_START_LAYER,
+		DT_CONTACT_END_BODY,
+		DT_CONTACT_END_LAYER,
+		DT_GAME_EVENT,
+		DT_ENTITY_EVENT,
+	};
+
+	/// A queued message going to one key of one table (a message can go to several). Sorting these 
+	/// groups the deliveries by receiver, keeping each receiver's in the order they were raised.
+	struct Delivery
+	{
+		bool operator<(const Delivery& other) const
+		{
+			if (m_table != other.m_table)
+			{
+				return m_table < other.m_table;
+			}
+			if (m_key != other.m_key)
+			{
+				return m_key < other.m_key;
+			}
+			return m_message < other.m_message;
+		}
+
+		DeliveryTable m_table;
+		size_t m_key;			///< Key in the table (body, layer, event or entity)
+		unsigned int m_message;	///< Index of the message in the pump's messages
+		bool m_reversed;		///< For contacts, whether the event's fixtures are swapped (B is the receiver)
 	};
+	typedef std::vector<Delivery>::const_iterator DeliveryIterator;
 
 private:
 	void PublishContactStartEvent(b2Contact* /*contact*/);
@@ -113,28 +280,73 @@ private:
 	void PublishContactEvent(b2Contact* contact, PhysicsEventActionMap& eventMap);
 	void PublishGameEvent(GameEventTypes::GameEvent gameEvent, ComponentModel::Entity* relevantEntity);
 
+	/// \name Queued messages
+	/// @{
+		void QueueMessage(QueuedMessageType type, b2Fixture* fixtureA, b2Fixture* fixtureB, GameEventTypes::GameEvent gameEvent, ComponentModel::Entity* entity);
+		MessageBuffer* GetThreadBuffer();
+		/// Moves every buffer's messages into the pump's messages, returning whether there were any.
+		bool GatherQueuedMessages();
+		void AddDeliveries(unsigned int messageIndex);
+		void AddDelivery(DeliveryTable table, size_t key, unsigned int messageIndex, bool reversed);
+		/// Delivers the deliveries given, which all have the same table & key.
+		void DeliverGroup(DeliveryIterator first, DeliveryIterator last);
+		template<typename Key>
+		void DeliverContactEvents(Key key, DeliveryIterator first, DeliveryIterator last, ListenerTable<Key, ContactListener>& map);
+		void DeliverContactEvents(unsigned short layers, DeliveryIterator first, DeliveryIterator last, LayerListenerTable<ContactListener>& map);
+		template<typename Key>
+		void DeliverGameEvents(Key key, DeliveryIterator first, DeliveryIterator last, ListenerTable<Key, GameEventAction>& map);
+
+		/// The buffers are owned by the hub, so the thread local pointers mustn't clean them up.
+		static void KeepMessageBuffer(MessageBuffer* /*buffer*/) {}
+	/// @}
+
+	/// Reserves the listeners of a contact subscription, adding them now or once the publish is done.
+	Subscription SubscribeContactEvent(PhysicsEventActionMap& eventMap, Subscription::Kind kind, const PhysicsInterestRegistration& interestGroup, const ContactAction& action);
+	static void InsertContactListeners(PhysicsEventActionMap& eventMap, const Subscription& subscription, const PhysicsInterestRegistration& interestGroup, const ContactAction& action);
+	void RemoveSubscription(const Subscription& subscription);
+
+	/// \name Publish bracketing
+	/// Changes to the subscriptions are queued while anything's being published, & applied after.
+	/// @{
+		void BeginPublish() { ++m_publishDepth; }
+		void EndPublish();
+	/// @}
+
+	/// Notifies each of the listeners (if there are any) about a contact.
+	template<typename Listeners>
+	static void NotifyContactListeners(Listeners* listeners, const ContactNotifier& notifier)
+	{
+		if (listeners != nullptr)
+		{
+			for (auto lisIt = listeners->begin(); lisIt != listeners->end(); ++lisIt)
+			{
+				notifier(lisIt->m_action);
+			}
+		}
+	}
+
 	/// Helper method to invoke a bunch of actions - just avoids writing unnecessary boilerplate.
 	template<typename Key, typename Event>
-	void InvokeMappedActions(Key key, Event e, std::map< Key, std::list< Functional::Action<Event> > > map)
+	static void InvokeMappedActions(Key key, Event e, ListenerTable< Key, Functional::Action<Event> >& map)
 	{
-		if (map.count(key) > 0)
+		if (typename ListenerTable< Key, Functional::Action<Event> >::Listeners* listeners = map.Find(key))
 		{
-			for (auto actIt = map[key].begin(); actIt != map[key].end(); ++actIt)
+			for (auto lisIt = listeners->begin(); lisIt != listeners->end(); ++lisIt)
 			{
-				(*actIt)(e);
+				lisIt->m_action(e);
 			}
 		}
 	}
 
 	/// Helper method to invoke a bunch of actions - just avoids writing unnecessary boilerplate.
 	template<typename Key, typename EventArg1, typename EventArg2>
-	void InvokeMappedActions(Key key, EventArg1 e1, EventArg2 e2, std::map< Key, std::list< Functional::Action<EventArg1, EventArg2> > > map)
+	static void InvokeMappedActions(Key key, EventArg1 e1, EventArg2 e2, ListenerTable< Key, Functional::Action<EventArg1, EventArg2> >& map)
 	{
-		if (map.count(key) > 0)
+		if (typename ListenerTable< Key, Functional::Action<EventArg1, EventArg2> >::Listeners* listeners = map.Find(key))
 		{
-			for (auto actIt = map[key].begin(); actIt != map[key].end(); ++actIt)
+			for (auto lisIt = listeners->begin(); lisIt != listeners->end(); ++lisIt)
 			{
-				(*actIt)(e1, e2);
+				lisIt->m_action(e1, e2);
 			}
 		}
 	}
@@ -144,6 +356,62 @@ private:
 	Box2DMessageListener* m_messageListener;
 	PhysicsEventActionMap m_contactStartActions;
 	PhysicsEventActionMap m_contactEndActions;
-	std::map<GameEventTypes::GameEvent, std::list< Functional::Action<GameEventTypes::GameEvent, ComponentModel::Entity*> > > m_gameEventListeners;
-	std::map<ComponentModel::Entity*, std::list< Functional::Action<GameEventTypes::GameEvent, ComponentModel::Entity*> > > m_entityEventListeners;
+	ListenerTable<GameEventTypes::GameEvent, GameEventAction> m_gameEventListeners;
+	ListenerTable<ComponentModel::Entity*, GameEventAction> m_entityEventListeners;
+
+	// Publishes in progress (publishes can nest), and the changes waiting on them.
+	unsigned int m_publishDepth;
+	std::vector< boost::function<void ()> > m_deferredChanges;
+
+	// Queueing: each raising thread's buffer, & the messages being pumped (with their deliveries).
+	PublishMode m_publishMode;
+	boost::thread_specific_ptr<MessageBuffer> m_threadBuffer;
+	std::vector<MessageBuffer*> m_messageBuffers;
+	boost::mutex m_bufferMutex; // Guards the buffer list, which only changes when a thread first raises a message.
+	std::vector<QueuedMessage> m_pumpMessages;
+	std::vector<Delivery> m_deliveries;
+};
+
+/**
+ * \class ScopedSubscription
+ *
+ * Holds one subscription, unsubscribing when it's reset or destroyed. Pooled components are reused
+ * rather than destroyed, so they should still reset theirs when cleaned up.
+ */
+class ScopedSubscription : public boost::noncopyable
+{
+public:
+	ScopedSubscription() : m_hub(nullptr) {}
+	~ScopedSubscription() { Reset(); }
+
+	/// Unsubscribes whatever's held, and holds the subscription given instead.
+	void Reset(GameMessageHub& hub, const GameMessageHub::Subscription& subscription)
+	{
+		Reset();
+		m_hub = &hub;
+		m_subscription = subscription;
+	}
+
+	/// Unsubscribes whatever's held.
+	void Reset()
+	{
+		if (m_hub != nullptr)
+		{
+			m_hub->Unsubscribe(m_subscription);
+			m_hub = nullptr;
+		}
+	}
+
+	/// Forgets the subscription without unsubscribing (when the hub has dropped it already).
+	void Release()
+	{
+		m_hub = nullptr;
+		m_subscription = GameMessageHub::Subscription();
+	}
+
+	bool IsNull() const { return m_hub == nullptr; }
+
+private:
+	GameMessageHub* m_hub;
+	GameMessageHub::Subscription m_subscription;
 };
\ No newline at end of file
@@ -0,0 +1,205 @@
+/*
+ * This source file is part of one of Jeremy Burgess's samples.
+ *
+ * Copyright (c) 2013 Jeremy Burgess 
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "ListenerTable.h"
+#include "Utility/Helpers.h"
+
+#include <vector>
+#include <algorithm>
+
+/**
+ * Listeners for physics layers (collision category bits), where each listener can be interested in
+ * any number of layers. There's one contiguous listener array per layer bit, and a listener is in the
+ * array of every layer it's interested in. Publishing walks the set bits of a fixture's categories, 
+ * and only calls a listener from the lowest of those bits it's interested in - so it's called once
+ * per event, however many of the fixture's layers it wants.
+ *
+ * Handles work as they do for ListenerTable: removing through one is constant time (a listener is in
+ * at most c_layerCount arrays), doesn't allocate, and doesn't keep listeners in any particular order.
+ *
+ * As with ListenerTable, the listeners mustn't be changed while they're being published to.
+ */
+template <typename ActionType>
+class LayerListenerTable
+{
+public:
+	/// Layers are the bits of a b2Filter's categoryBits.
+	static const unsigned int c_layerCount = 16;
+
+public:
+	/// Visits every listener interested in any of the layers, once each (calling visitor(action)).
+	template<typename Visitor>
+	void ForEach(unsigned short layers, const Visitor& visitor)
+	{
+		for (unsigned int remaining = layers; remaining != 0; remaining &= remaining - 1)
+		{
+			unsigned int layer = Helpers::CountTrailingZeros(remaining);
+			unsigned int lowerLayers = layers & ((1u << layer) - 1);
+			Listeners& listeners = m_layers[layer];
+			for (auto lisIt = listeners.begin(); lisIt != listeners.end(); ++lisIt)
+			{
+				// Listeners interested in a lower layer of these have been visited already.
+				if ((lisIt->m_mask & lowerLayers) == 0)
+				{
+					visitor(lisIt->m_action);
+				}
+			}
+		}
+	}
+
+	/// \name Adding
+	/// @{
+		ListenerHandle Add(unsigned short mask, const ActionType& action)
+		{
+			ListenerHandle handle = Reserve();
+			Insert(handle, mask, action);
+			return handle;
+		}
+
+		/// Reserves a handle for a listener to be inserted later.
+		ListenerHandle Reserve() { return m_locations.Reserve(); }
+
+		/// Adds the listener for a reserved handle (unless it's been removed since).
+		void Insert(const ListenerHandle& handle, unsigned short mask, const ActionType& action)
+		{
+			if (!m_locations.IsCurrent(handle) || m_locations.IsInserted(handle.m_index))
+			{
+				return;
+			}
+
+			Location& location = m_locations.Insert(handle.m_index);
+			location.m_mask = mask;
+			for (unsigned int remaining = mask; remaining != 0; remaining &= remaining - 1)
+			{
+				unsigned int layer = Helpers::CountTrailingZeros(remaining);
+				location.m_positions[layer] = static_cast<unsigned int>(m_layers[layer].size());
+				m_layers[layer].push_back(Listener(action, handle.m_index, mask));
+			}
+		}
+	/// @}
+
+	/// \name Removing
+	/// @{
+		/// Removes the listener with the handle given, from all of its layers.
+		void Remove(const ListenerHandle& handle)
+		{
+			if (m_locations.IsCurrent(handle))
+			{
+				RemoveLocation(handle.m_index);
+			}
+		}
+
+		/// Removes every listener equal to the action given which is interested in any of the layers.
+		void Remove(unsigned short mask, const ActionType& action)
+		{
+			for (unsigned int remaining = mask; remaining != 0; remaining &= remaining - 1)
+			{
+				// Backwards, so whatever's swapped into a removed listener's place has been checked already.
+				Listeners& listeners = m_layers[Helpers::CountTrailingZeros(remaining)];
+				for (size_t i = listeners.size(); i-- > 0; )
+				{
+					if (listeners[i].m_action == action)
+					{
+						RemoveLocation(listeners[i].m_location);
+					}
+				}
+			}
+		}
+
+		/// Removes every listener whose action calls into any of the (sorted) targets.
+		void RemoveTargets(const std::vector<const void*>& sortedTargets)
+		{
+			for (unsigned int layer = 0; layer < c_layerCount; ++layer)
+			{
+				Listeners& listeners = m_layers[layer];
+				for (size_t i = listeners.size(); i-- > 0; )
+				{
+					const void* target = listeners[i].m_action.GetTarget();
+					if (target != nullptr && std::binary_search(sortedTargets.begin(), sortedTargets.end(), target))
+					{
+						RemoveLocation(listeners[i].m_location);
+					}
+				}
+			}
+		}
+	/// @}
+
+private:
+	struct Listener
+	{
+		Listener(const ActionType& action, unsigned int location, unsigned short mask) : m_action(action), m_location(location), m_mask(mask) {}
+
+		ActionType m_action;
+		unsigned int m_location;	// Index of the listener's location (and handle)
+		unsigned short m_mask;		// All the layers the listener's interested in
+	};
+	typedef std::vector<Listener> Listeners;
+
+	/// Where a handle's listener is in each of its layers (once it's been inserted).
+	struct Location
+	{
+		Location() : m_mask(0) {}
+
+		unsigned short m_mask;
+		unsigned int m_positions[c_layerCount];
+	};
+
+	/// Takes the location's listener out of all of its layers, and frees the location.
+	void RemoveLocation(unsigned int index)
+	{
+		if (m_locations.IsInserted(index))
+		{
+			const Location& location = m_locations.Get(index);
+			for (unsigned int remaining = location.m_mask; remaining != 0; remaining &= remaining - 1)
+			{
+				unsigned int layer = Helpers::CountTrailingZeros(remaining);
+				RemoveAt(layer, location.m_positions[layer]);
+			}
+		}
+		m_locations.Free(index);
+	}
+
+	/// Swaps the layer's last listener into the position given, and drops the last.
+	void RemoveAt(unsigned int layer, size_t position)
+	{
+		Listeners& listeners = m_layers[layer];
+		if (position + 1 != listeners.size())
+		{
+			Listener& moved = listeners.back();
+			listeners[position].m_action.Swap(moved.m_action);
+			listeners[position].m_location = moved.m_location;
+			listeners[position].m_mask = moved.m_mask;
+			m_locations.Get(moved.m_location).m_positions[layer] = static_cast<unsigned int>(position);
+		}
+		listeners.pop_back();
+	}
+
+private:
+	Listeners m_layers[c_layerCount];
+
+	// Listener locations, indexed by handle
+	ListenerLocations<Location> m_locations;
+};
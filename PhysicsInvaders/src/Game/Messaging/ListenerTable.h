@@ -0,0 +1,414 @@
+/*
+ * This source file is part of one of Jeremy Burgess's samples.
+ *
+ * Copyright (c) 2013 Jeremy Burgess 
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <vector>
+#include <algorithm>
+
+/**
+ * Identifies one listener in a ListenerTable, so it can be removed in constant time. Handles are 
+ * plain data; once the listener has gone (however it went), the handle is stale and removing with 
+ * it does nothing. Default constructed handles are empty.
+ */
+struct ListenerHandle
+{
+	ListenerHandle() : m_index(0), m_generation(0) {}
+	ListenerHandle(unsigned int index, unsigned int generation) : m_index(index), m_generation(generation) {}
+
+	bool IsNull() const { return m_generation == 0; }
+
+	unsigned int m_index;
+	unsigned int m_generation;
+};
+
+/**
+ * Hands out listener handles for the listener tables. Each handle indexes a location, holding whatever
+ * the table needs to find the handle's listener (LocationT), and a generation which is bumped when the
+ * handle's freed - so stale handles can be told apart from the current one. Freed locations are reused.
+ */
+template <typename LocationT>
+class ListenerLocations
+{
+public:
+	/// Reserves a handle, whose listener hasn't been inserted yet.
+	ListenerHandle Reserve()
+	{
+		unsigned int index;
+		if (!m_freeEntries.empty())
+		{
+			index = m_freeEntries.back();
+			m_freeEntries.pop_back();
+		}
+		else
+		{
+			index = static_cast<unsigned int>(m_entries.size());
+			m_entries.push_back(Entry());
+		}
+		return ListenerHandle(index, m_entries[index].m_generation);
+	}
+
+	inline bool IsCurrent(const ListenerHandle& handle) const 
+	{ 
+		return handle.m_index < m_entries.size() && m_entries[handle.m_index].m_generation == handle.m_generation; 
+	}
+
+	inline bool IsInserted(unsigned int index) const { return m_entries[index].m_inserted; }
+
+	/// Marks the location's listener as inserted, returning the location to fill in.
+	LocationT& Insert(unsigned int index)
+	{
+		m_entries[index].m_inserted = true;
+		return m_entries[index].m_location;
+	}
+
+	inline LocationT& Get(unsigned int index) { return m_entries[index].m_location; }
+
+	/// Invalidates the location's handle & makes it available again.
+	void Free(unsigned int index)
+	{
+		Entry& entry = m_entries[index];
+		entry.m_inserted = false;
+		if (++entry.m_generation == 0)
+		{
+			entry.m_generation = 1;
+		}
+		m_freeEntries.push_back(index);
+	}
+
+private:
+	struct Entry
+	{
+		Entry() : m_generation(1), m_inserted(false) {}
+
+		LocationT m_location;
+		unsigned int m_generation;
+		bool m_inserted;
+	};
+
+	std::vector<Entry> m_entries;
+	std::vector<unsigned int> m_freeEntries;
+};
+
+/**
+ * Flat hash table of listener lists, used by the message hub to find who's interested in an event.
+ * Open addressing (linear probing, with removals shifting later entries back rather than leaving 
+ * tombstones) over one array of slots, each holding its key & a contiguous array of listeners. Keys
+ * are pointers or small integers/enums - anything which converts to one of the HashKey overloads.
+ *
+ * Every listener has a handle, through which it can be removed without searching (the last listener
+ * for the key takes its place - so listeners aren't called in any particular order). A handle can 
+ * also be reserved ahead of adding its listener, for callers which have to defer the add.
+ *
+ * The listener arrays mustn't be changed while they're being iterated (the hub defers any changes
+ * made during a publish until it's done).
+ */
+template <typename Key, typename ActionType>
+class ListenerTable
+{
+public:
+	struct Listener
+	{
+		Listener(const ActionType& action, unsigned int location) : m_action(action), m_location(location) {}
+
+		ActionType m_action;
+		unsigned int m_location; // Index of the listener's location (and handle)
+	};
+	typedef std::vector<Listener> Listeners;
+
+public:
+	ListenerTable() : m_slots(c_initialCapacity), m_count(0) {}
+
+	/// The listeners for the key, or nullptr if there are none.
+	Listeners* Find(Key key)
+	{
+		size_t index = FindSlot(key);
+		return index != c_notFound ? &m_slots[index].m_listeners : nullptr;
+	}
+
+	/// \name Adding
+	/// @{
+		ListenerHandle Add(Key key, const ActionType& action)
+		{
+			ListenerHandle handle = Reserve();
+			Insert(handle, key, action);
+			return handle;
+		}
+
+		/// Reserves a handle for a listener to be inserted later.
+		ListenerHandle Reserve() { return m_locations.Reserve(); }
+
+		/// Adds the listener for a reserved handle (unless it's been removed since).
+		void Insert(const ListenerHandle& handle, Key key, const ActionType& action)
+		{
+			if (!m_locations.IsCurrent(handle) || m_locations.IsInserted(handle.m_index))
+			{
+				return;
+			}
+
+			size_t index = FindSlot(key);
+			if (index == c_notFound)
+			{
+				if ((m_count + 1) * 4 > m_slots.size() * 3)
+				{
+					Grow();
+				}
+				index = InsertSlot(key);
+			}
+
+			Listeners& listeners = m_slots[index].m_listeners;
+			Location& location = m_locations.Insert(handle.m_index);
+			location.m_key = key;
+			location.m_position = static_cast<unsigned int>(listeners.size());
+			listeners.push_back(Listener(action, handle.m_index));
+		}
+	/// @}
+
+	/// \name Removing
+	/// @{
+		/// Removes the listener with the handle given - constant time, and doesn't allocate.
+		void Remove(const ListenerHandle& handle)
+		{
+			if (!m_locations.IsCurrent(handle))
+			{
+				return;
+			}
+
+			if (m_locations.IsInserted(handle.m_index))
+			{
+				const Location& location = m_locations.Get(handle.m_index);
+				size_t index = FindSlot(location.m_key);
+				Listeners& listeners = m_slots[index].m_listeners;
+				RemoveAt(listeners, location.m_position);
+				if (listeners.empty())
+				{
+					EraseSlot(index);
+				}
+			}
+			m_locations.Free(handle.m_index);
+		}
+
+		/// Removes every listener for the key equal to the action given.
+		void Remove(Key key, const ActionType& action)
+		{
+			size_t index = FindSlot(key);
+			if (index == c_notFound)
+			{
+				return;
+			}
+
+			// Backwards, so whatever's swapped into a removed listener's place has been checked already.
+			Listeners& listeners = m_slots[index].m_listeners;
+			for (size_t i = listeners.size(); i-- > 0; )
+			{
+				if (listeners[i].m_action == action)
+				{
+					m_locations.Free(listeners[i].m_location);
+					RemoveAt(listeners, i);
+				}
+			}
+			if (listeners.empty())
+			{
+				EraseSlot(index);
+			}
+		}
+
+		/// Removes every listener for the key.
+		void RemoveKey(Key key)
+		{
+			size_t index = FindSlot(key);
+			if (index != c_notFound)
+			{
+				Listeners& listeners = m_slots[index].m_listeners;
+				for (auto lisIt = listeners.begin(); lisIt != listeners.end(); ++lisIt)
+				{
+					m_locations.Free(lisIt->m_location);
+				}
+				EraseSlot(index);
+			}
+		}
+
+		/// Removes every listener whose action calls into any of the (sorted) targets.
+		void RemoveTargets(const std::vector<const void*>& sortedTargets)
+		{
+			std::vector<Key> emptied;
+			for (auto slotIt = m_slots.begin(); slotIt != m_slots.end(); ++slotIt)
+			{
+				if (!slotIt->m_used)
+				{
+					continue;
+				}
+
+				Listeners& listeners = slotIt->m_listeners;
+				for (size_t i = listeners.size(); i-- > 0; )
+				{
+					const void* target = listeners[i].m_action.GetTarget();
+					if (target != nullptr && std::binary_search(sortedTargets.begin(), sortedTargets.end(), target))
+					{
+						m_locations.Free(listeners[i].m_location);
+						RemoveAt(listeners, i);
+					}
+				}
+				if (listeners.empty())
+				{
+					emptied.push_back(slotIt->m_key);
+				}
+			}
+
+			// Removals move the slots about, so they're left until the sweep is done.
+			for (auto keyIt = emptied.begin(); keyIt != emptied.end(); ++keyIt)
+			{
+				EraseSlot(FindSlot(*keyIt));
+			}
+		}
+	/// @}
+
+	size_t GetKeyCount() const { return m_count; }
+
+private:
+	static const size_t c_initialCapacity = 16; // Must be a power of 2
+	static const size_t c_notFound = ~static_cast<size_t>(0);
+
+	struct Slot
+	{
+		Slot() : m_key(), m_used(false) {}
+
+		Key m_key;
+		bool m_used;
+		Listeners m_listeners;
+	};
+
+	/// Where a handle's listener is (once it's been inserted).
+	struct Location
+	{
+		Location() : m_key(), m_position(0) {}
+
+		Key m_key;
+		unsigned int m_position;
+	};
+
+	/// \name Hashes
+	/// Fibonacci hashing, with the high bits folded down (as only the low bits are used).
+	/// @{
+		static size_t HashKey(unsigned int value)
+		{
+			unsigned int hash = value * 2654435769u;
+			return hash ^ (hash >> 16);
+		}
+		static size_t HashKey(const void* pointer)
+		{
+			// Allocations are at least 8 byte aligned, so the low bits are always 0.
+			return HashKey(static_cast<unsigned int>(reinterpret_cast<size_t>(pointer) >> 3));
+		}
+	/// @}
+
+	inline size_t GetHome(Key key) const { return HashKey(key) & (m_slots.size() - 1); }
+
+	/// Swaps the last listener into the position given, and drops the last.
+	void RemoveAt(Listeners& listeners, size_t position)
+	{
+		if (position + 1 != listeners.size())
+		{
+			Listener& moved = listeners.back();
+			listeners[position].m_action.Swap(moved.m_action);
+			listeners[position].m_location = moved.m_location;
+			m_locations.Get(moved.m_location).m_position = static_cast<unsigned int>(position);
+		}
+		listeners.pop_back();
+	}
+
+	size_t FindSlot(Key key) const
+	{
+		size_t mask = m_slots.size() - 1;
+		for (size_t index = GetHome(key); m_slots[index].m_used; index = (index + 1) & mask)
+		{
+			if (m_slots[index].m_key == key)
+			{
+				return index;
+			}
+		}
+		return c_notFound;
+	}
+
+	/// Claims a slot for a key which isn't in the table (there must be room).
+	size_t InsertSlot(Key key)
+	{
+		size_t mask = m_slots.size() - 1;
+		size_t index = GetHome(key);
+		while (m_slots[index].m_used)
+		{
+			index = (index + 1) & mask;
+		}
+		m_slots[index].m_key = key;
+		m_slots[index].m_used = true;
+		++m_count;
+		return index;
+	}
+
+	void EraseSlot(size_t hole)
+	{
+		size_t mask = m_slots.size() - 1;
+		m_slots[hole].m_used = false;
+		m_slots[hole].m_listeners.clear();
+		--m_count;
+
+		// Shift back any later entries in the run which could live in the hole, so lookups never hit a gap.
+		for (size_t index = (hole + 1) & mask; m_slots[index].m_used; index = (index + 1) & mask)
+		{
+			size_t home = GetHome(m_slots[index].m_key);
+			bool canMove = (hole < index) ? (home <= hole || home > index) : (home <= hole && home > index);
+			if (canMove)
+			{
+				Slot& to = m_slots[hole];
+				Slot& from = m_slots[index];
+				to.m_key = from.m_key;
+				to.m_used = true;
+				to.m_listeners.swap(from.m_listeners);
+				from.m_used = false;
+				hole = index;
+			}
+		}
+	}
+
+	void Grow()
+	{
+		std::vector<Slot> oldSlots(m_slots.size() * 2);
+		oldSlots.swap(m_slots);
+		m_count = 0;
+		for (auto slotIt = oldSlots.begin(); slotIt != oldSlots.end(); ++slotIt)
+		{
+			if (slotIt->m_used)
+			{
+				m_slots[InsertSlot(slotIt->m_key)].m_listeners.swap(slotIt->m_listeners);
+			}
+		}
+	}
+
+private:
+	std::vector<Slot> m_slots;
+	size_t m_count;
+
+	// Listener locations, indexed by handle
+	ListenerLocations<Location> m_locations;
+};
@@ -27,6 +27,7 @@
 
 // Project headers
 #include "ITexture2D.h"
+#include "QuadRenderPacket.h"
 
 // Boost headers
 #include <boost/assert.hpp>
@@ -76,6 +77,25 @@ void MoveableTexturedQuad::InitialiseBaseSize()
 	}
 }
 
+void MoveableTexturedQuad::FillRenderPacket(QuadRenderPacket& packet) const
+{
+	packet.m_texture = m_texture;
+	packet.m_position[0] = m_position(0);
+	packet.m_position[1] = m_position(1);
+	packet.m_position[2] = m_position(2);
+	packet.m_angle = 2 * atan2(m_orientation.z(), m_orientation.w());
+	packet.m_orientationCenter[0] = m_orientationCenter(0);
+	packet.m_orientationCenter[1] = m_orientationCenter(1);
+	packet.m_size[0] = m_size(0) * m_baseSize(0);
+	packet.m_size[1] = m_size(1) * m_baseSize(1);
+	packet.m_positionOffset[0] = m_positionOffset(0);
+	packet.m_positionOffset[1] = m_positionOffset(1);
+	packet.m_colour[0] = m_colour(0);
+	packet.m_colour[1] = m_colour(1);
+	packet.m_colour[2] = m_colour(2);
+	packet.m_colour[3] = m_colour(3);
+}
+
 Affine3f MoveableTexturedQuad::GetTransform() const
 {
 	Affine3f transform(Affine3f::Identity());
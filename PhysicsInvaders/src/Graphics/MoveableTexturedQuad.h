@@ -25,6 +25,7 @@
 #pragma once
 
 class ITexture2D;
+struct QuadRenderPacket;
 
 // Eigen types.
 #include <Core\EigenIncludes.h>
@@ -84,6 +85,9 @@ public:
 		void SetTexture(const ITexture2D* texture) { m_texture = texture; }
 	/// @}
 
+	/// Writes the quad as it stands into a render packet (only rotations about z are kept).
+	void FillRenderPacket(QuadRenderPacket& packet) const;
+
 private:
 	void InitialiseBaseSize();
 
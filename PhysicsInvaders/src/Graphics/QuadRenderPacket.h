@@ -0,0 +1,53 @@
+/*
+ * This source file is part of one of Jeremy Burgess's samples.
+ *
+ * Copyright (c) 2013 Jeremy Burgess 
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+// Forward declarations
+class ITexture2D;
+
+/**
+ * \struct QuadRenderPacket
+ *
+ * Everything the quad renderer needs to draw one quad, written during the synchronise so the
+ * render thread never reads objects the update owns. Plain old data, so packets can be
+ * copied, sorted & consumed linearly.
+ */
+struct QuadRenderPacket
+{
+	// Texture to draw with (owned by the texture manager, which never changes it once loaded) - 
+	// nullptr in packets nothing has been written to, which aren't drawn.
+	const ITexture2D* m_texture;
+
+	// 2D transform - the z of the position is the depth.
+	float m_position[3];
+	float m_angle;
+	float m_orientationCenter[2];
+
+	// Final size (base size * size scale), and offset in that space
+	float m_size[2];
+	float m_positionOffset[2];
+
+	float m_colour[4];
+};
@@ -33,12 +33,14 @@
 // Project Headers
 #include "Texture2DD3D.h"
 #include "EffectD3D.h"
-#include "MoveableTexturedQuad.h"
 #include "EigenToD3D.h"
 #include "RendererD3D.h"
 #include "ICamera.h"
 #include "Core/RunInformation.h"
 
+// STL
+#include <algorithm>
+
 // Vertex structure for rendering quads
 struct vertex
 {
@@ -63,10 +65,12 @@ QuadRendererD3D::QuadRendererD3D(
 	const RendererD3D& renderer, 
 	const char* effectFilename, 
 	size_t numReservedQuadSpots) :
+	m_writeBuffer(0),
 	m_renderingEffect(nullptr)
 {
 	// Reserve space
-	m_quadsForRendering.reserve(numReservedQuadSpots);
+	m_packets[0].reserve(numReservedQuadSpots);
+	m_packets[1].reserve(numReservedQuadSpots);
 
 	// Load the effect
 	m_renderingEffect = new EffectD3D();
@@ -99,30 +103,45 @@ QuadRendererD3D::QuadRendererD3D(
 
 QuadRendererD3D::~QuadRendererD3D(void)
 {
-	ClearRenderList();
 	delete m_renderingEffect;
 
 	if (m_buffer)
 		m_buffer->Release();
 }
 
-void QuadRendererD3D::AddToRenderList(const MoveableTexturedQuad* quad)
+void QuadRendererD3D::BeginRenderPackets(size_t count)
+{
+	QuadRenderPacket empty = QuadRenderPacket();
+	m_packets[m_writeBuffer].assign(count, empty);
+}
+
+void QuadRendererD3D::SwapRenderPackets()
 {
-	m_quadsForRendering.push_back(quad);
+	// Drop the slots nobody wrote (disabled quads, or ones yet to be updated).
+	std::vector<QuadRenderPacket>& packets = m_packets[m_writeBuffer];
+	packets.erase(std::remove_if(packets.begin(), packets.end(), 
+		[](const QuadRenderPacket& packet) { return packet.m_texture == nullptr; }), packets.end());
+	m_writeBuffer = 1 - m_writeBuffer;
 }
 
-void QuadRendererD3D::ClearRenderList()
+// Builds the world matrix of a packet: offset about the orientation center, scale, rotate, then place.
+static XMMATRIX GetPacketTransform(const QuadRenderPacket& packet)
 {
-	m_quadsForRendering.clear();
+	return XMMatrixTranslation(packet.m_positionOffset[0] - packet.m_orientationCenter[0], packet.m_positionOffset[1] - packet.m_orientationCenter[1], 0) *
+		XMMatrixScaling(packet.m_size[0], packet.m_size[1], 1) *
+		XMMatrixRotationZ(packet.m_angle) *
+		XMMatrixTranslation(packet.m_orientationCenter[0] + packet.m_position[0], packet.m_orientationCenter[1] + packet.m_position[1], packet.m_position[2]);
 }
 
 void QuadRendererD3D::Render(const RendererD3D& renderer, const ICamera* camera)
 {
-	// Sort all quads.
-	std::sort(m_quadsForRendering.begin(), m_quadsForRendering.end(), 
-		[camera](const MoveableTexturedQuad* first, const MoveableTexturedQuad* second)
+	// The render thread has the read buffer to itself, so sort it in place.
+	std::vector<QuadRenderPacket>& packets = m_packets[1 - m_writeBuffer];
+	std::sort(packets.begin(), packets.end(), 
+		[camera](const QuadRenderPacket& first, const QuadRenderPacket& second)
 	    {
-			return camera->GetRenderDistanceToPoint(first->GetPosition()) > camera->GetRenderDistanceToPoint(second->GetPosition());
+			return camera->GetRenderDistanceToPoint(Eigen::Vector3f(first.m_position[0], first.m_position[1], first.m_position[2])) > 
+				camera->GetRenderDistanceToPoint(Eigen::Vector3f(second.m_position[0], second.m_position[1], second.m_position[2]));
 	    });
 
 	// Get the device
@@ -191,18 +210,18 @@ void QuadRendererD3D::Render(const RendererD3D& renderer, const ICamera* camera)
 	for( UINT p = 0; p < techDesc.Passes; ++p )
 	{
 		// Setup the variables required by the quad, and draw it.
-		for (auto qIt = m_quadsForRendering.begin(); qIt != m_quadsForRendering.end(); ++qIt)
+		for (auto pIt = packets.begin(); pIt != packets.end(); ++pIt)
 		{			
-			// Get the quad and bind its world transform.
-			const MoveableTexturedQuad* quad = *qIt;
-			EigenToD3D::EigenAffineToD3DMatrix(quad->GetTransform(), w);
+			// Get the packet and bind its world transform.
+			const QuadRenderPacket& packet = *pIt;
+			w = GetPacketTransform(packet);
 			worldMatrixVariable->SetMatrix((float*)&w);
 
 			// Map the vertices (their colours can change).
 			D3D11_MAPPED_SUBRESOURCE mappedResource;
 			device->Map(m_buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
 			v = (vertex*)mappedResource.pData;
-			XMFLOAT4 colour = EigenToD3D::EigenVector4fToD3DVector4(quad->GetColour());
+			XMFLOAT4 colour(packet.m_colour);
 
 			v[0] = vertex( XMFLOAT3(0,0,0),colour,XMFLOAT2(0.0f, 1.0f) );
 			v[1] = vertex( XMFLOAT3(0,1,0),colour,XMFLOAT2(0.0f, 0.0f) );
@@ -213,7 +232,7 @@ void QuadRendererD3D::Render(const RendererD3D& renderer, const ICamera* camera)
 			
 			// Bind the texture
 			ID3DX11EffectShaderResourceVariable* textureVar = m_renderingEffect->GetVariable( "tex2D" )->AsShaderResource();
-			textureVar->SetResource( static_cast<const Texture2DD3D*>(quad->GetTexture())->GetShaderResourceViewD3D() );
+			textureVar->SetResource( static_cast<const Texture2DD3D*>(packet.m_texture)->GetShaderResourceViewD3D() );
 
 			// Apply technique pass
 			technique->GetPassByIndex( p )->Apply( 0, device );
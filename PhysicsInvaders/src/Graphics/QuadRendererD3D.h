@@ -26,19 +26,20 @@
 
 // Included for internally used types.
 #include <vector>
+#include "QuadRenderPacket.h"
 
 // Forward declarations
 class RendererD3D;
 class EffectD3D;
-class MoveableTexturedQuad;
 struct ID3D11Buffer;
 class ICamera;
 
 /**
- * \class ITexture2D
+ * \class QuadRendererD3D
  *
- * Simple quad renderer that adds quads to an internal list each frame, draws them
- * using a owned effect that it manages, and then clears its internal list.
+ * Simple quad renderer that draws render packets using a owned effect that it manages. Packets
+ * are written to one buffer during the synchronise, then swapped with the buffer the render 
+ * thread draws from - so the render thread only ever reads its own copy, front to back.
  */
 class QuadRendererD3D
 {
@@ -49,12 +50,30 @@ public:
 		size_t numReservedQuadSpots);
 	~QuadRendererD3D(void);
 
-	void AddToRenderList(const MoveableTexturedQuad* quad);
+	/// \name Render packets
+	/// Only to be used while the render thread isn't drawing - i.e. during the synchronise. Packets are
+	/// written in place, each writer to its own index, so quads can be synchronised in parallel. Packets
+	/// written outside of BeginRenderPackets / SwapRenderPackets are never drawn.
+	/// @{
+		/// Clears the packets written since the last swap, and makes room for 'count' (all empty).
+		void BeginRenderPackets(size_t count);
+		/// The packet at 'index', to be drawn from the next swap on (nullptr if there's no room for it).
+		QuadRenderPacket* GetRenderPacket(size_t index) 
+		{ 
+			std::vector<QuadRenderPacket>& packets = m_packets[m_writeBuffer];
+			return index < packets.size() ? &packets[index] : nullptr;
+		}
+		/// Hands the packets written since BeginRenderPackets over to the render thread (dropping any left empty).
+		void SwapRenderPackets();
+	/// @}
+
+	/// Draws the last packets swapped in (sorting them back to front first).
 	void Render(const RendererD3D& renderer, const ICamera* camera);
-	void ClearRenderList();
 
 private:
-	std::vector<const MoveableTexturedQuad*> m_quadsForRendering;
+	// Packets being written (m_writeBuffer) & packets being drawn (the other one)
+	std::vector<QuadRenderPacket> m_packets[2];
+	unsigned int m_writeBuffer;
 	EffectD3D* m_renderingEffect;
 	// Own a vert buffer for drawing the quads
 	ID3D11Buffer* m_buffer;
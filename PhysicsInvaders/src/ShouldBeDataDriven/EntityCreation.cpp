@@ -27,6 +27,7 @@
 #include "Core/RunInformation.h"
 #include "ComponentModel/Entity.h"
 #include "ComponentModel/EntityComponentManager.h"
+#include "ComponentModel/Prefab.h"
 #include "CoreComponents/CameraComponent.h"
 #include "CoreComponents/Box2DBodyComponent.h"
 #include "CoreComponents/MoveableQuadComponent.h"
@@ -44,17 +45,33 @@
 #include "Game/Data/InvaderWaveDefinition.h"
 #include "Game/Physics/GamePhysicsConstants.h"
 #include <Box2D/Box2D.h>
+#include <boost/assert.hpp>
 
 using namespace ComponentModel;
 
 static const char c_leftWallName[] = "LeftWall";
 static const char c_rightWallName[] = "RightWall";
 
+// Texture & configuration of each invader type (indexed by InvaderDefinition::m_invaderType)
+static const int c_invaderTypeCount = 3;
+static const char* const c_invaderTextureNames[c_invaderTypeCount] = { "invader0", "invader1", "invader2" };
+static const Invader::InvaderConfig c_invaderConfigs[c_invaderTypeCount] = 
+{
+	Invader::InvaderConfig(30, 10, 1, 0),
+	Invader::InvaderConfig(20, 20, 1, 0),
+	Invader::InvaderConfig(10, 30, 1, 0),
+};
+
+// Prefabs
+static const Prefab c_invaderPrefab = Prefab().AddComponent<Box2DBodyComponent>().AddComponent<MoveableQuadComponent>().AddComponent<Invader>();
+static const Prefab c_bulletPrefab = Prefab().AddComponent<Box2DBodyComponent>().AddComponent<Bullet>().AddComponent<MoveableQuadComponent>();
+
 ICamera* ShouldBeDataDriven::CreateCamera(const GameContext& context)
 {
 	// Create the camera
 	Entity* testEntity = context.GetComponentManager().GetFreeEntity();
 	testEntity->SetName(c_cameraName);
+	testEntity->SetPersistent(true);
 	CameraComponent* camera = context.GetComponentManager().AddComponent<CameraComponent>(testEntity);
 	const RunInformation::ScreenDims& screenDims = RunInformation::GetScreenDimensions();
 	float height = 600;
@@ -332,26 +349,33 @@ void ShouldBeDataDriven::CreateInvaderWave(
 	iwc.m_maxFireRate = 3.f;
 	mgr->SetConfig(iwc);
 
+	// Spawn all the invaders in one batch (looking up each type's texture just the once).
+	const ITexture2D* textures[c_invaderTypeCount];
+	for (int i = 0; i < c_invaderTypeCount; ++i)
+	{
+		textures[i] = context.GetTextureManager().GetTexture(c_invaderTextureNames[i]);
+	}
+	std::vector<Entity*> invaders;
+	size_t spawned = componentManager.SpawnBatch(c_invaderPrefab, def->m_invaders.size(), [&](Entity* invader, size_t i)
+	{
+		const InvaderDefinition& invDef = def->m_invaders[i];
+		SetupInvader(context, invader, bodyComponent, textures[invDef.m_invaderType], invDef);
+	}, &invaders);
+
+	// The batch is all or nothing, and the connections need every invader.
+	BOOST_ASSERT(spawned == def->m_invaders.size());
+	if (spawned != def->m_invaders.size())
+	{
+		return;
+	}
+
 	// Create a map for the purposes of building up connections.
 	std::map<int, Entity*> invaderMap;
 
-	for (size_t i = 0; i < def->m_invaders.size(); ++i)
+	for (size_t i = 0; i < invaders.size(); ++i)
 	{
-		Entity* out = nullptr;
-		switch (def->m_invaders[i].m_invaderType)
-		{
-		case 0:
-			out = CreateInvader0(context, bodyComponent, def->m_invaders[i]);
-			break;
-		case 1:
-			out = CreateInvader1(context, bodyComponent, def->m_invaders[i]);
-			break;
-		case 2:
-			out = CreateInvader2(context, bodyComponent, def->m_invaders[i]);
-			break;
-		}
-		invaderMap[def->m_invaders[i].m_id] = out;
-		mgr->AddInvader(out);
+		invaderMap[def->m_invaders[i].m_id] = invaders[i];
+		mgr->AddInvader(invaders[i]);
 	}
 
 	b2RopeJointDef jointDef;
@@ -395,47 +419,9 @@ void ShouldBeDataDriven::CreateInvaderWave(
 	}
 }
 
-ComponentModel::Entity* ShouldBeDataDriven::CreateInvader0(const GameContext& context, Box2DBodyComponent* invaderWave, const InvaderDefinition& def)
-{
-	// Create the invader now we have the texture.
-	Entity* invader = CreateInvader(context, invaderWave, context.GetTextureManager().GetTexture("invader0"), def);
-
-	// Add an actual invader.
-	Invader* invComp = context.GetComponentManager().AddComponent<Invader>(invader);
-	invComp->SetupInvader(Invader::InvaderConfig(30, 10, 1, 0));
-	
-	// Return the invader's body
-	return invader;
-}
-
-ComponentModel::Entity* ShouldBeDataDriven::CreateInvader1(const GameContext& context, Box2DBodyComponent* invaderWave, const InvaderDefinition& def)
-{
-	// Create the invader now we have the texture.
-	Entity* invader = CreateInvader(context, invaderWave, context.GetTextureManager().GetTexture("invader1"), def);
-	
-	// Add an actual invader.
-	Invader* invComp = context.GetComponentManager().AddComponent<Invader>(invader);
-	invComp->SetupInvader(Invader::InvaderConfig(20, 20, 1, 0));
-
-	// Return the invader's body
-	return invader;
-}
-
-ComponentModel::Entity* ShouldBeDataDriven::CreateInvader2(const GameContext& context, Box2DBodyComponent* invaderWave, const InvaderDefinition& def)
-{
-	// Create the invader now we have the texture.
-	Entity* invader = CreateInvader(context, invaderWave, context.GetTextureManager().GetTexture("invader2"), def);
-	
-	// Add an actual invader.
-	Invader* invComp = context.GetComponentManager().AddComponent<Invader>(invader);
-	invComp->SetupInvader(Invader::InvaderConfig(10, 30, 1, 0));
-
-	// Return the invader's body
-	return invader;
-}
-
-Entity* ShouldBeDataDriven::CreateInvader(const GameContext& context, Box2DBodyComponent* invaderWave, const ITexture2D* texture, const InvaderDefinition& def)
+void ShouldBeDataDriven::SetupInvader(const GameContext& context, Entity* invader, Box2DBodyComponent* invaderWave, const ITexture2D* texture, const InvaderDefinition& def)
 {
+	BOOST_ASSERT(def.m_invaderType >= 0 && def.m_invaderType < c_invaderTypeCount);
 	int invaderSize = 20;
 
 	// Create a new quad for the purposes of this.
@@ -461,15 +447,12 @@ Entity* ShouldBeDataDriven::CreateInvader(const GameContext& context, Box2DBodyC
 	b2Body* testBody = context.GetBox2DWorld().CreateBody(&bodyDef);
 	testBody->CreateFixture(&fixDef);
 
-	// Aaaand connect it to some components to make it work.
-	Entity* testPhysicsEntity = context.GetComponentManager().GetFreeEntity();
-	Box2DBodyComponent* bodyComponent = context.GetComponentManager().AddComponent<Box2DBodyComponent>(testPhysicsEntity);
-	bodyComponent->SetBody(testBody);
-	MoveableQuadComponent* quadComponent = context.GetComponentManager().AddComponent<MoveableQuadComponent>(testPhysicsEntity);
+	// The prefab has already attached the components, so just set them up.
+	invader->GetComponentByTypeFast<Box2DBodyComponent>()->SetBody(testBody);
+	MoveableQuadComponent* quadComponent = invader->GetComponentByTypeFast<MoveableQuadComponent>();
 	quadComponent->SetQuad(testQuad);
 	quadComponent->SetRenderer(&context.GetQuadRenderer());
-
-	return testPhysicsEntity;
+	invader->GetComponentByTypeFast<Invader>()->SetupInvader(c_invaderConfigs[def.m_invaderType]);
 }
 
 Entity* ShouldBeDataDriven::CreateBullet(b2Body* owner, const GameContext& context, bool isPlayer)
@@ -494,14 +477,13 @@ Entity* ShouldBeDataDriven::CreateBullet(b2Body* owner, const GameContext& conte
 	testBody->CreateFixture(&fixDef);
 
 	// Aaaand connect it to some components to make it work.
-	Entity* testPhysicsEntity = context.GetComponentManager().GetFreeEntity();
-	Box2DBodyComponent* bodyComponent = context.GetComponentManager().AddComponent<Box2DBodyComponent>(testPhysicsEntity);
-	bodyComponent->SetBody(testBody);
-	Bullet* bullet = context.GetComponentManager().AddComponent<Bullet>(testPhysicsEntity);
+	Entity* testPhysicsEntity = context.GetComponentManager().Spawn(c_bulletPrefab);
+	testPhysicsEntity->GetComponentByTypeFast<Box2DBodyComponent>()->SetBody(testBody);
+	Bullet* bullet = testPhysicsEntity->GetComponentByTypeFast<Bullet>();
 	bullet->SetSpeed(isPlayer ? 5.f : -5.f);
 	bullet->SetDamage(10);
 	bullet->SetOwnerType(isPlayer ? Bullet::BOT_PLAYER : Bullet::BOT_INVADER);
-	MoveableQuadComponent* quadComponent = context.GetComponentManager().AddComponent<MoveableQuadComponent>(testPhysicsEntity);
+	MoveableQuadComponent* quadComponent = testPhysicsEntity->GetComponentByTypeFast<MoveableQuadComponent>();
 	quadComponent->SetQuad(testQuad);
 	quadComponent->SetRenderer(&context.GetQuadRenderer());
 	testPhysicsEntity->SetPosition(Eigen::Vector3f(0, 0, 1));
@@ -49,10 +49,7 @@ namespace ShouldBeDataDriven
 	InvaderWaveDefinition* CreateDrapesInvaderWaveDef(float difficulty, bool hard = false);
 	InvaderWaveDefinition* CreateDiagonalInvaderWaveDef(float difficulty);;
 	void CreateInvaderWave(const GameContext& context, InvaderWaveDefinition* def);
-	ComponentModel::Entity* CreateInvader0(const GameContext& context, Box2DBodyComponent* invaderWave, const InvaderDefinition& def);
-	ComponentModel::Entity* CreateInvader1(const GameContext& context, Box2DBodyComponent* invaderWave, const InvaderDefinition& def);
-	ComponentModel::Entity* CreateInvader2(const GameContext& context, Box2DBodyComponent* invaderWave, const InvaderDefinition& def);
-	ComponentModel::Entity* CreateInvader(const GameContext& context, Box2DBodyComponent* invaderWave, const ITexture2D* texture, const InvaderDefinition& def);
+	void SetupInvader(const GameContext& context, ComponentModel::Entity* invader, Box2DBodyComponent* invaderWave, const ITexture2D* texture, const InvaderDefinition& def);
 	ComponentModel::Entity* CreateBullet(b2Body* owner, const GameContext& context, bool player);
 	void LevelUpInvader(ComponentModel::Entity* invaderEntity, Invader* invader, const GameContext& context);
 }
\ No newline at end of file
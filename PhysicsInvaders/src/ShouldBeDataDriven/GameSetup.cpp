@@ -27,6 +27,7 @@
 
 #include "Core/StateMachine/ThreadedStateMachine.h"
 #include "ComponentModel/EntityComponentManager.h"
+#include "ComponentModel/ComponentRegistry.h"
 #include "CoreComponents/CameraComponent.h"
 #include "CoreComponents/Box2DBodyComponent.h"
 #include "CoreComponents/MoveableQuadComponent.h"
@@ -53,20 +54,24 @@
 
 
 using namespace ComponentModel;
+
+// All required component types with counts/priorities/capacity policies.
+// Anything which scales with the wave size may grow, singletons should never need to.
+typedef ComponentRegistry< boost::mpl::vector<
+	ComponentRegistration<Box2DBodyComponent, 100, 0, PCP_GROW>,
+	ComponentRegistration<MoveableQuadComponent, 100, 1, PCP_GROW>,
+	ComponentRegistration<CameraComponent, 5, 10, PCP_FAIL_FAST>,
+	ComponentRegistration<TurretPointerMovementComponent, 1, -10, PCP_FAIL_FAST>,
+	ComponentRegistration<TurretYokeComponent, 1, -5, PCP_FAIL_FAST>,
+	ComponentRegistration<TurretController, 1, -5, PCP_FAIL_FAST>,
+	ComponentRegistration<InvaderWaveMover, 1, -5, PCP_FAIL_FAST>,
+	ComponentRegistration<InvaderWaveManager, 1, 0, PCP_FAIL_FAST>,
+	ComponentRegistration<Invader, 50, -4, PCP_GROW>,
+	ComponentRegistration<Bullet, 70, -3, PCP_GROW> > > GameComponentTypes;
+
 void ShouldBeDataDriven::SetupEntityManager(ComponentModel::EntityComponentManager* entityManager)
 {
-	// Add all required component types with counts/priorities
-	entityManager->AddComponentType<Box2DBodyComponent>(100, 0);
-	entityManager->AddComponentType<MoveableQuadComponent>(100, 1);
-	entityManager->AddComponentType<CameraComponent>(5, 10);
-	entityManager->AddComponentType<TurretPointerMovementComponent>(1, -10);
-	entityManager->AddComponentType<TurretYokeComponent>(1, -5);
-	entityManager->AddComponentType<TurretController>(1, -5);
-	entityManager->AddComponentType<InvaderWaveMover>(1, -5);
-	entityManager->AddComponentType<InvaderWaveManager>(1, 0);
-	entityManager->AddComponentType<Invader>(50, -4);
-	entityManager->AddComponentType<Bullet>(70, -3);
-	entityManager->RefreshUpdateLists();
+	GameComponentTypes::Register(*entityManager);
 }
 
 void ShouldBeDataDriven::LoadGameTextures(TextureManager* textureManager, const RendererD3D& renderer)
@@ -119,9 +124,8 @@ void ShouldBeDataDriven::SetupStateMachine(ThreadedStateMachine<const GameStateC
 
 void ShouldBeDataDriven::SetupGame(const GameContext& context, const StateOfTheGame& state)
 {
-	std::set<std::string> namesToIgnore;
-	namesToIgnore.insert(c_cameraName);
-	context.GetComponentManager().ClearAll(&namesToIgnore);
+	// Everything but the (persistent) camera goes.
+	context.GetComponentManager().ResetWorld();
 
 	// Create the turret.
 	CreateTurret(context, state);
@@ -24,6 +24,10 @@
 
 #pragma once
 
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
 namespace Helpers
 {
 	template<typename T>
@@ -56,6 +60,18 @@ namespace Helpers
 		return t * (end - start) + start;
 	}
 
+	/// Index of the lowest set bit of a (non zero) value.
+	inline unsigned int CountTrailingZeros(unsigned int value)
+	{
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward(&index, value);
+		return static_cast<unsigned int>(index);
+#else
+		return static_cast<unsigned int>(__builtin_ctz(value));
+#endif
+	}
+
 	// Following code borrowed directly from cplusplus.com, but it's a nice one!
 	template <typename T, size_t N>
 	inline
@@ -39,7 +39,8 @@ namespace Log
 
 		const char* ChannelStrings[] =
 		{
-			"NONE"
+			"NONE",
+			"COMPONENTMODEL"
 		};
 	};
 };
\ No newline at end of file
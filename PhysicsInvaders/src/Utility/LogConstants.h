@@ -57,6 +57,7 @@ namespace Log
 		enum Channel
 		{
 			CHANNEL_NONE,
+			CHANNEL_COMPONENT_MODEL,
 			CHANNEL_COUNT
 		};
 